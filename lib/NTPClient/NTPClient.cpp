@@ -21,6 +21,27 @@
 
 #include "NTPClient.h"
 
+// Reads the 64 bit NTP timestamp at ntpTimestamp as ms since Jan. 1, 1970
+static unsigned long long ntpToUnixMillis(const byte * ntpTimestamp) {
+  unsigned long secsSince1900 = (unsigned long)word(ntpTimestamp[0], ntpTimestamp[1]) << 16
+                              | word(ntpTimestamp[2], ntpTimestamp[3]);
+  // the fraction of that second, in units of 2^-32 s
+  unsigned long fraction = (unsigned long)word(ntpTimestamp[4], ntpTimestamp[5]) << 16
+                         | word(ntpTimestamp[6], ntpTimestamp[7]);
+  unsigned long secsSince1970 = secsSince1900 - SEVENZYYEARS;
+  return (unsigned long long)secsSince1970 * 1000 + (((unsigned long long)fraction * 1000) >> 32);
+}
+
+// Writes unixMillis (ms since Jan. 1, 1970) to ntpTimestamp as a 64 bit NTP timestamp
+static void unixMillisToNtp(unsigned long long unixMillis, byte * ntpTimestamp) {
+  unsigned long secsSince1900 = (unsigned long)(unixMillis / 1000) + SEVENZYYEARS;
+  unsigned long fraction = (((unsigned long long)(unixMillis % 1000)) << 32) / 1000;
+  for (int i = 0; i < 4; i++) {
+    ntpTimestamp[i]     = secsSince1900 >> (24 - 8 * i);
+    ntpTimestamp[4 + i] = fraction >> (24 - 8 * i);
+  }
+}
+
 NTPClient::NTPClient(UDP& udp) {
   this->_udp            = &udp;
 }
@@ -89,52 +110,393 @@ bool NTPClient::forceUpdate() {
     Serial.println("Update from NTP Server");
   #endif
 
-  this->sendNTPPacket();
+  // Wait for the first server lookup if the resolver doesn't block
+  while (!this->startRequest()) {
+    delay ( 1 );
+  }
 
   // Wait till data is there or timeout...
-  byte timeout = 0;
-  int cb = 0;
-  do {
-    delay ( 10 );
-    cb = this->_udp->parsePacket();
-    
-    if(cb > 0)
-    {
-      this->_udp->read(this->_packetBuffer, NTP_PACKET_SIZE);
-      if(!this->isValid(this->_packetBuffer))
-        cb = 0;
+  while (this->poll() == NTP_REQUEST_PENDING) {
+    delay ( 1 );
+  }
+
+  return this->_requestState == NTP_REQUEST_SUCCESS;
+}
+
+bool NTPClient::startRequest() {
+  if (!this->_udpSetup) this->begin();                           // setup the UDP client if needed
+  if (this->_sourceCount == 0) this->addServer(this->_poolServerName);
+
+  // Drop anything left over from an earlier request, so a late reply can't be taken for this one
+  while (this->_udp->parsePacket() > 0) {}
+
+  // At boot this resolves the first server, the others follow on the next calls to update()
+  this->resolveNext();
+  // A request now would go nowhere, update() starts it once the resolver has an answer
+  if (this->_lookupPending && !this->hasAddress()) return false;
+
+  this->_replyReceived  = false;
+  this->_sampleAdded    = false;
+  this->_burstRemaining = this->_burstSize;
+  this->_requestState   = NTP_REQUEST_PENDING;
+  this->startRound();
+  return true;
+}
+
+void NTPClient::startRound() {
+  this->_burstRemaining--;
+  this->_requestSentAt = millis();
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    this->_sources[i].reach <<= 1;
+    this->sendNTPPacket(this->_sources[i]);
+  }
+}
+
+NTPRequestState NTPClient::poll() {
+  if (this->_requestState != NTP_REQUEST_PENDING) return this->_requestState;
+
+  int cb;
+  while ((cb = this->_udp->parsePacket()) > 0) {
+    unsigned long receivedAt = millis();                          // T4
+    if (cb < NTP_PACKET_SIZE) continue;                          // too short to be a reply, skip it
+    this->_udp->read(this->_packetBuffer, NTP_PACKET_SIZE);
+    if (!this->isValid(this->_packetBuffer)) continue;
+    // a server echoes our transmit timestamp as its origin timestamp, which tells us which request it answers
+    for (uint8_t i = 0; i < this->_sourceCount; i++) {
+      NTPSource &source = this->_sources[i];
+      if (!source.pending || memcmp(this->_packetBuffer + 24, source.origin, 8) != 0) continue;
+      source.pending  = false;
+      source.failures = 0;
+      source.reach |= 1;
+      this->_replyReceived = true;
+      if (!this->processReply(source, receivedAt)) break;
+      this->_sampleAdded = true;
+      if (this->_hedging && this->_lastUpdate == 0) {
+        // Nothing to show yet, so use this reply now instead of waiting for the rest
+        this->applyOffset(source.samples[(source.sampleHead + NTP_SOURCE_SAMPLES - 1) % NTP_SOURCE_SAMPLES].offset, receivedAt);
+        this->_hedgedSync = true;
+        if (this->_resultCallback) this->_resultCallback(true);
+      }
+      break;
     }
-    
-    if (timeout > 100) return false; // timeout after 1000 ms
-    timeout++;
-  } while (cb == 0);
+  }
+
+  bool waiting = false;
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    if (this->_sources[i].pending) waiting = true;
+  }
+  if (waiting && millis() - this->_requestSentAt < this->_requestTimeout) return NTP_REQUEST_PENDING;
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    NTPSource &source = this->_sources[i];
+    if (!source.pending) continue;
+    source.pending = false;
+    if (source.failures < 0xFF) source.failures++;
+  }
+  if (this->_burstRemaining > 0) {
+    this->startRound();
+    return NTP_REQUEST_PENDING;
+  }
 
-  this->_lastUpdate = millis() - (10 * (timeout + 1)); // Account for delay in reading the time
+  if (!this->_replyReceived) return this->finishRequest(NTP_REQUEST_TIMEOUT);
+  unsigned long now = millis();
+  long offset;
+  unsigned long roundTrip;
+  if (!this->_sampleAdded || !this->selectOffset(now, offset, roundTrip)) return this->finishRequest(NTP_REQUEST_REJECTED);
 
-  unsigned long highWord = word(this->_packetBuffer[40], this->_packetBuffer[41]);
-  unsigned long lowWord = word(this->_packetBuffer[42], this->_packetBuffer[43]);
-  // combine the four bytes (two words) into a long integer
-  // this is NTP time (seconds since Jan 1 1900):
-  unsigned long secsSince1900 = highWord << 16 | lowWord;
+  this->_lastDelay = roundTrip;
+  this->applyOffset(offset, now);
+  return this->finishRequest(NTP_REQUEST_SUCCESS);
+}
 
-  this->_currentEpoc = secsSince1900 - SEVENZYYEARS;
+void NTPClient::applyOffset(long offset, unsigned long at) {
+  unsigned long long timeAtReceive = this->referenceMillisAt(at) + offset;
+  if (this->_hedgedSync) {
+    // The time so far came from a single reply, step straight to the selected one instead of slewing from it
+    this->_lastUpdate = 0;
+    this->_hedgedSync = false;
+  }
+  this->disciplineClock(timeAtReceive, at);
+  // the clock now includes the correction, so the samples we hold have to be measured against the new clock
+  this->shiftSamples(offset);
+}
 
+bool NTPClient::processReply(NTPSource &source, unsigned long receivedAt) {
+  // T1 and T4 are read from millis(), T2 and T3 are the server's receive and transmit timestamps
+  unsigned long long receiveTime  = ntpToUnixMillis(this->_packetBuffer + 32);  // T2
+  unsigned long long transmitTime = ntpToUnixMillis(this->_packetBuffer + 40);  // T3
+
+  // round-trip delay = (T4 - T1) - (T3 - T2), the time the request spent on the network
+  long serverTime = (long)(transmitTime - receiveTime);
+  long roundTrip  = (long)(receivedAt - source.sentAt) - serverTime;
+  if (roundTrip < 0) roundTrip = 0;  // a server can't answer before it was asked, blame the clock resolution
+  if ((unsigned long)roundTrip > this->_maxDelay) return false;
+
+  // the reply spent about half the round trip travelling back to us, so at T4 the time was T3 + delay / 2.
+  // this is the same as T4 + offset, with offset = ((T2 - T1) + (T3 - T4)) / 2
+  unsigned long long timeAtReceive = transmitTime + roundTrip / 2;
+
+  // until the first sync there is no clock to measure against, so borrow one from the first reply
+  if (this->_lastUpdate == 0 && this->_provisionalBase == 0) this->_provisionalBase = timeAtReceive - receivedAt;
+
+  // a server that is days off can't win the selection anyway, so keep its offset in range
+  long long offset = (long long)(timeAtReceive - this->referenceMillisAt(receivedAt));
+  NTPSample &sample = source.samples[source.sampleHead];
+  sample.offset     = (long)constrain(offset, -0x3FFFFFFFLL, 0x3FFFFFFFLL);
+  sample.delay      = roundTrip;
+  sample.receivedAt = receivedAt;
+  source.sampleHead = (source.sampleHead + 1) % NTP_SOURCE_SAMPLES;
+  if (source.sampleCount < NTP_SOURCE_SAMPLES) source.sampleCount++;
   return true;
 }
 
+bool NTPClient::filterSource(NTPSource &source, unsigned long now, NTPSample &best, unsigned long &distance, unsigned long &jitter) {
+  if (source.sampleCount == 0 || source.reach == 0) return false;
+
+  // The sample with the shortest round trip had the least room for asymmetric network delays, so trust it most.
+  // Older samples lose some of that trust as the local clock may have wandered since.
+  unsigned long bestDistance = 0xFFFFFFFFUL, bestAge = 0;  // In us and ms
+  for (uint8_t i = 0; i < source.sampleCount; i++) {
+    NTPSample &sample = source.samples[i];
+    unsigned long age = now - sample.receivedAt;
+    unsigned long sampleDistance = sample.delay * 500UL + age / 1000 * NTP_DISPERSION_PPM;
+    if (sampleDistance < bestDistance || (sampleDistance == bestDistance && age < bestAge)) {
+      bestDistance = sampleDistance;
+      bestAge      = age;
+      best         = sample;
+    }
+  }
+  distance = bestDistance / 1000;
+
+  // How far the other samples scatter around the best one
+  unsigned long scatter = 0;
+  for (uint8_t i = 0; i < source.sampleCount; i++) {
+    long difference = source.samples[i].offset - best.offset;
+    scatter += difference < 0 ? -difference : difference;
+  }
+  jitter = source.sampleCount > 1 ? scatter / (source.sampleCount - 1) : 0;
+  distance += jitter + 1;
+  return true;
+}
+
+bool NTPClient::selectOffset(unsigned long now, long &offset, unsigned long &roundTrip) {
+  // Each server says the true offset lies within its best sample's offset +- distance. Find the range most of
+  // them agree on (Marzullo's algorithm), so a single bad server is outvoted instead of setting the clock.
+  struct Edge { long value; int8_t step; };
+  Edge edges[NTP_MAX_SOURCES * 2];
+  NTPSample best[NTP_MAX_SOURCES];
+  unsigned long distance[NTP_MAX_SOURCES];
+  bool candidate[NTP_MAX_SOURCES];
+  uint8_t candidates = 0, edgeCount = 0;
+
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    unsigned long jitter;
+    this->_sources[i].truechimer = false;
+    candidate[i] = this->filterSource(this->_sources[i], now, best[i], distance[i], jitter);
+    if (!candidate[i]) continue;
+    candidates++;
+    edges[edgeCount++] = { best[i].offset - (long)distance[i], 1 };
+    edges[edgeCount++] = { best[i].offset + (long)distance[i], -1 };
+  }
+  this->_truechimers = 0;
+  if (candidates == 0) return false;
+
+  // Sort the interval edges, starts before ends where they touch
+  for (uint8_t i = 1; i < edgeCount; i++) {
+    Edge edge = edges[i];
+    uint8_t j = i;
+    for (; j > 0 && (edges[j - 1].value > edge.value
+                     || (edges[j - 1].value == edge.value && edges[j - 1].step < edge.step)); j--) {
+      edges[j] = edges[j - 1];
+    }
+    edges[j] = edge;
+  }
+
+  int8_t overlap = 0, mostOverlap = 0;
+  long low = 0, high = 0;
+  for (uint8_t i = 0; i < edgeCount; i++) {
+    overlap += edges[i].step;
+    if (overlap > mostOverlap) {
+      mostOverlap = overlap;
+      low  = edges[i].value;
+      high = edges[i + 1].value;  // the edge after a start always exists, at least that interval's end
+    }
+  }
+  if (mostOverlap * 2 <= candidates) return false;  // no majority, better keep the time we have
+
+  // Of the servers that agree, the one with the smallest error bound sets the time
+  int8_t selected = -1;
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    if (!candidate[i]) continue;
+    if (best[i].offset + (long)distance[i] < low || best[i].offset - (long)distance[i] > high) continue;
+    this->_sources[i].truechimer = true;
+    this->_truechimers++;
+    if (selected < 0 || distance[i] < distance[selected]) selected = i;
+  }
+  offset    = best[selected].offset;
+  roundTrip = best[selected].delay;
+  return true;
+}
+
+void NTPClient::shiftSamples(long correction) {
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    for (uint8_t j = 0; j < this->_sources[i].sampleCount; j++) {
+      this->_sources[i].samples[j].offset -= correction;
+    }
+  }
+}
+
+void NTPClient::disciplineClock(unsigned long long timeAtReceive, unsigned long receivedAt) {
+  if (this->_lastUpdate == 0) {
+    // First sync, there is nothing to compare against yet
+    this->_lastUpdate        = receivedAt;
+    this->_currentEpoc       = timeAtReceive / 1000;
+    this->_currentEpocMillis = timeAtReceive % 1000;
+    return;
+  }
+
+  unsigned long interval = receivedAt - this->_lastUpdate;
+  unsigned long long estimate = this->utcMillisAt(receivedAt);
+  long offset = (long)(timeAtReceive - estimate);
+  this->_lastOffset = offset;
+  this->adjustPollExponent(offset);
+
+  // Part of the offset is the previous slew that has not been applied yet. The rest built up because
+  // millis() runs at a different rate than we thought, so it measures the remaining frequency error.
+  if (interval >= NTP_MIN_DRIFT_INTERVAL) {
+    long pendingSlew = this->_slewRemaining - this->slewAt(interval);
+    long residualPpb = (long)((long long)(offset - pendingSlew) * 1000000000LL / (long long)interval);
+    // Take the first measurement as is, then average new ones in to smooth out network jitter
+    this->_driftPpb += this->_driftEstimated ? residualPpb / 4 : residualPpb;
+    this->_driftPpb = constrain(this->_driftPpb, -NTP_MAX_DRIFT_PPB, NTP_MAX_DRIFT_PPB);
+    this->_driftEstimated = true;
+  }
+
+  if (offset > NTP_STEP_THRESHOLD || offset < -NTP_STEP_THRESHOLD) {
+    // Too far off to slew in reasonable time, step straight to the server's time
+    estimate = timeAtReceive;
+    this->_slewRemaining = 0;
+  } else {
+    // Keep counting on from our own estimate, and slew the offset out gradually so the clock never jumps
+    this->_slewRemaining = offset;
+  }
+  this->_lastUpdate        = receivedAt;
+  this->_currentEpoc       = estimate / 1000;
+  this->_currentEpocMillis = estimate % 1000;
+}
+
+long NTPClient::slewAt(unsigned long elapsedMillis) {
+  long maxSlew = (long)((unsigned long long)elapsedMillis * NTP_MAX_SLEW_PPM / 1000000UL);
+  if (this->_slewRemaining > maxSlew) return maxSlew;
+  if (this->_slewRemaining < -maxSlew) return -maxSlew;
+  return this->_slewRemaining;
+}
+
+long NTPClient::correctionAt(unsigned long elapsedMillis) {
+  // ms to add to the local time elapsed since _lastUpdate for the drift of millis() and the slew in progress
+  long driftCorrection = (long)((long long)elapsedMillis * this->_driftPpb / 1000000000LL);
+  return driftCorrection + this->slewAt(elapsedMillis);
+}
+
+unsigned long long NTPClient::utcMillisAt(unsigned long localMillis) {
+  unsigned long elapsedMillis = localMillis - this->_lastUpdate;
+  return (unsigned long long)this->_currentEpoc * 1000 + this->_currentEpocMillis
+         + elapsedMillis + this->correctionAt(elapsedMillis);
+}
+
+unsigned long long NTPClient::referenceMillisAt(unsigned long localMillis) {
+  // the clock samples are measured against: the local clock as if the slew in progress had already finished,
+  // so samples taken before and after a sync can be compared
+  if (this->_lastUpdate == 0) return this->_provisionalBase + localMillis;
+  return this->utcMillisAt(localMillis) + this->_slewRemaining - this->slewAt(localMillis - this->_lastUpdate);
+}
+
+void NTPClient::adjustPollExponent(long offset) {
+  if (offset > NTP_POLL_JUMP_OFFSET || offset < -NTP_POLL_JUMP_OFFSET) {
+    // The clock wandered off, check on it more often
+    if (this->_pollExponent > 0) this->_pollExponent--;
+    this->_stableSyncs = 0;
+  } else if (offset <= NTP_POLL_STABLE_OFFSET && offset >= -NTP_POLL_STABLE_OFFSET) {
+    // Enough good syncs in a row, so the drift correction is holding and we can wait longer
+    if (++this->_stableSyncs >= NTP_POLL_STABLE_COUNT) {
+      if (this->_pollExponent < this->_maxPollExponent) this->_pollExponent++;
+      this->_stableSyncs = 0;
+    }
+  }
+}
+
+void NTPClient::scheduleNextPoll(bool success) {
+  unsigned long pollInterval = this->_updateInterval << this->_pollExponent;
+  if (success) {
+    this->_consecutiveFailures = 0;
+    this->_syncCount++;
+    this->_nextPollAt = millis() + pollInterval;
+    return;
+  }
+
+  // Back off exponentially, but never wait longer than a normal poll
+  this->_failureCount++;
+  if (this->_consecutiveFailures < 0xFFFF) this->_consecutiveFailures++;
+  unsigned long retryInterval = pollInterval;
+  if (this->_consecutiveFailures <= 16 && (NTP_RETRY_BASE_INTERVAL << (this->_consecutiveFailures - 1)) < pollInterval) {
+    retryInterval = NTP_RETRY_BASE_INTERVAL << (this->_consecutiveFailures - 1);
+  }
+  // Add up to +-25% jitter so a fleet of clocks that lost the network together doesn't retry in lockstep
+  long jitter = retryInterval / 4;
+  this->_nextPollAt = millis() + retryInterval + random(-jitter, jitter + 1);
+}
+
+NTPRequestState NTPClient::finishRequest(NTPRequestState state) {
+  this->_requestState = state;
+  this->scheduleNextPoll(state == NTP_REQUEST_SUCCESS);
+  if (this->_resultCallback) this->_resultCallback(state == NTP_REQUEST_SUCCESS);
+  return state;
+}
+
+NTPRequestState NTPClient::getRequestState() {
+  return this->_requestState;
+}
+
+void NTPClient::setRequestTimeout(unsigned long requestTimeout) {
+  this->_requestTimeout = requestTimeout;
+}
+
+void NTPClient::onResult(NTPResultCallback resultCallback) {
+  this->_resultCallback = resultCallback;
+}
+
 bool NTPClient::update() {
-  if ((millis() - this->_lastUpdate >= this->_updateInterval)     // Update after _updateInterval
-    || this->_lastUpdate == 0) {                                // Update if there was no update yet.
-    if (!this->_udpSetup) this->begin();                         // setup the UDP client if needed
-    return this->forceUpdate();
+  if (this->_requestState == NTP_REQUEST_PENDING) {
+    NTPRequestState state = this->poll();
+    return state == NTP_REQUEST_PENDING || state == NTP_REQUEST_SUCCESS;
+  }
+  if (this->_requestState == NTP_REQUEST_IDLE                      // Update if there was no request yet.
+    || (long)(millis() - this->_nextPollAt) >= 0) {               // Update once the poll or retry interval is up
+    this->startRequest();
+  } else {
+    this->resolveNext();                                          // Refresh addresses between requests
   }
   return true;
 }
 
 unsigned long NTPClient::getEpochTime() {
+  uint16_t subSecondMillis;
+  return this->getEpochTime(subSecondMillis);
+}
+
+unsigned long NTPClient::getEpochTime(uint16_t &subSecondMillis) {
+  // ms since the start of the second returned by the NTP server, corrected for drift and slew
+  unsigned long localMillis = millis() - this->_lastUpdate;
+  unsigned long elapsedMillis = this->_currentEpocMillis + localMillis + this->correctionAt(localMillis);
+  subSecondMillis = elapsedMillis % 1000;
   return this->_timeOffset + // User offset
          this->_currentEpoc + // Epoc returned by the NTP server
-         ((millis() - this->_lastUpdate) / 1000); // Time since last update
+         (elapsedMillis / 1000); // Time since last update
+}
+
+unsigned long long NTPClient::getEpochMillis() {
+  uint16_t subSecondMillis;
+  unsigned long epoch = this->getEpochTime(subSecondMillis);
+  return (unsigned long long)epoch * 1000 + subSecondMillis;
 }
 
 int NTPClient::getDay() {
@@ -151,44 +513,120 @@ int NTPClient::getSeconds() {
 }
 
 String NTPClient::getFormattedTime(unsigned long secs) {
-  unsigned long rawTime = secs ? secs : this->getEpochTime();
-  unsigned long hours = (rawTime % 86400L) / 3600;
-  String hoursStr = hours < 10 ? "0" + String(hours) : String(hours);
-
-  unsigned long minutes = (rawTime % 3600) / 60;
-  String minuteStr = minutes < 10 ? "0" + String(minutes) : String(minutes);
-
-  unsigned long seconds = rawTime % 60;
-  String secondStr = seconds < 10 ? "0" + String(seconds) : String(seconds);
+  char buffer[9];
+  this->formatTime(buffer, sizeof(buffer), secs);
+  return String(buffer);
+}
 
-  return hoursStr + ":" + minuteStr + ":" + secondStr;
+size_t NTPClient::formatTime(char* buffer, size_t size, unsigned long secs) {
+  DateTime dateTime;
+  toDateTime(secs ? secs : this->getEpochTime(), dateTime);
+  return formatDateTime(buffer, size, "%T", dateTime);
 }
 
-// Based on https://github.com/PaulStoffregen/Time/blob/master/Time.cpp
 // currently assumes UTC timezone, instead of using this->_timeOffset
 String NTPClient::getFormattedDate(unsigned long secs) {
-  unsigned long rawTime = (secs ? secs : this->getEpochTime()) / 86400L;  // in days
-  unsigned long days = 0, year = 1970;
-  uint8_t month;
-  static const uint8_t monthDays[]={31,28,31,30,31,30,31,31,30,31,30,31};
-
-  while((days += (LEAP_YEAR(year) ? 366 : 365)) <= rawTime)
-    year++;
-  rawTime -= days - (LEAP_YEAR(year) ? 366 : 365); // now it is days in this year, starting at 0
-  days=0;
-  for (month=0; month<12; month++) {
-    uint8_t monthLength;
-    if (month==1) { // february
-      monthLength = LEAP_YEAR(year) ? 29 : 28;
-    } else {
-      monthLength = monthDays[month];
+  char buffer[21];
+  this->formatDate(buffer, sizeof(buffer), secs);
+  return String(buffer);
+}
+
+size_t NTPClient::formatDate(char* buffer, size_t size, unsigned long secs) {
+  DateTime dateTime;
+  toDateTime(secs ? secs : this->getEpochTime(), dateTime);
+  return formatDateTime(buffer, size, "%FT%TZ", dateTime);
+}
+
+static const char weekdayNames[] PROGMEM = "SunMonTueWedThuFriSat";
+static const char monthNames[] PROGMEM   = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+// Appends c to buffer, as long as there is room left for the terminating null
+static void appendChar(char* buffer, size_t size, size_t &length, char c) {
+  if (length + 1 < size) buffer[length++] = c;
+}
+
+// Appends value with at least width digits, padded on the left with pad
+static void appendNumber(char* buffer, size_t size, size_t &length, unsigned long value, uint8_t width, char pad) {
+  char digits[10];
+  uint8_t count = 0;
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  while (count < width) digits[count++] = pad;
+  while (count) appendChar(buffer, size, length, digits[--count]);
+}
+
+// Appends the index'th three letter name from names
+static void appendName(char* buffer, size_t size, size_t &length, const char* names, uint8_t index) {
+  for (uint8_t i = 0; i < 3; i++) appendChar(buffer, size, length, pgm_read_byte(names + index * 3 + i));
+}
+
+static void appendDateTime(char* buffer, size_t size, size_t &length, const char* format, const DateTime &dateTime) {
+  for (; *format; format++) {
+    if (*format != '%' || !format[1]) {
+      appendChar(buffer, size, length, *format);
+      continue;
+    }
+    switch (*++format) {
+      case 'Y': appendNumber(buffer, size, length, dateTime.year, 4, '0'); break;
+      case 'y': appendNumber(buffer, size, length, dateTime.year % 100, 2, '0'); break;
+      case 'm': appendNumber(buffer, size, length, dateTime.month, 2, '0'); break;
+      case 'd': appendNumber(buffer, size, length, dateTime.day, 2, '0'); break;
+      case 'e': appendNumber(buffer, size, length, dateTime.day, 2, ' '); break;
+      case 'H': appendNumber(buffer, size, length, dateTime.hours, 2, '0'); break;
+      case 'I': appendNumber(buffer, size, length, (dateTime.hours + 11) % 12 + 1, 2, '0'); break;
+      case 'M': appendNumber(buffer, size, length, dateTime.minutes, 2, '0'); break;
+      case 'S': appendNumber(buffer, size, length, dateTime.seconds, 2, '0'); break;
+      case 'L': appendNumber(buffer, size, length, dateTime.milliseconds, 3, '0'); break;
+      case 'p': appendChar(buffer, size, length, dateTime.hours < 12 ? 'A' : 'P');
+                appendChar(buffer, size, length, 'M'); break;
+      case 'a': appendName(buffer, size, length, weekdayNames, dateTime.weekday % 7); break;
+      case 'b': appendName(buffer, size, length, monthNames, (dateTime.month + 11) % 12); break;
+      case 'F': appendDateTime(buffer, size, length, "%Y-%m-%d", dateTime); break;
+      case 'T': appendDateTime(buffer, size, length, "%H:%M:%S", dateTime); break;
+      case '%': appendChar(buffer, size, length, '%'); break;
+      default:  // not supported, copy it as is
+        appendChar(buffer, size, length, '%');
+        appendChar(buffer, size, length, *format);
     }
-    if (rawTime < monthLength) break;
-    rawTime -= monthLength;
   }
-  String monthStr = ++month < 10 ? "0" + String(month) : String(month); // jan is month 1  
-  String dayStr = ++rawTime < 10 ? "0" + String(rawTime) : String(rawTime); // day of month  
-  return String(year) + "-" + monthStr + "-" + dayStr + "T" + this->getFormattedTime(secs ? secs : 0) + "Z";
+}
+
+size_t NTPClient::formatDateTime(char* buffer, size_t size, const char* format, const DateTime &dateTime) {
+  if (size == 0) return 0;
+  size_t length = 0;
+  appendDateTime(buffer, size, length, format, dateTime);
+  buffer[length] = '\0';
+  return length;
+}
+
+void NTPClient::getDateTime(DateTime &dateTime) {
+  uint16_t subSecondMillis;
+  toDateTime(this->getEpochTime(subSecondMillis), dateTime);
+  dateTime.milliseconds = subSecondMillis;
+}
+
+void NTPClient::toDateTime(unsigned long secs, DateTime &dateTime) {
+  unsigned long days = secs / 86400L;
+  unsigned long secsOfDay = secs % 86400L;
+  dateTime.hours        = secsOfDay / 3600;
+  dateTime.minutes      = (secsOfDay % 3600) / 60;
+  dateTime.seconds      = secsOfDay % 60;
+  dateTime.milliseconds = 0;
+  dateTime.weekday      = (days + 4) % 7;  // Jan. 1, 1970 was a Thursday
+
+  // Days to civil date, from http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+  // Years are counted from March 1st here, which moves the leap day to the end of the year
+  unsigned long dayNumber  = days + 719468;                       // days since March 1st, 0000
+  unsigned long era        = dayNumber / 146097;                  // 400 year cycles
+  unsigned long dayOfEra   = dayNumber - era * 146097;            // [0, 146096]
+  unsigned long yearOfEra  = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;  // [0, 399]
+  unsigned long dayOfYear  = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);         // [0, 365]
+  unsigned long monthIndex = (5 * dayOfYear + 2) / 153;          // [0, 11], March is 0
+  dateTime.day   = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+  dateTime.month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+  dateTime.year  = era * 400 + yearOfEra + (dateTime.month <= 2);
 }
 
 void NTPClient::end() {
@@ -197,6 +635,22 @@ void NTPClient::end() {
   this->_udpSetup = false;
 }
 
+void NTPClient::setMaxDelay(unsigned long maxDelay) {
+  this->_maxDelay = maxDelay;
+}
+
+long NTPClient::getLastOffset() {
+  return this->_lastOffset;
+}
+
+unsigned long NTPClient::getLastDelay() {
+  return this->_lastDelay;
+}
+
+long NTPClient::getDriftPpb() {
+  return this->_driftPpb;
+}
+
 void NTPClient::setTimeOffset(int timeOffset) {
   this->_timeOffset     = timeOffset;
 }
@@ -205,7 +659,142 @@ void NTPClient::setUpdateInterval(unsigned long updateInterval) {
   this->_updateInterval = updateInterval;
 }
 
-void NTPClient::sendNTPPacket() {
+void NTPClient::setMaxPollExponent(uint8_t maxPollExponent) {
+  this->_maxPollExponent = maxPollExponent > NTP_POLL_EXPONENT_LIMIT ? NTP_POLL_EXPONENT_LIMIT : maxPollExponent;
+  if (this->_pollExponent > this->_maxPollExponent) this->_pollExponent = this->_maxPollExponent;
+}
+
+NTPClientStats NTPClient::getStats() {
+  NTPClientStats stats;
+  stats.synced              = this->_lastUpdate != 0;
+  stats.sourceCount         = this->_sourceCount;
+  stats.truechimers         = this->_truechimers;
+  stats.pollExponent        = this->_pollExponent;
+  stats.pollInterval        = this->_updateInterval << this->_pollExponent;
+  long nextPollIn           = (long)(this->_nextPollAt - millis());
+  stats.nextPollIn          = (this->_requestState == NTP_REQUEST_IDLE || nextPollIn < 0) ? 0 : nextPollIn;
+  stats.consecutiveFailures = this->_consecutiveFailures;
+  stats.syncCount           = this->_syncCount;
+  stats.failureCount        = this->_failureCount;
+  stats.lastOffset          = this->_lastOffset;
+  stats.lastDelay           = this->_lastDelay;
+  stats.driftPpb            = this->_driftPpb;
+  stats.dnsLookups          = this->_dnsLookups;
+  return stats;
+}
+
+static void clearSource(NTPSource &source) {
+  source.pending     = false;
+  source.failures    = 0;
+  source.reach       = 0;
+  source.truechimer  = false;
+  source.sampleHead  = 0;
+  source.sampleCount = 0;
+}
+
+bool NTPClient::addServer(const char* serverName) {
+  if (this->_sourceCount >= NTP_MAX_SOURCES) return false;
+  NTPSource &source = this->_sources[this->_sourceCount++];
+  source.name     = serverName;
+  source.address  = IPAddress();
+  source.resolved = false;
+  source.lookupFailed = false;
+  clearSource(source);
+  return true;
+}
+
+bool NTPClient::addServer(IPAddress serverAddress) {
+  if (this->_sourceCount >= NTP_MAX_SOURCES) return false;
+  NTPSource &source = this->_sources[this->_sourceCount++];
+  source.name     = nullptr;
+  source.address  = serverAddress;
+  source.resolved = false;
+  source.lookupFailed = false;
+  clearSource(source);
+  return true;
+}
+
+void NTPClient::setBurstSize(uint8_t burstSize) {
+  this->_burstSize = constrain(burstSize, 1, NTP_MAX_BURST);
+}
+
+void NTPClient::setHedging(bool hedging) {
+  this->_hedging = hedging;
+}
+
+void NTPClient::setResolver(NTPResolver resolver) {
+  this->_resolver = resolver;
+}
+
+void NTPClient::setDnsTtl(unsigned long dnsTtl) {
+  this->_dnsTtl = dnsTtl;
+}
+
+bool NTPClient::lookupDue(const NTPSource &source, unsigned long now) {
+  if (!source.name) return false;
+  // DNS failed recently, don't hold up the caller on it again yet
+  if (source.lookupFailed && now - source.lookupFailedAt < NTP_DNS_NEGATIVE_TTL) return false;
+  // Expired, or the server stopped answering. Pool names hand out a different server on each lookup,
+  // so looking up again also moves us off a dead pool member
+  return !source.resolved || now - source.resolvedAt >= this->_dnsTtl || source.failures >= NTP_DNS_MAX_FAILURES;
+}
+
+void NTPClient::resolveNext() {
+  if (!this->_resolver || this->_sourceCount == 0) return;
+  unsigned long now = millis();
+  for (uint8_t n = 0; n < this->_sourceCount; n++) {
+    uint8_t i = (this->_nextLookup + n) % this->_sourceCount;
+    if (!this->lookupDue(this->_sources[i], now)) continue;
+    // A lookup still in progress keeps its turn, so the resolver only has one name in flight
+    this->_lookupPending = this->resolveSource(this->_sources[i]) == NTP_RESOLVE_PENDING;
+    this->_nextLookup    = this->_lookupPending ? i : (i + 1) % this->_sourceCount;
+    return;
+  }
+}
+
+bool NTPClient::hasAddress() {
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    if (!this->_sources[i].name || this->_sources[i].resolved) return true;
+  }
+  return false;
+}
+
+NTPResolveResult NTPClient::resolveSource(NTPSource &source) {
+  IPAddress address;
+  NTPResolveResult result = this->_resolver(source.name, address);
+  if (result == NTP_RESOLVE_PENDING) return result;
+  this->_dnsLookups++;
+  if (result == NTP_RESOLVE_DONE) {
+    source.address      = address;
+    source.resolved     = true;
+    source.resolvedAt   = millis();
+    source.failures     = 0;
+    source.lookupFailed = false;
+    return result;
+  }
+  // DNS is down, so keep using the address we have until the name is due again
+  source.lookupFailed   = true;
+  source.lookupFailedAt = millis();
+  return result;
+}
+
+bool NTPClient::getSourceStats(uint8_t index, NTPSourceStats &stats) {
+  if (index >= this->_sourceCount) return false;
+  NTPSource &source = this->_sources[index];
+  NTPSample best = { 0, 0, 0 };
+  unsigned long distance, jitter = 0;
+  this->filterSource(source, millis(), best, distance, jitter);
+  stats.reach      = source.reach;
+  stats.samples    = source.sampleCount;
+  stats.truechimer = source.truechimer;
+  stats.offset     = best.offset;
+  stats.delay      = best.delay;
+  stats.jitter     = jitter;
+  stats.address    = source.address;
+  return true;
+}
+
+void NTPClient::sendNTPPacket(NTPSource &source) {
   // set all bytes in the buffer to 0
   memset(this->_packetBuffer, 0, NTP_PACKET_SIZE);
   // Initialize values needed to form NTP request
@@ -220,13 +809,38 @@ void NTPClient::sendNTPPacket() {
   this->_packetBuffer[14]  = 0x49;
   this->_packetBuffer[15]  = 0x52;
 
+  // with a resolver the address was looked up ahead of time, so a slow DNS lookup doesn't count toward the round trip
+  int resolved;
+  if (source.name && !this->_resolver) {
+    this->_dnsLookups++;
+    resolved = this->_udp->beginPacket(source.name, 123);  //NTP requests are to port 123
+  } else {
+    resolved = (!source.name || source.resolved) && this->_udp->beginPacket(source.address, 123);
+  }
+  if (!resolved) return;
+
+  // Transmit Timestamp: our own idea of the time at T1. The server sends it back as the Origin Timestamp,
+  // which ties the reply to this request. The bits below the millisecond get a random nonce, so requests sent
+  // to several servers within the same millisecond can still be told apart
+  source.sentAt = millis();                                                    // T1
+  unixMillisToNtp(this->utcMillisAt(source.sentAt), this->_packetBuffer + 40);
+  this->_packetBuffer[46] = random(256);
+  this->_packetBuffer[47] = random(256);
+  memcpy(source.origin, this->_packetBuffer + 40, 8);
+
   // all NTP fields have been given values, now
   // you can send a packet requesting a timestamp:
-  this->_udp->beginPacket(this->_poolServerName, 123); //NTP requests are to port 123
   this->_udp->write(this->_packetBuffer, NTP_PACKET_SIZE);
   this->_udp->endPacket();
+  source.pending = true;
 }
 
 void NTPClient::setEpochTime(unsigned long secs) {
   this->_currentEpoc = secs;
+  this->_currentEpocMillis = 0;
+  this->_slewRemaining = 0;
+  // samples measured against the old time are meaningless now
+  for (uint8_t i = 0; i < this->_sourceCount; i++) {
+    clearSource(this->_sources[i]);
+  }
 }
@@ -7,8 +7,111 @@
 #define SEVENZYYEARS 2208988800UL
 #define NTP_PACKET_SIZE 48
 #define NTP_DEFAULT_LOCAL_PORT 1337
+#define NTP_DEFAULT_REQUEST_TIMEOUT 1000 // In ms
+#define NTP_DEFAULT_MAX_DELAY 500        // In ms, replies with a longer round trip are rejected
+#define NTP_STEP_THRESHOLD 128           // In ms, larger offsets step the clock, smaller ones are slewed out
+#define NTP_MAX_SLEW_PPM 500             // Fastest rate a slew may speed up or slow down the clock
+#define NTP_MAX_DRIFT_PPB 500000L        // Largest crystal frequency error that will be corrected (500 ppm)
+#define NTP_MIN_DRIFT_INTERVAL 256000UL  // In ms, syncs closer together than this are too noisy to measure drift
+#define NTP_POLL_EXPONENT_LIMIT 10        // Upper limit for setMaxPollExponent()
+#define NTP_POLL_STABLE_OFFSET 16        // In ms, syncs with smaller offsets count toward a longer poll interval
+#define NTP_POLL_JUMP_OFFSET 64          // In ms, a sync with a larger offset halves the poll interval
+#define NTP_POLL_STABLE_COUNT 4          // Stable syncs in a row needed before the poll interval doubles
+#define NTP_RETRY_BASE_INTERVAL 2000UL   // In ms, wait after a failed request, doubled for each further failure
+#ifndef NTP_MAX_SOURCES
+#define NTP_MAX_SOURCES 4                // Servers that can be sampled together, see addServer()
+#endif
+#ifndef NTP_SOURCE_SAMPLES
+#define NTP_SOURCE_SAMPLES 8             // Recent samples kept per server for the minimum delay filter
+#endif
+#define NTP_DISPERSION_PPM 15            // Assumed error growth of a sample as it ages, in ppm
+#define NTP_MAX_BURST 8                  // Upper limit for setBurstSize()
+#define NTP_DEFAULT_DNS_TTL 3600000UL    // In ms, how long a resolved server address is reused
+#define NTP_DNS_MAX_FAILURES 2           // Unanswered requests in a row before a server name is resolved again
+#define NTP_DNS_NEGATIVE_TTL 30000UL     // In ms, how long a failed lookup is remembered before the name is tried again
 #define LEAP_YEAR(Y)     ( (Y>0) && !(Y%4) && ( (Y%100) || !(Y%400) ) )
 
+enum NTPRequestState {
+  NTP_REQUEST_IDLE,     // No request has been sent yet
+  NTP_REQUEST_PENDING,  // A request is in flight, keep calling poll()
+  NTP_REQUEST_SUCCESS,  // The last request updated the time
+  NTP_REQUEST_TIMEOUT,  // The last request got no valid reply before its deadline
+  NTP_REQUEST_REJECTED  // The replies were too slow to trust, or the servers did not agree on the time
+};
+
+typedef void (*NTPResultCallback)(bool success);
+
+enum NTPResolveResult {
+  NTP_RESOLVE_FAILED,   // The name can't be resolved right now
+  NTP_RESOLVE_DONE,     // address holds the server's address
+  NTP_RESOLVE_PENDING   // The lookup is still running, the resolver is asked for the same name again on the next call
+};
+
+// Looks up the address of hostName. A resolver that doesn't wait for the DNS server can return NTP_RESOLVE_PENDING
+// until its answer arrives
+typedef NTPResolveResult (*NTPResolver)(const char* hostName, IPAddress &address);
+
+struct NTPClientStats {
+  bool          synced;               // True once a request has set the time
+  uint8_t       sourceCount;          // Servers sampled by each request
+  uint8_t       truechimers;          // Servers that agreed with the majority at the last selection
+  uint8_t       pollExponent;         // The poll interval is the update interval << pollExponent
+  unsigned long pollInterval;         // In ms, time between syncs while requests succeed
+  unsigned long nextPollIn;           // In ms, time until update() sends the next request
+  uint16_t      consecutiveFailures;  // Failed requests since the last success
+  unsigned long syncCount;            // Successful requests since begin()
+  unsigned long failureCount;         // Timed out or rejected requests since begin()
+  long          lastOffset;           // In ms
+  unsigned long lastDelay;            // In ms
+  long          driftPpb;             // Estimated millis() frequency error, in parts per billion
+  unsigned long dnsLookups;           // Server names resolved since begin()
+};
+
+struct NTPSourceStats {
+  uint8_t       reach;                // One bit per request, most recent in bit 0, set when the server answered
+  uint8_t       samples;              // Samples held for the minimum delay filter
+  bool          truechimer;           // True if the server agreed with the majority at the last selection
+  long          offset;               // In ms, offset of the best sample to the local clock
+  unsigned long delay;                // In ms, round-trip delay of the best sample
+  unsigned long jitter;               // In ms, mean difference of the other samples to the best one
+  IPAddress     address;              // Address requests are sent to, unset until the name has been resolved
+};
+
+struct DateTime {
+  uint16_t      year;
+  uint8_t       month;                // 1 is January
+  uint8_t       day;                  // Day of the month, starting at 1
+  uint8_t       hours;
+  uint8_t       minutes;
+  uint8_t       seconds;
+  uint16_t      milliseconds;
+  uint8_t       weekday;              // 0 is Sunday
+};
+
+struct NTPSample {
+  long          offset;               // In ms, relative to the local clock
+  unsigned long delay;                // In ms
+  unsigned long receivedAt;           // In ms, millis() when the reply arrived
+};
+
+struct NTPSource {
+  const char*   name;                 // Host name, or nullptr to use address
+  IPAddress     address;
+  bool          resolved;             // True if address holds a lookup of name
+  unsigned long resolvedAt;           // In ms
+  bool          lookupFailed;         // True if the last lookup of name failed
+  unsigned long lookupFailedAt;       // In ms
+  uint8_t       failures;             // Unanswered requests in a row
+  bool          pending;              // A request to this server is in flight
+  unsigned long sentAt;               // In ms, T1 of the request in flight
+  byte          origin[8];            // Transmit timestamp of the request in flight, echoed back by the server
+  uint8_t       reach;
+  bool          truechimer;
+  NTPSample     samples[NTP_SOURCE_SAMPLES];
+  uint8_t       sampleHead;           // Index the next sample is written to
+  uint8_t       sampleCount;
+};
+
 
 class NTPClient {
   private:
@@ -19,15 +122,70 @@ class NTPClient {
     int           _port           = NTP_DEFAULT_LOCAL_PORT;
     int           _timeOffset     = 0;
 
-    unsigned long _updateInterval = 60000;  // In ms
+    unsigned long _updateInterval = 60000;  // In ms, the shortest poll interval
+
+    uint8_t       _pollExponent   = 0;      // The poll interval is _updateInterval << _pollExponent
+    uint8_t       _maxPollExponent = 0;
+    uint8_t       _stableSyncs    = 0;      // Syncs in a row with an offset below NTP_POLL_STABLE_OFFSET
+    uint16_t      _consecutiveFailures = 0;
+    unsigned long _syncCount      = 0;
+    unsigned long _failureCount   = 0;
+    unsigned long _nextPollAt     = 0;      // In ms
 
     unsigned long _currentEpoc    = 0;      // In s
+    unsigned long _currentEpocMillis = 0;   // In ms, the fraction of _currentEpoc's second
     unsigned long _lastUpdate     = 0;      // In ms
 
+    NTPRequestState   _requestState   = NTP_REQUEST_IDLE;
+    unsigned long     _requestSentAt  = 0;  // In ms
+    unsigned long     _requestTimeout = NTP_DEFAULT_REQUEST_TIMEOUT; // In ms
+    NTPResultCallback _resultCallback = nullptr;
+
+    NTPSource     _sources[NTP_MAX_SOURCES];
+    uint8_t       _sourceCount    = 0;
+    uint8_t       _burstSize      = 1;      // Rounds of requests to every server per update
+    uint8_t       _burstRemaining = 0;      // Rounds still to send for the request in progress
+    bool          _replyReceived  = false;  // True if any server answered the request in progress
+    bool          _sampleAdded    = false;  // True if the request in progress got a usable reply
+    bool          _hedging        = false;  // Set the time from the first reply until the clock has been synced
+    bool          _hedgedSync     = false;  // True while the time comes from a single unconfirmed reply
+    NTPResolver   _resolver       = nullptr;
+    unsigned long _dnsTtl         = NTP_DEFAULT_DNS_TTL; // In ms
+    unsigned long _dnsLookups     = 0;
+    uint8_t       _nextLookup     = 0;      // Source resolveNext() checks first, so every server gets its turn
+    bool          _lookupPending  = false;  // True while the resolver is still looking up the source at _nextLookup
+    unsigned long long _provisionalBase = 0; // In ms, UTC time at millis() == 0 according to the first reply, until synced
+    uint8_t       _truechimers    = 0;
+    unsigned long _maxDelay       = NTP_DEFAULT_MAX_DELAY; // In ms
+    long          _lastOffset     = 0;      // In ms
+    unsigned long _lastDelay      = 0;      // In ms
+
+    long          _driftPpb       = 0;      // Estimated millis() frequency error, in parts per billion
+    bool          _driftEstimated = false;  // True once _driftPpb holds a measurement
+    long          _slewRemaining  = 0;      // In ms, offset still being slewed out since _lastUpdate
+
     byte          _packetBuffer[NTP_PACKET_SIZE];
 
-    void          sendNTPPacket();
+    void          sendNTPPacket(NTPSource &source);
     bool          isValid(byte * ntpPacket);
+    bool          lookupDue(const NTPSource &source, unsigned long now);
+    void          resolveNext();
+    bool          hasAddress();
+    NTPResolveResult resolveSource(NTPSource &source);
+    void          startRound();
+    bool          processReply(NTPSource &source, unsigned long receivedAt);
+    bool          filterSource(NTPSource &source, unsigned long now, NTPSample &best, unsigned long &distance, unsigned long &jitter);
+    bool          selectOffset(unsigned long now, long &offset, unsigned long &roundTrip);
+    void          shiftSamples(long correction);
+    void          applyOffset(long offset, unsigned long at);
+    unsigned long long utcMillisAt(unsigned long localMillis);
+    unsigned long long referenceMillisAt(unsigned long localMillis);
+    long          slewAt(unsigned long elapsedMillis);
+    long          correctionAt(unsigned long elapsedMillis);
+    void          disciplineClock(unsigned long long timeAtReceive, unsigned long receivedAt);
+    void          adjustPollExponent(long offset);
+    void          scheduleNextPoll(bool success);
+    NTPRequestState finishRequest(NTPRequestState state);
 
   public:
     NTPClient(UDP& udp);
@@ -48,24 +206,114 @@ class NTPClient {
 
     /**
      * This should be called in the main loop of your application. By default an update from the NTP Server is only
-     * made every 60 seconds. This can be configured in the NTPClient constructor.
+     * made every 60 seconds. This can be configured in the NTPClient constructor, and setMaxPollExponent() lets the
+     * interval grow while the clock is stable. Failed requests are retried after an exponential backoff.
+     * It never blocks: a due update is started with startRequest() and then polled on each following call.
      *
-     * @return true on success, false on failure
+     * @return false if a request timed out or was rejected during this call, true otherwise
      */
     bool update();
 
     /**
-     * This will force the update from the NTP Server.
+     * This will force the update from the NTP Server, blocking until a reply arrives or the request times out.
      *
      * @return true on success, false on failure
      */
     bool forceUpdate();
 
+    /**
+     * Adds a server to sample on each update, up to NTP_MAX_SOURCES. With more than one server the time is only
+     * set from servers whose offsets agree with the majority, so one bad server can't pull the clock away.
+     * Call before the first request. When no server has been added, the one from the constructor is used.
+     *
+     * @return false if the list is full
+     */
+    bool addServer(const char* serverName);
+    bool addServer(IPAddress serverAddress);
+
+    /**
+     * Sets how many rounds of requests go to every server on each update, 1 by default. The extra samples
+     * give the minimum delay filter more to choose from, at the cost of more traffic.
+     */
+    void setBurstSize(uint8_t burstSize);
+
+    /**
+     * With hedging on, the first valid reply sets the time right away until the clock has been synced once,
+     * calling the result callback without waiting for the other servers. The time is refined as soon as the rest
+     * of the replies are in, which shortens the wait for a first time after boot. Off by default.
+     */
+    void setHedging(bool hedging);
+
+    /**
+     * Sets the function used to look up server names, e.g. a wrapper around dns_gethostbyname(). Resolved addresses
+     * are reused for the DNS TTL, and a server is looked up again early once it stops answering. If a lookup fails,
+     * the last address keeps being used and the name isn't tried again for NTP_DNS_NEGATIVE_TTL. Lookups are made
+     * by update() between requests and by startRequest(), one server at a time, so a slow resolver holds up a
+     * single call at most, and a resolver that returns NTP_RESOLVE_PENDING holds up none. Requests skip servers that
+     * have never been resolved.
+     * Without a resolver every request passes the name to the UDP client.
+     */
+    void setResolver(NTPResolver resolver);
+
+    /**
+     * Sets how long a resolved server address is reused before the name is looked up again, in ms
+     */
+    void setDnsTtl(unsigned long dnsTtl);
+
+    /**
+     * Sends a request to every NTP Server and returns immediately, abandoning any request still in flight.
+     * Call poll() (or update()) until the request is no longer pending. Returns false without sending anything while
+     * no server has an address yet and the resolver is still looking one up, so call it again later.
+     */
+    bool startRequest();
+
+    /**
+     * Checks for a reply to the request started by startRequest(), without waiting.
+     *
+     * @return NTP_REQUEST_PENDING until every server has replied or the request timeout passes
+     */
+    NTPRequestState poll();
+
+    /**
+     * @return the state of the last request
+     */
+    NTPRequestState getRequestState();
+
+    /**
+     * Sets how long a request waits for a valid reply before it times out, in ms
+     */
+    void setRequestTimeout(unsigned long requestTimeout);
+
+    /**
+     * Sets a function that is called with the result each time a request succeeds or times out
+     */
+    void onResult(NTPResultCallback resultCallback);
+
     int getDay();
     int getHours();
     int getMinutes();
     int getSeconds();
 
+    /**
+     * Sets the longest round-trip delay in ms a reply may have and still be used to set the time
+     */
+    void setMaxDelay(unsigned long maxDelay);
+
+    /**
+     * @return the clock offset measured by the last successful request in ms, ((T2 - T1) + (T3 - T4)) / 2
+     */
+    long getLastOffset();
+
+    /**
+     * @return the round-trip delay measured by the last successful request in ms, (T4 - T1) - (T3 - T2)
+     */
+    unsigned long getLastDelay();
+
+    /**
+     * @return the estimated frequency error of the local clock in parts per billion, positive when it runs slow
+     */
+    long getDriftPpb();
+
     /**
      * Changes the time offset. Useful for changing timezones dynamically
      */
@@ -77,15 +325,63 @@ class NTPClient {
      */
     void setUpdateInterval(unsigned long updateInterval);
 
+    /**
+     * Lets the poll interval double up to maxPollExponent times (update interval << maxPollExponent) while
+     * successive syncs find the clock stable. It halves again whenever a sync finds a large offset.
+     * 0, the default, keeps the update interval fixed.
+     */
+    void setMaxPollExponent(uint8_t maxPollExponent);
+
+    /**
+     * @return the state of the poll scheduler and the last measurement
+     */
+    NTPClientStats getStats();
+
+    /**
+     * Fills stats with the filter state of the server added at index
+     *
+     * @return false if there is no server at index
+     */
+    bool getSourceStats(uint8_t index, NTPSourceStats &stats);
+
     /**
     * @return secs argument (or 0 for current time) formatted like `hh:mm:ss`
     */
     String getFormattedTime(unsigned long secs = 0);
 
+    /**
+     * Writes secs (or 0 for current time) like `hh:mm:ss` into buffer, without using the heap.
+     * The result is always null terminated and cut short if buffer is too small, 9 bytes fit it all.
+     *
+     * @return the number of characters written, without the terminating null
+     */
+    size_t formatTime(char* buffer, size_t size, unsigned long secs = 0);
+
     /**
      * @return time in seconds since Jan. 1, 1970
      */
     unsigned long getEpochTime();
+
+    /**
+     * @return time in seconds since Jan. 1, 1970, with the milliseconds into the current second stored in subSecondMillis
+     */
+    unsigned long getEpochTime(uint16_t &subSecondMillis);
+
+    /**
+     * @return time in milliseconds since Jan. 1, 1970
+     */
+    unsigned long long getEpochMillis();
+
+    /**
+     * Fills dateTime with the current date and time, from a single reading of the clock so the fields can't
+     * disagree across a second boundary
+     */
+    void getDateTime(DateTime &dateTime);
+
+    /**
+     * Splits secs since Jan. 1, 1970 into a date and time, in constant time. The milliseconds are set to 0
+     */
+    static void toDateTime(unsigned long secs, DateTime &dateTime);
   
     /**
     * @return secs argument (or 0 for current date) formatted to ISO 8601
@@ -93,6 +389,23 @@ class NTPClient {
     */
     String getFormattedDate(unsigned long secs = 0);
 
+    /**
+     * Writes secs (or 0 for current date) like `2004-02-12T15:19:21Z` into buffer, without using the heap.
+     * The result is always null terminated and cut short if buffer is too small, 21 bytes fit it all.
+     *
+     * @return the number of characters written, without the terminating null
+     */
+    size_t formatDate(char* buffer, size_t size, unsigned long secs = 0);
+
+    /**
+     * Writes dateTime into buffer following format, without using the heap. Supports these strftime() fields:
+     * %Y %y %m %d %e %H %I %M %S %p %a %b %F %T and %%, plus %L for the milliseconds. Other characters are copied.
+     * The result is always null terminated and cut short if buffer is too small.
+     *
+     * @return the number of characters written, without the terminating null
+     */
+    static size_t formatDateTime(char* buffer, size_t size, const char* format, const DateTime &dateTime);
+
     /**
      * Stops the underlying UDP client
      */
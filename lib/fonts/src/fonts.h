@@ -1,12 +1,18 @@
 // MAX7219 functions by Pawel A. Hernik
 //mods by kiyoshigawa:
 
+#pragma once
+
+#include <array>
+#include <type_traits>
+
 /*
 the [0]th byte of these arrays tells you how many bytes per character.
-all bytes represent columns of binary on/off values from left to right for each character.
+all bytes represent columns of binary on/off values from left to right for each character, with the top row in bit 0.
+the tables are constexpr so packed copies can be built from them at compile time, see the end of this file.
 */
 
-const uint8_t dig3x8[] PROGMEM = { 4,
+constexpr uint8_t dig3x8[] PROGMEM = { 4,
 3, 0xFF, 0x81, 0xFF,
 2, 0x02, 0xFF, 0x00,
 3, 0xF9, 0x89, 0x8F,
@@ -19,7 +25,7 @@ const uint8_t dig3x8[] PROGMEM = { 4,
 3, 0x9F, 0x91, 0xFF,
 };
 
-const uint8_t dig6x8[] PROGMEM = { 7,
+constexpr uint8_t dig6x8[] PROGMEM = { 7,
 6, 0x7E, 0xFF, 0x81, 0x81, 0xFF, 0x7E,
 6, 0x00, 0x82, 0xFF, 0xFF, 0x80, 0x00,
 6, 0xC2, 0xE3, 0xB1, 0x99, 0x8F, 0x86,
@@ -32,7 +38,7 @@ const uint8_t dig6x8[] PROGMEM = { 7,
 6, 0x4E, 0xDF, 0x91, 0x91, 0xFF, 0x7E,
 };
 
-const uint8_t dig4x8[] PROGMEM = { 5,
+constexpr uint8_t dig4x8[] PROGMEM = { 5,
 4, 0xFF, 0x81, 0x81, 0xFF,
 4, 0x04, 0x02, 0xFF, 0x00,
 4, 0xF9, 0x89, 0x89, 0x8F,
@@ -45,7 +51,7 @@ const uint8_t dig4x8[] PROGMEM = { 5,
 4, 0x1F, 0x91, 0x91, 0xFF,
 };
 
-const uint8_t dig3x7[] PROGMEM = { 4,
+constexpr uint8_t dig3x7[] PROGMEM = { 4,
 3, 0xFE, 0x82, 0xFE, 
 3, 0x08, 0x04, 0xFE, 
 3, 0xF2, 0x92, 0x9E, 
@@ -58,7 +64,7 @@ const uint8_t dig3x7[] PROGMEM = { 4,
 3, 0x9E, 0x92, 0xFE, 
 };
                                   
-const uint8_t dig3x6[] PROGMEM = { 4,
+constexpr uint8_t dig3x6[] PROGMEM = { 4,
 3, 0xFC, 0x84, 0xFC, 
 3, 0x10, 0x08, 0xFC, 
 3, 0xF4, 0x94, 0x9C, 
@@ -71,7 +77,7 @@ const uint8_t dig3x6[] PROGMEM = { 4,
 3, 0xBC, 0xA4, 0xFC, 
 };
 
-const uint8_t dig3x5[] PROGMEM = { 4,
+constexpr uint8_t dig3x5[] PROGMEM = { 4,
 3, 0xF8, 0x88, 0xF8, 
 2, 0x10, 0xF8, 0x00, 
 3, 0xE8, 0xA8, 0xB8, 
@@ -84,7 +90,7 @@ const uint8_t dig3x5[] PROGMEM = { 4,
 3, 0xB8, 0xA8, 0xF8, 
 };
 
-const uint8_t dig5x8rn[] PROGMEM = { 6,
+constexpr uint8_t dig5x8rn[] PROGMEM = { 6,
 5, 0x7E, 0x81, 0x81, 0xFF, 0x7E, 
 5, 0x04, 0x02, 0xFF, 0xFF, 0x00, 
 5, 0xF1, 0x89, 0x89, 0x8F, 0x86, 
@@ -97,7 +103,7 @@ const uint8_t dig5x8rn[] PROGMEM = { 6,
 5, 0x0E, 0x91, 0x91, 0xFF, 0x7E, 
 };
 
-const uint8_t dig5x8sq[] PROGMEM = { 6,
+constexpr uint8_t dig5x8sq[] PROGMEM = { 6,
 5, 0xFF, 0x81, 0x81, 0xFF, 0xFF, 
 4, 0x04, 0x02, 0xFF, 0xFF, 0x00, 
 5, 0xF9, 0x89, 0x89, 0x8F, 0x8F, 
@@ -110,7 +116,7 @@ const uint8_t dig5x8sq[] PROGMEM = { 6,
 5, 0x9F, 0x91, 0x91, 0xFF, 0xFF, 
 };
 
-const uint8_t dweek_pl[] PROGMEM = { 11,
+constexpr uint8_t dweek_pl[] PROGMEM = { 11,
 10, 0xFC, 0x08, 0x10, 0xFC, 0x00, 0xFC, 0x00, 0xFC, 0x94, 0x84, 
 9,  0xFC, 0x24, 0x24, 0x3C, 0x00, 0xFC, 0x84, 0x84, 0xFC, 0x00,  
 9,  0xFC, 0x80, 0xF0, 0x80, 0xFC, 0x00, 0x04, 0xFC, 0x04, 0x00, 
@@ -121,7 +127,7 @@ const uint8_t dweek_pl[] PROGMEM = { 11,
 9,  0x07, 0x05, 0x07, 0x00, 0xFF, 0xFF, 0x81, 0x81, 0x81, 0x00,  
 };
 
-const uint8_t dweek_en[] PROGMEM = { 11,
+constexpr uint8_t dweek_en[] PROGMEM = { 11,
 9,  0x9C, 0x94, 0x94, 0xF4, 0x00, 0xFC, 0x80, 0x80, 0xFC, 0x00,
 10, 0xFC, 0x04, 0x3C, 0x04, 0xFC, 0x00, 0xFC, 0x84, 0x84, 0xFC,
 10, 0x04, 0x04, 0xFC, 0x04, 0x04, 0x00, 0xFC, 0x80, 0x80, 0xFC,
@@ -132,8 +138,8 @@ const uint8_t dweek_en[] PROGMEM = { 11,
 9,  0x07, 0x05, 0x07, 0x00, 0xFF, 0xFF, 0x81, 0x81, 0x81, 0x00,
 };
 
-//subtract 32 from ascii values to use the characters in this array.
-const uint8_t font[] PROGMEM = {6,
+//this array is indexed by ascii value, starting at (NULL). font_upright and font_flipped below start at the space.
+constexpr uint8_t font[] PROGMEM = {6,
 0, B00000000, B00000000, B00000000, B00000000, B00000000, // (NULL)
 0, B00000000, B00000000, B00000000, B00000000, B00000000, // (SOH)
 0, B00000000, B00000000, B00000000, B00000000, B00000000, // (STX)
@@ -272,3 +278,191 @@ const uint8_t font[] PROGMEM = {6,
 3, B00000010, B00000101, B00000010, B00000000, B00000000, // deg
 };
 
+//reverses the bit order of a font column, i.e. 0b11000001 --> 0b10000011
+constexpr uint8_t fontReverseBits(uint8_t column)
+{
+  column = (column & 0xF0) >> 4 | (column & 0x0F) << 4;
+  column = (column & 0xCC) >> 2 | (column & 0x33) << 2;
+  return (column & 0xAA) >> 1 | (column & 0x55) << 1;
+}
+
+//a font packed for rendering: the columns of glyphs first to last back to back, and an index of where each one starts.
+//glyph c is columns[offsets[c - first]] up to columns[offsets[c - first + 1]], so its width is the difference.
+//the offsets are bytes for fonts of up to 255 columns and 16-bit words for larger ones. all pointers are to PROGMEM.
+//tools/fontc.py can also run-length encode each glyph, then the offsets index the encoded bytes, see fontGlyphColumns().
+struct FontDescriptor {
+  const uint8_t *columns;
+  const void *offsets;
+  uint8_t first;
+  uint8_t last;
+  uint8_t height;
+  bool wide_offsets;
+  bool rle;
+};
+
+//the widest glyph fontGlyphColumns() unpacks, tools/fontc.py refuses wider ones.
+#define FONT_MAX_GLYPH_WIDTH 16
+
+//how many glyphs of a fixed-stride table there are from glyph number first on.
+template <size_t N>
+constexpr size_t fontGlyphCount(const uint8_t (&table)[N], uint8_t first)
+{
+  return (N - 1) / table[0] - first;
+}
+
+//how many column bytes the glyphs of a fixed-stride table from glyph number first on take up without padding.
+template <size_t N>
+constexpr size_t fontPackedSize(const uint8_t (&table)[N], uint8_t first)
+{
+  size_t size = 0;
+  for(size_t glyph = first; glyph < (N - 1) / table[0]; glyph++) {
+    size += table[1 + glyph * table[0]];
+  }
+  return size;
+}
+
+//the columns of a fixed-stride table from glyph number first on, without the padding. if flip is set the top row
+//moves from bit 0 to bit 7, for displays that show the fonts upside down.
+template <size_t Size, size_t N>
+constexpr std::array<uint8_t, Size> fontPackColumns(const uint8_t (&table)[N], uint8_t first, bool flip)
+{
+  std::array<uint8_t, Size> columns{};
+  size_t packed = 0;
+  for(size_t glyph = first; glyph < (N - 1) / table[0]; glyph++) {
+    const uint8_t *source = table + 1 + glyph * table[0];
+    for(uint8_t column = 0; column < source[0]; column++) {
+      columns[packed++] = flip ? fontReverseBits(source[1 + column]) : source[1 + column];
+    }
+  }
+  return columns;
+}
+
+//the start of each glyph in the packed columns, and the end of the last one.
+template <class Offset, size_t Size, size_t N>
+constexpr std::array<Offset, Size> fontPackOffsets(const uint8_t (&table)[N], uint8_t first)
+{
+  std::array<Offset, Size> offsets{};
+  for(size_t glyph = first; glyph < (N - 1) / table[0]; glyph++) {
+    offsets[glyph - first + 1] = offsets[glyph - first] + table[1 + glyph * table[0]];
+  }
+  return offsets;
+}
+
+//packs the fixed-stride table from glyph number first_glyph on into name_columns and name_offsets at compile time,
+//and describes them as name with the character first_char for that glyph.
+#define FONT_DESCRIPTOR(name, table, first_glyph, first_char, height, flip) \
+  const std::array<uint8_t, fontPackedSize(table, first_glyph)> name##_columns PROGMEM = \
+    fontPackColumns<fontPackedSize(table, first_glyph)>(table, first_glyph, flip); \
+  typedef std::conditional_t<(fontPackedSize(table, first_glyph) > 255), uint16_t, uint8_t> name##_offset_t; \
+  const std::array<name##_offset_t, fontGlyphCount(table, first_glyph) + 1> name##_offsets PROGMEM = \
+    fontPackOffsets<name##_offset_t, fontGlyphCount(table, first_glyph) + 1>(table, first_glyph); \
+  const FontDescriptor name = {name##_columns.data(), name##_offsets.data(), first_char, \
+                               first_char + fontGlyphCount(table, first_glyph) - 1, height, sizeof(name##_offset_t) == 2, false};
+
+//finds where the bytes of character c start and end in font.columns. returns false if font has no glyph for it.
+inline bool fontGlyphBytes(const FontDescriptor &font, char c, uint16_t &start, uint16_t &end)
+{
+  uint8_t code = c;
+  if(code < font.first || code > font.last) {
+    return false;
+  }
+  uint8_t index = code - font.first;
+  if(font.wide_offsets) {
+    start = pgm_read_word((const uint16_t *)font.offsets + index);
+    end = pgm_read_word((const uint16_t *)font.offsets + index + 1);
+  } else {
+    start = pgm_read_byte((const uint8_t *)font.offsets + index);
+    end = pgm_read_byte((const uint8_t *)font.offsets + index + 1);
+  }
+  return true;
+}
+
+//finds character c in font and points columns at it in flash. returns false if font has no glyph for it.
+//this is the fast path, run-length encoded fonts have no plain columns to point at and always return false.
+inline bool fontGlyph(const FontDescriptor &font, char c, const uint8_t *&columns, uint8_t &width)
+{
+  uint16_t start, end;
+  if(font.rle || !fontGlyphBytes(font, c, start, end)) {
+    return false;
+  }
+  columns = font.columns + start;
+  width = end - start;
+  return true;
+}
+
+//finds the width of character c in font, walking the runs of run-length encoded fonts. returns false if font has no
+//glyph for it.
+inline bool fontGlyphWidth(const FontDescriptor &font, char c, uint8_t &width)
+{
+  uint16_t start, end;
+  if(!fontGlyphBytes(font, c, start, end)) {
+    return false;
+  }
+  if(!font.rle) {
+    width = end - start;
+    return true;
+  }
+  width = 0;
+  while(start < end) {
+    uint8_t run = pgm_read_byte(font.columns + start);
+    width += run < 0x80 ? run + 1 : run - 0x80 + 2;
+    start += run < 0x80 ? run + 2 : 2;
+  }
+  return true;
+}
+
+//copies the columns of character c in font to columns, which must hold FONT_MAX_GLYPH_WIDTH bytes. works for every
+//font, unpacking run-length encoded ones. returns false if font has no glyph for it.
+//an encoded glyph is a list of runs: a byte n below 0x80 is followed by n + 1 columns, a byte n from 0x80 on by one
+//column that repeats n - 0x80 + 2 times.
+inline bool fontGlyphColumns(const FontDescriptor &font, char c, uint8_t *columns, uint8_t &width)
+{
+  uint16_t start, end;
+  if(!fontGlyphBytes(font, c, start, end)) {
+    return false;
+  }
+  if(!font.rle) {
+    width = end - start;
+    memcpy_P(columns, font.columns + start, width);
+    return true;
+  }
+  width = 0;
+  const uint8_t *encoded = font.columns + start;
+  while(encoded < font.columns + end) {
+    uint8_t run = pgm_read_byte(encoded++);
+    if(run < 0x80) {
+      for(uint8_t i = 0; i <= run && width < FONT_MAX_GLYPH_WIDTH; i++) {
+        columns[width++] = pgm_read_byte(encoded++);
+      }
+    } else {
+      uint8_t column = pgm_read_byte(encoded++);
+      for(uint8_t i = 0; i < run - 0x80 + 2 && width < FONT_MAX_GLYPH_WIDTH; i++) {
+        columns[width++] = column;
+      }
+    }
+  }
+  return true;
+}
+
+//these are the packed fonts, upright and upside down, built by the compiler. Only the ones a sketch uses end up in flash.
+//the text font is ascii from the space on, the digit fonts have the glyphs for '0' to '9'.
+FONT_DESCRIPTOR(font_upright, font, ' ', ' ', 7, false)
+FONT_DESCRIPTOR(font_flipped, font, ' ', ' ', 7, true)
+FONT_DESCRIPTOR(dig3x8_upright, dig3x8, 0, '0', 8, false)
+FONT_DESCRIPTOR(dig3x8_flipped, dig3x8, 0, '0', 8, true)
+FONT_DESCRIPTOR(dig6x8_upright, dig6x8, 0, '0', 8, false)
+FONT_DESCRIPTOR(dig6x8_flipped, dig6x8, 0, '0', 8, true)
+FONT_DESCRIPTOR(dig4x8_upright, dig4x8, 0, '0', 8, false)
+FONT_DESCRIPTOR(dig4x8_flipped, dig4x8, 0, '0', 8, true)
+FONT_DESCRIPTOR(dig3x7_upright, dig3x7, 0, '0', 7, false)
+FONT_DESCRIPTOR(dig3x7_flipped, dig3x7, 0, '0', 7, true)
+FONT_DESCRIPTOR(dig3x6_upright, dig3x6, 0, '0', 6, false)
+FONT_DESCRIPTOR(dig3x6_flipped, dig3x6, 0, '0', 6, true)
+FONT_DESCRIPTOR(dig3x5_upright, dig3x5, 0, '0', 5, false)
+FONT_DESCRIPTOR(dig3x5_flipped, dig3x5, 0, '0', 5, true)
+FONT_DESCRIPTOR(dig5x8rn_upright, dig5x8rn, 0, '0', 8, false)
+FONT_DESCRIPTOR(dig5x8rn_flipped, dig5x8rn, 0, '0', 8, true)
+FONT_DESCRIPTOR(dig5x8sq_upright, dig5x8sq, 0, '0', 8, false)
+FONT_DESCRIPTOR(dig5x8sq_flipped, dig5x8sq, 0, '0', 8, true)
+
+static_assert(fontReverseBits(0b11000001) == 0b10000011, "fontReverseBits is broken.");
@@ -0,0 +1,228 @@
+// text layout by kiyoshigawa
+//lays a string out in a font once, so it can be measured, aligned and drawn as often as needed without looking the
+//glyphs up again. drawing is clipped to a viewport: glyphs outside it are skipped without being read, and only the
+//columns inside it are written.
+
+#pragma once
+
+#include <fonts.h>
+
+//the most glyphs one layout holds, the rest of a longer string is left out.
+#ifndef TEXT_LAYOUT_MAX_GLYPHS
+#define TEXT_LAYOUT_MAX_GLYPHS 32
+#endif
+
+enum TextAlign : uint8_t {
+  TEXT_ALIGN_LEFT,
+  TEXT_ALIGN_CENTER,
+  TEXT_ALIGN_RIGHT,
+};
+
+//moves the glyph of right closer to the glyph of left before it (negative adjust) or further from it.
+//kerning tables are arrays of these in PROGMEM.
+struct FontKerning {
+  char left;
+  char right;
+  int8_t adjust;
+};
+
+class TextLayout {
+  public:
+    //lays string out in font, with spacing blank columns between glyphs and the pairs in kerning adjusted.
+    //characters the font has no glyph for are skipped.
+    void layout(const FontDescriptor &font, const char *string, uint8_t spacing = 1,
+                const FontKerning *kerning = nullptr, uint8_t num_kerning = 0)
+    {
+      _count = 0;
+      layoutFrom(font, string, 0, spacing, kerning, num_kerning);
+    }
+
+    //lays string out again when it only differs from the last string from character number changed on, keeping the
+    //glyphs before that. font, spacing and kerning must be the ones the layout was made with.
+    void relayout(const FontDescriptor &font, const char *string, uint8_t changed, uint8_t spacing = 1,
+                  const FontKerning *kerning = nullptr, uint8_t num_kerning = 0)
+    {
+      _count = firstGlyphFrom(changed);
+      layoutFrom(font, string, _count > 0 ? _glyphs[_count - 1].position + 1 : 0, spacing, kerning, num_kerning);
+    }
+
+    //the number of the first glyph drawn for character number position of the string or a later one, count() if none is.
+    uint8_t firstGlyphFrom(uint8_t position) const
+    {
+      uint8_t i = _count;
+      while(i > 0 && _glyphs[i - 1].position >= position) {
+        i--;
+      }
+      return i;
+    }
+
+    //the width of the laid out string in columns, from the first column of its first glyph to the last of its last.
+    int16_t width() const { return _width; }
+
+    uint8_t count() const { return _count; }
+
+    //the character, first column (relative to the layout's first column) and width of glyph i, for i below count().
+    char glyphCode(uint8_t i) const { return _glyphs[i].code; }
+    int16_t glyphX(uint8_t i) const { return _glyphs[i].x; }
+    uint8_t glyphWidth(uint8_t i) const { return _glyphs[i].width; }
+
+    //the x that places the layout at align in the viewport_width columns from viewport_x on.
+    int16_t alignedX(TextAlign align, int16_t viewport_x, int16_t viewport_width) const
+    {
+      if(align == TEXT_ALIGN_CENTER) {
+        return viewport_x + (viewport_width - _width) / 2;
+      }
+      if(align == TEXT_ALIGN_RIGHT) {
+        return viewport_x + viewport_width - _width;
+      }
+      return viewport_x;
+    }
+
+    //draws the layout with its first column at x, writing only the display columns from clip_left up to clip_right.
+    //the columns between glyphs are left alone. face must be packed like the font the layout was made in, as the
+    //upright and flipped versions of a font are, the glyphs are not looked up again. when reversed, column x counts
+    //from the last display column back, for displays that are read the other way round; face should then be the
+    //flipped version. x and the clip are in text columns either way.
+    template <class Display>
+    void render(const FontDescriptor &face, Display &target, int16_t x, bool reversed,
+                int16_t clip_left = 0, int16_t clip_right = Display::num_columns) const
+    {
+      if(clip_left < 0) {
+        clip_left = 0;
+      }
+      if(clip_right > Display::num_columns) {
+        clip_right = Display::num_columns;
+      }
+      //the glyphs are in order, so the first visible one is found by binary search and the loop stops at the clip. a
+      //layout that starts inside the clip starts with its first glyph
+      uint8_t low = 0;
+      uint8_t high = x >= clip_left ? 0 : _count;
+      while(low < high) {
+        uint8_t middle = (low + high) / 2;
+        if(x + _glyphs[middle].x + _glyphs[middle].width <= clip_left) {
+          low = middle + 1;
+        } else {
+          high = middle;
+        }
+      }
+      //the direction and the packing are settled once here, not for every glyph or column
+      if(reversed) {
+        if(face.rle) {
+          renderGlyphs<true, true>(face, target, x, low, clip_left, clip_right);
+        } else {
+          renderGlyphs<true, false>(face, target, x, low, clip_left, clip_right);
+        }
+      } else {
+        if(face.rle) {
+          renderGlyphs<false, true>(face, target, x, low, clip_left, clip_right);
+        } else {
+          renderGlyphs<false, false>(face, target, x, low, clip_left, clip_right);
+        }
+      }
+    }
+
+  private:
+    struct Glyph {
+      char code;
+      uint8_t width;
+      uint8_t position; //the character's place in the string
+      int16_t x;        //the first column, relative to the first column of the layout
+      uint16_t start;   //where the glyph's bytes start in the font
+    };
+
+    Glyph _glyphs[TEXT_LAYOUT_MAX_GLYPHS];
+    uint8_t _count = 0;
+    int16_t _width = 0;
+
+    //lays out the characters of string from position on after the glyphs already in the layout.
+    void layoutFrom(const FontDescriptor &font, const char *string, uint8_t position, uint8_t spacing,
+                    const FontKerning *kerning, uint8_t num_kerning)
+    {
+      int16_t x = _count > 0 ? _glyphs[_count - 1].x + _glyphs[_count - 1].width : 0;
+      for(; string[position] != '\0' && _count < TEXT_LAYOUT_MAX_GLYPHS && position < 0xFF; position++) {
+        char c = string[position];
+        uint16_t start, end;
+        if(!fontGlyphBytes(font, c, start, end)) {
+          continue;
+        }
+        uint8_t width = end - start;
+        if(font.rle) {
+          fontGlyphWidth(font, c, width);
+        }
+        if(_count > 0) {
+          x += spacing + kerningFor(kerning, num_kerning, _glyphs[_count - 1].code, c);
+        }
+        _glyphs[_count++] = {c, width, position, x, start};
+        x += width;
+      }
+      _width = x;
+    }
+
+    //draws the glyphs from first_glyph on for render(). the display columns inside the clip are next to each other in
+    //the framebuffer unless the display's ring wraps around between them, so they are written through one pointer to
+    //the start of the clip, and only a wrapped framebuffer is written one column() at a time.
+    template <bool Reversed, bool Rle, class Display>
+    void renderGlyphs(const FontDescriptor &face, Display &target, int16_t x, uint8_t first_glyph, int16_t clip_left,
+                      int16_t clip_right) const
+    {
+      int run;
+      //reversed, the clip ends at the lowest display column
+      uint8_t *clip_start = target.columnRun(Reversed ? Display::num_columns - clip_right : clip_left, run);
+      bool contiguous = run >= clip_right - clip_left;
+      for(uint8_t i = first_glyph; i < _count; i++) {
+        int left = x + _glyphs[i].x;
+        if(left >= clip_right) {
+          break;
+        }
+        int from = 0;
+        int to = _glyphs[i].width;
+        //only the glyphs at the edges of the clip are cut
+        if(left < clip_left || left + to > clip_right) {
+          from = left < clip_left ? clip_left - left : 0;
+          to = left + to > clip_right ? clip_right - left : to;
+          if(from >= to) {
+            continue;
+          }
+        }
+        const uint8_t *columns = face.columns + _glyphs[i].start;
+        uint8_t unpacked[Rle ? FONT_MAX_GLYPH_WIDTH : 1];
+        if(Rle) {
+          uint8_t width;
+          if(!fontGlyphColumns(face, _glyphs[i].code, unpacked, width)) {
+            continue;
+          }
+          columns = unpacked;
+          if(to > width) {
+            to = width;
+          }
+          if(from >= to) {
+            continue;
+          }
+        }
+        if(contiguous) {
+          //reversed, the glyph's last column is the lowest display column it covers
+          uint8_t *destination = clip_start + (Reversed ? clip_right - (left + to) : left + from - clip_left);
+          const uint8_t *source = columns + (Reversed ? to : from);
+          const uint8_t *end = columns + (Reversed ? from : to);
+          while(source != end) {
+            *destination++ = Reversed ? pgm_read_byte(--source) : pgm_read_byte(source++);
+          }
+        } else {
+          for(int column = from; column < to; column++) {
+            target.column(Reversed ? Display::num_columns - 1 - (left + column) : left + column) =
+              pgm_read_byte(columns + column);
+          }
+        }
+      }
+    }
+
+    static int8_t kerningFor(const FontKerning *kerning, uint8_t num_kerning, char left, char right)
+    {
+      for(uint8_t i = 0; i < num_kerning; i++) {
+        if((char)pgm_read_byte(&kerning[i].left) == left && (char)pgm_read_byte(&kerning[i].right) == right) {
+          return (int8_t)pgm_read_byte(&kerning[i].adjust);
+        }
+      }
+      return 0;
+    }
+};
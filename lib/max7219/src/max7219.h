@@ -1,17 +1,21 @@
 // MAX7219 functions by Pawel A. Hernik
 // 2016.12.10 updated for rotated LED Martices, define ROTATE below (0,90 or 270)
 //mods by kiyoshigawa:
+//the chain size, rotation and bus transport are now template parameters of Max7219Display, so each
+//display instance gets its own framebuffer and a refresh path specialized for its configuration.
 
-//pin definitions, adjust as needed:
-#define CLK_PIN D5
-#define CS_PIN D6
-#define DIN_PIN D7
+#pragma once
 
-//number of displays:
-#define NUM_MAX 4
+#include <max7219_transport.h>
 
-//if your displays are rotated, change to 90, 270, or 0
-#define ROTATE 90
+//bus transport options. HSPI requires CLK on D5 and DIN on D7, bit-bang works on any pins.
+#define MAX7219_TRANSPORT_BITBANG 0
+#define MAX7219_TRANSPORT_HSPI    1
+
+//select the transport at build time, e.g. build_flags = -D MAX7219_TRANSPORT=MAX7219_TRANSPORT_BITBANG
+#ifndef MAX7219_TRANSPORT
+#define MAX7219_TRANSPORT MAX7219_TRANSPORT_HSPI
+#endif
 
 // MAX7219 commands:
 #define CMD_NOOP   0
@@ -29,122 +33,324 @@
 #define CMD_SHUTDOWN    12
 #define CMD_DISPLAYTEST 15
 
-uint8_t scr[NUM_MAX*8 + 8]; // +8 for scrolled char
+//the rotation kernels below pack the 8 column bytes of a chip into two 32-bit words (first byte in the top
+//byte of hi) and rearrange all 64 bits at once with shifts and masks, instead of testing them one at a time.
 
-//sends the byte cmd followed by the byte data to the MAX7219 at addr.
-void sendCmd(int addr, byte cmd, byte data)
+//packs the 8 bytes at p into hi/lo, in reverse order if reversed is set.
+inline void packColumns(const uint8_t *p, bool reversed, uint32_t &hi, uint32_t &lo)
 {
-  digitalWrite(CS_PIN, LOW);
-  for (int i = NUM_MAX-1; i>=0; i--) {
-    shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, i==addr ? cmd : 0);
-    shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, i==addr ? data : 0);
+  if(reversed) {
+    hi = (uint32_t)p[7] << 24 | (uint32_t)p[6] << 16 | (uint32_t)p[5] << 8 | p[4];
+    lo = (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+  } else {
+    hi = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    lo = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 8 | p[7];
   }
-  digitalWrite(CS_PIN, HIGH);
 }
 
-//sends the byte cmd and then the byte data to all (NUM_MAX) MAX7219 chips.
-void sendCmdAll(byte cmd, byte data)
+//unpacks hi/lo into the 8 digit register values in rows, in reverse order if reversed is set.
+inline void unpackRows(uint32_t hi, uint32_t lo, bool reversed, uint8_t *rows)
 {
-  digitalWrite(CS_PIN, LOW);
-  for (int i = NUM_MAX-1; i>=0; i--) {
-    shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, cmd);
-    shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, data);
+  if(reversed) {
+    rows[7] = hi >> 24; rows[6] = hi >> 16; rows[5] = hi >> 8; rows[4] = hi;
+    rows[3] = lo >> 24; rows[2] = lo >> 16; rows[1] = lo >> 8; rows[0] = lo;
+  } else {
+    rows[0] = hi >> 24; rows[1] = hi >> 16; rows[2] = hi >> 8; rows[3] = hi;
+    rows[4] = lo >> 24; rows[5] = lo >> 16; rows[6] = lo >> 8; rows[7] = lo;
   }
-  digitalWrite(CS_PIN, HIGH);
 }
 
-//this reloads the 8 bytes of display data to the MAX7219 chip at addr.
-void refresh(int addr) {
-  for (int i = 0; i < 8; i++)
-    sendCmd(addr, i + CMD_DIGIT0, scr[addr * 8 + i]);
+//transposes the packed 8x8 bit matrix: bit (7-j) of byte i swaps places with bit (7-i) of byte j.
+//three delta swaps exchange 1x1, 2x2 and then 4x4 blocks across the diagonal.
+inline void transpose8x8(uint32_t &hi, uint32_t &lo)
+{
+  uint32_t t;
+  t = (hi ^ (hi >> 7)) & 0x00AA00AAUL;  hi ^= t ^ (t << 7);
+  t = (lo ^ (lo >> 7)) & 0x00AA00AAUL;  lo ^= t ^ (t << 7);
+  t = (hi ^ (hi >> 14)) & 0x0000CCCCUL; hi ^= t ^ (t << 14);
+  t = (lo ^ (lo >> 14)) & 0x0000CCCCUL; lo ^= t ^ (t << 14);
+  t = (hi & 0xF0F0F0F0UL) | ((lo >> 4) & 0x0F0F0F0FUL);
+  lo = ((hi << 4) & 0xF0F0F0F0UL) | (lo & 0x0F0F0F0FUL);
+  hi = t;
+}
+
+//reverses the bit order within each of the 4 bytes of x.
+inline uint32_t reverseBitsPerByte(uint32_t x)
+{
+  x = ((x >> 1) & 0x55555555UL) | ((x & 0x55555555UL) << 1);
+  x = ((x >> 2) & 0x33333333UL) | ((x & 0x33333333UL) << 2);
+  x = ((x >> 4) & 0x0F0F0F0FUL) | ((x & 0x0F0F0F0FUL) << 4);
+  return x;
+}
+
+//returns the smallest power of two that is at least n, for sizing the framebuffer ring.
+constexpr int max7219RingSize(int n)
+{
+  int size = 8;
+  while(size < n) size <<= 1;
+  return size;
 }
 
-//this reloads all 8 bytes of display data to all (NUM_MAX) MAX7219 chips when ROTATE==270
-void refreshAllRot270() {
-  byte mask = 0x01;
-  for (int c = 0; c < 8; c++) {
-    digitalWrite(CS_PIN, LOW);
-    for(int i=NUM_MAX-1; i>=0; i--) {
-      byte bt = 0;
-      for(int b=0; b<8; b++) {
-        bt<<=1;
-        if(scr[i * 8 + b] & mask) bt|=0x01;
+//this is called by scrollLeft() to fill the newly exposed rightmost column. context is passed through untouched.
+typedef uint8_t (*Max7219ColumnSource)(void *context);
+
+//a chain of NumChips MAX7219 8x8 matrices mounted at Rotation (0, 90, 180 or 270) degrees, driven over Transport.
+//set Mirror to flip the digit register order of each chip after rotating, for mirrored modules.
+//the framebuffer holds one byte per display column, 8 per chip, with chip 0 being the first chip in the chain.
+//it is a ring of columns with a moving head, so scrolling moves the head instead of copying the whole buffer.
+template <uint8_t NumChips, uint16_t Rotation, class Transport, bool Mirror = false>
+class Max7219Display {
+  static_assert(NumChips > 0, "A MAX7219 chain needs at least one chip.");
+  static_assert(Rotation == 0 || Rotation == 90 || Rotation == 180 || Rotation == 270,
+                "Max7219Display rotation must be 0, 90, 180 or 270.");
+
+  public:
+    static constexpr uint8_t num_chips = NumChips;
+    static constexpr uint16_t rotation = Rotation;
+    static constexpr bool mirror = Mirror;
+    static constexpr int num_columns = NumChips * 8;
+
+    //the ring holds the visible columns plus at least 8 look-ahead columns, rounded up to a power of two.
+    static constexpr int ring_size = max7219RingSize(num_columns + 8);
+
+    Max7219Display(const Transport &transport) : _bus(transport) {}
+
+    //this will init the chips and clear the displays. Run during setup.
+    void begin()
+    {
+      _bus.begin();
+      sendCmdAll(CMD_DISPLAYTEST, 0);
+      sendCmdAll(CMD_SCANLIMIT, 7);
+      sendCmdAll(CMD_DECODEMODE, 0);
+      sendCmdAll(CMD_INTENSITY, 0); // minimum brightness
+      sendCmdAll(CMD_SHUTDOWN, 0);
+      clr();
+      forceRefreshAll();
+    }
+
+    //returns the framebuffer byte for display column x. Columns past num_columns are the scroll look-ahead.
+    uint8_t &column(int x) { return _ring[(_head + x) & (ring_size - 1)]; }
+
+    //returns a pointer to the framebuffer byte for display column x, and sets length to how many columns from x on
+    //follow it in memory before the ring wraps around, for writing a run of columns without indexing each one.
+    uint8_t *columnRun(int x, int &length)
+    {
+      int index = (_head + x) & (ring_size - 1);
+      length = ring_size - index;
+      return _ring + index;
+    }
+
+    //sets the function scrollLeft() calls to fill the rightmost column, or nullptr to scroll in the look-ahead columns.
+    void setColumnSource(Max7219ColumnSource source, void *context = nullptr)
+    {
+      _source = source;
+      _source_context = context;
+    }
+
+    //this counts every byte clocked out to this chain, for measuring bus traffic.
+    uint32_t bytesSent() const { return _bytes_sent; }
+
+    //sends the byte cmd followed by the byte data to the MAX7219 at addr.
+    void sendCmd(int addr, byte cmd, byte data)
+    {
+      //writing a digit register behind refreshAll()'s back means the shadow can no longer be trusted.
+      if(cmd >= CMD_DIGIT0 && cmd <= CMD_DIGIT7) _shadow_valid = false;
+      for (int i = NumChips-1; i>=0; i--) {
+        setFrameCmd(i, i==addr ? cmd : CMD_NOOP, i==addr ? data : 0);
       }
-      shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, CMD_DIGIT0 + c);
-      shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, bt);
+      sendFrame();
     }
-    digitalWrite(CS_PIN, HIGH);
-    mask<<=1;
-  }
-}
 
-//this reloads all 8 bytes of display data to all (NUM_MAX) MAX7219 chips when ROTATE==90
-void refreshAllRot90() {
-  byte mask = 0x80;
-  for (int c = 0; c < 8; c++) {
-    digitalWrite(CS_PIN, LOW);
-    for(int i=NUM_MAX-1; i>=0; i--) {
-      byte bt = 0;
-      for(int b=0; b<8; b++) {
-        bt>>=1;
-        if(scr[i * 8 + b] & mask) bt|=0x80;
+    //sends the byte cmd and then the byte data to all (NumChips) MAX7219 chips.
+    void sendCmdAll(byte cmd, byte data)
+    {
+      if(cmd >= CMD_DIGIT0 && cmd <= CMD_DIGIT7) _shadow_valid = false;
+      for (int i = NumChips-1; i>=0; i--) {
+        setFrameCmd(i, cmd, data);
       }
-      shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, CMD_DIGIT0 + c);
-      shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, bt);
+      sendFrame();
     }
-    digitalWrite(CS_PIN, HIGH);
-    mask>>=1;
-  }
-}
 
-//this reloads all 8 bytes of display data to all (NUM_MAX) MAX7219 chips when ROTATE==(0||90||270)
-void refreshAll() {
-#if ROTATE==270
-  refreshAllRot270();
-#elif ROTATE==90
-  refreshAllRot90();
-#else
-  for (int c = 0; c < 8; c++) {
-    digitalWrite(CS_PIN, LOW);
-    for(int i=NUM_MAX-1; i>=0; i--) {
-      shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, CMD_DIGIT0 + c);
-      shiftOut(DIN_PIN, CLK_PIN, MSBFIRST, scr[i * 8 + c]);
-    }
-    digitalWrite(CS_PIN, HIGH);
-  }
-#endif
-}
+    //this builds the 8 digit register values for the chip at addr from the framebuffer, using the kernel for Rotation.
+    void chipRows(int addr, uint8_t *rows) const
+    {
+      uint32_t hi, lo;
+      uint8_t gathered[8];
+      const uint8_t *columns = chipColumns(addr, gathered);
+      if constexpr (Rotation == 270) {
+        packColumns(columns, false, hi, lo);
+        transpose8x8(hi, lo);
+        unpackRows(hi, lo, !Mirror, rows);
+      } else if constexpr (Rotation == 180) {
+        packColumns(columns, true, hi, lo);
+        hi = reverseBitsPerByte(hi);
+        lo = reverseBitsPerByte(lo);
+        unpackRows(hi, lo, Mirror, rows);
+      } else if constexpr (Rotation == 90) {
+        packColumns(columns, true, hi, lo);
+        transpose8x8(hi, lo);
+        unpackRows(hi, lo, Mirror, rows);
+      } else {
+        packColumns(columns, false, hi, lo);
+        unpackRows(hi, lo, Mirror, rows);
+      }
+    }
 
-//this clears the screen.
-void clr()
-{
-  for (int i = 0; i < NUM_MAX*8; i++) scr[i] = 0;
-}
+    //this reloads the changed bytes of display data to the MAX7219 chip at addr.
+    void refresh(int addr)
+    {
+      uint8_t rows[NumChips][8];
+      memcpy(rows, _shadow, sizeof(rows));
+      chipRows(addr, rows[addr]);
+      _dirty[addr] = false;
+      if(!_shadow_valid) {
+        //the other chips' shadow rows are unknown, so only the chip at addr can be updated.
+        for (int c = 0; c < 8; c++) sendCmd(addr, CMD_DIGIT0 + c, rows[addr][c]);
+        return;
+      }
+      latchChangedRows(rows);
+    }
 
-//this shifts the bits in scr one to the left.
-void scrollLeft()
-{
-  for(int i=0; i < NUM_MAX*8+7; i++) scr[i] = scr[i+1];
-}
+    //this reloads the changed bytes of display data to all (NumChips) MAX7219 chips.
+    void refreshAll()
+    {
+      uint8_t rows[NumChips][8];
+      for(int i=0; i<NumChips; i++) chipRows(i, rows[i]);
+      memset(_dirty, 0, sizeof(_dirty));
+      latchChangedRows(rows);
+    }
 
-//this inverts the data in scr.
-void invert()
-{
-  for (int i = 0; i < NUM_MAX*8; i++) scr[i] = ~scr[i];
-}
+    //marks the chips showing display columns first up to last (not included) as changed, for refreshDirty().
+    //writes through column() are not tracked, so whatever draws them has to mark them.
+    void markDirty(int first, int last)
+    {
+      if(first < 0) first = 0;
+      if(last > num_columns) last = num_columns;
+      for (int addr = first / 8; addr * 8 < last; addr++) _dirty[addr] = true;
+    }
 
-//this will init the chip and clear the displays. Run during setup.
-void initMAX7219()
-{
-  pinMode(DIN_PIN, OUTPUT);
-  pinMode(CLK_PIN, OUTPUT);
-  pinMode(CS_PIN, OUTPUT);
-  digitalWrite(CS_PIN, HIGH);
-  sendCmdAll(CMD_DISPLAYTEST, 0);
-  sendCmdAll(CMD_SCANLIMIT, 7);
-  sendCmdAll(CMD_DECODEMODE, 0);
-  sendCmdAll(CMD_INTENSITY, 0); // minimum brightness
-  sendCmdAll(CMD_SHUTDOWN, 0);
-  clr();
-  refreshAll();
-}
+    //this reloads the changed bytes of display data to the chips marked by markDirty() since the last refresh.
+    //the rotation kernel only runs for those chips, the others are known to still match their shadow rows.
+    void refreshDirty()
+    {
+      if(!_shadow_valid) {
+        refreshAll();
+        return;
+      }
+      int first = 0;
+      while(first < NumChips && !_dirty[first]) first++;
+      if(first == NumChips) return;
+      int last = NumChips - 1;
+      while(!_dirty[last]) last--;
+      uint8_t rows[NumChips][8];
+      memcpy(rows, _shadow, sizeof(rows));
+      for(int i=first; i<=last; i++) {
+        if(_dirty[i]) chipRows(i, rows[i]);
+        _dirty[i] = false;
+      }
+      latchChangedRows(rows, first, last);
+    }
+
+    //this reloads all 8 bytes of display data to all (NumChips) MAX7219 chips, whether they changed or not.
+    //useful to recover chips that were glitched or power cycled on their own.
+    void forceRefreshAll()
+    {
+      _shadow_valid = false;
+      refreshAll();
+    }
+
+    //this clears the screen.
+    void clr()
+    {
+      for (int i = 0; i < NumChips*8; i++) column(i) = 0;
+    }
+
+    //this shifts the framebuffer one column to the left by advancing the ring head.
+    //the column that scrolls off is recycled as the last (blank) look-ahead column,
+    //and the column source, if there is one, fills in the newly exposed rightmost column.
+    void scrollLeft()
+    {
+      _head = (_head + 1) & (ring_size - 1);
+      column(ring_size - 1) = 0;
+      if(_source) column(num_columns - 1) = _source(_source_context);
+    }
+
+    //this inverts the data in the framebuffer.
+    void invert()
+    {
+      for (int i = 0; i < NumChips*8; i++) column(i) = ~column(i);
+    }
+
+  private:
+    Transport _bus;
+
+    uint8_t _ring[ring_size] = {};
+
+    //this is the ring index of display column 0.
+    uint16_t _head = 0;
+
+    Max7219ColumnSource _source = nullptr;
+    void *_source_context = nullptr;
+
+    //one cmd/data byte pair per chip. The last chip in the chain is shifted out first.
+    uint8_t _frame[NumChips*2];
+
+    //this is a copy of the digit register values last latched into each chip, so unchanged rows can be skipped.
+    uint8_t _shadow[NumChips][8];
+
+    //this is false until the shadow is known to match what the chips are showing.
+    bool _shadow_valid = false;
+
+    //the chips marked by markDirty() since they were last refreshed.
+    bool _dirty[NumChips] = {};
+
+    uint32_t _bytes_sent = 0;
+
+    //returns a pointer to the 8 columns of the chip at addr. They are read straight out of the ring when
+    //the head is chip aligned, otherwise they wrap or straddle slots and are copied into gathered first.
+    const uint8_t *chipColumns(int addr, uint8_t *gathered) const
+    {
+      if((_head & 7) == 0) return _ring + ((_head + addr * 8) & (ring_size - 1));
+      for (int b = 0; b < 8; b++) gathered[b] = _ring[(_head + addr * 8 + b) & (ring_size - 1)];
+      return gathered;
+    }
+
+    //stores the cmd/data pair for the chip at addr into _frame.
+    void setFrameCmd(int addr, byte cmd, byte data)
+    {
+      _frame[(NumChips-1-addr)*2] = cmd;
+      _frame[(NumChips-1-addr)*2 + 1] = data;
+    }
+
+    //latches _frame into the chain.
+    void sendFrame()
+    {
+      _bus.send(_frame, sizeof(_frame));
+      _bytes_sent += sizeof(_frame);
+    }
+
+    //this sends every row of rows[][] that differs from the shadow. Chips whose row is unchanged get CMD_NOOP,
+    //and rows that are unchanged on every chip are not sent at all.
+    //only chips first to last are compared, the rows of the others must match the shadow.
+    void latchChangedRows(uint8_t rows[NumChips][8], int first = 0, int last = NumChips - 1)
+    {
+      for (int c = 0; c < 8; c++) {
+        //most rows are unchanged on every chip, so look for a change before building the frame
+        bool row_changed = !_shadow_valid;
+        for(int i=first; i<=last && !row_changed; i++) {
+          row_changed = rows[i][c] != _shadow[i][c];
+        }
+        if(!row_changed) continue;
+        for(int i=NumChips-1; i>=0; i--) {
+          if(!_shadow_valid || rows[i][c] != _shadow[i][c]) {
+            setFrameCmd(i, CMD_DIGIT0 + c, rows[i][c]);
+            _shadow[i][c] = rows[i][c];
+          } else {
+            setFrameCmd(i, CMD_NOOP, 0);
+          }
+        }
+        sendFrame();
+      }
+      _shadow_valid = true;
+    }
+};
@@ -0,0 +1,72 @@
+// MAX7219 bus transports by kiyoshigawa
+//each transport latches one frame of bytes into the MAX7219 chain with a single CS pulse.
+//the display code only ever calls begin() and send(), so any class with those two methods can drive the chain.
+
+#pragma once
+
+#include <SPI.h>
+
+//the MAX7219 is rated for a 10MHz serial clock.
+#ifndef MAX7219_SPI_FREQUENCY
+#define MAX7219_SPI_FREQUENCY 10000000UL
+#endif
+
+//bit-banged transport, works on any three GPIO pins but costs several microseconds per bit.
+class Max7219BitBangTransport {
+  public:
+    Max7219BitBangTransport(uint8_t clk_pin, uint8_t cs_pin, uint8_t din_pin)
+      : _clk_pin(clk_pin), _cs_pin(cs_pin), _din_pin(din_pin) {}
+
+    //sets up the pins, run once before the first send().
+    void begin()
+    {
+      pinMode(_din_pin, OUTPUT);
+      pinMode(_clk_pin, OUTPUT);
+      pinMode(_cs_pin, OUTPUT);
+      digitalWrite(_cs_pin, HIGH);
+    }
+
+    //shifts out len bytes MSB first, then latches them into the chain.
+    void send(const uint8_t *data, size_t len)
+    {
+      digitalWrite(_cs_pin, LOW);
+      for (size_t i = 0; i < len; i++) {
+        shiftOut(_din_pin, _clk_pin, MSBFIRST, data[i]);
+      }
+      digitalWrite(_cs_pin, HIGH);
+    }
+
+  private:
+    uint8_t _clk_pin;
+    uint8_t _cs_pin;
+    uint8_t _din_pin;
+};
+
+//hardware SPI transport on the ESP8266 HSPI block. CLK must be on D5 (GPIO14) and DIN on D7 (GPIO13).
+//CS is toggled manually, so it can be on any pin - including D6 (GPIO12), which SPI.begin() claims
+//as MISO. begin() switches that pin back to a plain output after starting the SPI peripheral.
+class Max7219HspiTransport {
+  public:
+    Max7219HspiTransport(uint8_t cs_pin) : _cs_pin(cs_pin) {}
+
+    //starts the SPI peripheral and sets up the CS pin, run once before the first send().
+    void begin()
+    {
+      SPI.begin();
+      pinMode(_cs_pin, OUTPUT);
+      digitalWrite(_cs_pin, HIGH);
+    }
+
+    //writes len bytes through the SPI FIFO, then latches them into the chain.
+    void send(const uint8_t *data, size_t len)
+    {
+      SPI.beginTransaction(SPISettings(MAX7219_SPI_FREQUENCY, MSBFIRST, SPI_MODE0));
+      digitalWrite(_cs_pin, LOW);
+      SPI.writeBytes(data, len);
+      digitalWrite(_cs_pin, HIGH);
+      SPI.endTransaction();
+    }
+
+  private:
+    uint8_t _cs_pin;
+};
@@ -0,0 +1,112 @@
+// write-behind settings cache by kiyoshigawa
+//keeps the settings struct in RAM, so reading a setting never touches the flash. changing the settings only marks
+//them dirty, and update() writes the struct to the log once it has been left alone for a while, so pressing a
+//config button ten times in a row costs one flash write. call flush() before a planned restart.
+
+#pragma once
+
+#include <Arduino.h>
+#include <settings_log.h>
+#include <settings_schema.h>
+
+//how long the settings must stay unchanged before update() writes them, in milliseconds.
+#ifndef SETTINGS_CACHE_IDLE_TIME
+#define SETTINGS_CACHE_IDLE_TIME 5000UL
+#endif
+
+//settings that keep changing are still written once they have been dirty this long, in milliseconds.
+#ifndef SETTINGS_CACHE_MAX_DIRTY_TIME
+#define SETTINGS_CACHE_MAX_DIRTY_TIME 60000UL
+#endif
+
+//a Settings struct described by a SettingsSchema, stored in Log as a single value.
+template <class Log, class Settings>
+class SettingsCache {
+  static_assert(sizeof(Settings) <= SETTINGS_LOG_MAX_VALUE_SIZE, "The settings struct is too large for one log value.");
+
+  public:
+    //the schema is not copied and must outlive the cache.
+    SettingsCache(Log &log, const SettingsSchema<Log, Settings> &schema) : _log(log), _schema(schema) {}
+
+    //loads the settings from the log once, upgrading them if an older firmware stored them.
+    //returns the version they were stored by, 0 if the log holds none. the settings are then the defaults, or what
+    //the migrations from version 0 found.
+    uint8_t begin()
+    {
+      _dirty = false;
+      //an empty log still goes through settingsLoad(), so the migrations from version 0 run
+      _log.begin();
+      uint8_t version = settingsLoad(_schema, _log, _values);
+      //write upgraded settings back, so the migrations only ever run once
+      if(version != _schema.version) {
+        markDirty();
+      }
+      return version;
+    }
+
+    const Settings &get() const { return _values; }
+
+    //changes the settings in RAM, out of range fields are clamped. a later update() or flush() writes them.
+    void set(const Settings &values)
+    {
+      Settings clamped = values;
+      clamped.version = _schema.version;
+      settingsClamp(_schema, clamped);
+      if(memcmp(&clamped, &_values, sizeof(_values)) == 0) {
+        return;
+      }
+      _values = clamped;
+      markDirty();
+    }
+
+    //sets every setting back to its default.
+    void reset()
+    {
+      Settings values;
+      settingsDefaults(_schema, values);
+      set(values);
+    }
+
+    bool dirty() const { return _dirty; }
+
+    //run this every loop, it writes the settings once they have settled.
+    void update()
+    {
+      if(_dirty && (millis() - _last_change >= SETTINGS_CACHE_IDLE_TIME || millis() - _dirty_since >= SETTINGS_CACHE_MAX_DIRTY_TIME)) {
+        flush();
+      }
+    }
+
+    //writes the settings now as a single commit. if that fails they stay dirty and update() retries later.
+    bool flush()
+    {
+      if(!_dirty) {
+        return true;
+      }
+      SettingsLogEntry entry = {_schema.key, sizeof(_values), &_values};
+      if(!_log.commit(&entry, 1)) {
+        _last_change = millis();
+        _dirty_since = millis();
+        return false;
+      }
+      _dirty = false;
+      return true;
+    }
+
+  private:
+    Log &_log;
+    const SettingsSchema<Log, Settings> &_schema;
+    Settings _values;
+    bool _dirty = false;
+    uint32_t _last_change = 0;
+    uint32_t _dirty_since = 0;
+
+    void markDirty()
+    {
+      if(!_dirty) {
+        _dirty_since = millis();
+      }
+      _dirty = true;
+      _last_change = millis();
+    }
+};
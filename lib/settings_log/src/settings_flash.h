@@ -0,0 +1,58 @@
+// ESP8266 flash region for the settings log by kiyoshigawa
+//the log only calls sectors(), read(), write() and erase() with addresses relative to the start of its region,
+//so any class with those four methods can hold it.
+
+#pragma once
+
+#include <Arduino.h>
+#include <spi_flash.h>
+
+//the linker scripts place these around the filesystem area of the flash.
+extern "C" uint32_t _FS_start;
+extern "C" uint32_t _FS_end;
+
+//the flash is mapped to this address, the linker symbols above are relative to it.
+#define SETTINGS_FLASH_MAP_ADDRESS 0x40200000UL
+
+//a run of whole flash sectors, written through the SDK's spi_flash functions.
+class SettingsEspFlash {
+  public:
+    SettingsEspFlash(uint32_t first_sector, uint8_t num_sectors) : _first_sector(first_sector), _num_sectors(num_sectors) {}
+
+    //the last num_sectors sectors of the filesystem area, for sketches that don't mount a filesystem.
+    //if the flash layout has a smaller filesystem area, or none, the region is empty and the log won't write to it.
+    //there is no fallback to the single EEPROM sector, a log in one sector loses its settings on a badly timed
+    //power cut (see SETTINGS_LOG_MIN_SECTORS).
+    static SettingsEspFlash fromLayout(uint8_t num_sectors)
+    {
+      uint32_t fs_start = ((uint32_t)(uintptr_t)&_FS_start - SETTINGS_FLASH_MAP_ADDRESS) / SPI_FLASH_SEC_SIZE;
+      uint32_t fs_end = ((uint32_t)(uintptr_t)&_FS_end - SETTINGS_FLASH_MAP_ADDRESS) / SPI_FLASH_SEC_SIZE;
+      if(fs_end >= fs_start + num_sectors) {
+        return SettingsEspFlash(fs_end - num_sectors, num_sectors);
+      }
+      return SettingsEspFlash(0, 0);
+    }
+
+    uint8_t sectors() const { return _num_sectors; }
+
+    //address and size must be multiples of 4.
+    bool read(uint32_t address, uint32_t *data, size_t size)
+    {
+      return ESP.flashRead(_first_sector * SPI_FLASH_SEC_SIZE + address, data, size);
+    }
+
+    //address and size must be multiples of 4, and the words written must still be erased.
+    bool write(uint32_t address, const uint32_t *data, size_t size)
+    {
+      return ESP.flashWrite(_first_sector * SPI_FLASH_SEC_SIZE + address, data, size);
+    }
+
+    bool erase(uint8_t sector)
+    {
+      return ESP.flashEraseSector(_first_sector + sector);
+    }
+
+  private:
+    uint32_t _first_sector;
+    uint8_t _num_sectors;
+};
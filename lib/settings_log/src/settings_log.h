@@ -0,0 +1,332 @@
+// log-structured settings store by kiyoshigawa
+//settings are appended to a flash sector as records. one record holds every setting changed by one commit(), with a
+//sequence number and a CRC, so a commit is a single flash write and a torn one is simply ignored on the next boot.
+//only when the sector is full are the newest values copied into the next sector of the region as one record, so a
+//sector is erased once per few hundred changes instead of on every write, and the erases rotate through the region.
+//the flash is reached through a class with sectors(), read(), write() and erase(), like SettingsEspFlash.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+//NOR flash erases to all ones and writes can only clear bits, in sectors of this many bytes.
+#define SETTINGS_LOG_SECTOR_SIZE 4096U
+#define SETTINGS_LOG_ERASED 0xFFFFFFFFUL
+
+//the fewest sectors a log writes to. a compaction writes the new copy of the settings to another sector before the
+//old one is erased, with a single sector a power cut in between would lose them.
+#define SETTINGS_LOG_MIN_SECTORS 2
+
+//the first word of a sector in use, "SLOG".
+#define SETTINGS_LOG_MAGIC 0x474F4C53UL
+
+//how many different keys the log keeps track of.
+#ifndef SETTINGS_LOG_MAX_KEYS
+#define SETTINGS_LOG_MAX_KEYS 16
+#endif
+
+//the largest value of one key, and of one record with all its entries. records are built on the stack.
+#define SETTINGS_LOG_MAX_VALUE_SIZE 64U
+#define SETTINGS_LOG_MAX_RECORD_SIZE 256U
+
+//a sector starts with a header of the magic and the sequence number of its first record, the records follow.
+//a record is a header of sequence number, payload length and CRC-32, then the payload: one entry per setting of
+//key, value size and two padding bytes, then the value padded to a multiple of 4 bytes.
+#define SETTINGS_LOG_SECTOR_HEADER_SIZE 8U
+#define SETTINGS_LOG_RECORD_HEADER_SIZE 12U
+#define SETTINGS_LOG_ENTRY_HEADER_SIZE 4U
+
+//one setting to commit(), size is in bytes.
+struct SettingsLogEntry {
+  uint8_t key;
+  uint8_t size;
+  const void *value;
+};
+
+//one byte of the standard reflected CRC-32 as used by zlib, on the inverted crc. constexpr for layout checksums.
+constexpr uint32_t settingsCrc32Byte(uint32_t crc, uint8_t byte)
+{
+  crc ^= byte;
+  for(uint8_t bit = 0; bit < 8; bit++) {
+    crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+  }
+  return crc;
+}
+
+inline uint32_t settingsLogCrc32(const void *data, size_t length, uint32_t crc = 0)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  crc = ~crc;
+  while(length--) {
+    crc = settingsCrc32Byte(crc, *bytes++);
+  }
+  return ~crc;
+}
+
+template <class Flash>
+class SettingsLog {
+  public:
+    SettingsLog(const Flash &flash) : _flash(flash) {}
+
+    //finds the newest sector in use and indexes the newest value of each key in it.
+    //returns false if the region holds no log yet, the first commit() will start one.
+    bool begin()
+    {
+      _active = NO_SECTOR;
+      _num_keys = 0;
+      uint32_t newest = 0;
+      for(uint8_t sector = 0; sector < _flash.sectors(); sector++) {
+        uint32_t header[2];
+        if(!_flash.read(sector * SETTINGS_LOG_SECTOR_SIZE, header, sizeof(header)) || header[0] != SETTINGS_LOG_MAGIC) {
+          continue;
+        }
+        if(_active == NO_SECTOR || header[1] > newest) {
+          _active = sector;
+          newest = header[1];
+        }
+      }
+      if(_active == NO_SECTOR) {
+        return false;
+      }
+      scan(newest);
+      return true;
+    }
+
+    //copies the first size bytes of the newest value of key into value.
+    //returns false if key was never written or its value is shorter than size.
+    bool read(uint8_t key, void *value, uint8_t size)
+    {
+      int8_t slot = findKey(key);
+      if(slot < 0 || _index[slot].size < size) {
+        return false;
+      }
+      uint32_t words[SETTINGS_LOG_MAX_VALUE_SIZE / 4];
+      if(!_flash.read(_active * SETTINGS_LOG_SECTOR_SIZE + _index[slot].offset, words, (size + 3) & ~3)) {
+        return false;
+      }
+      memcpy(value, words, size);
+      return true;
+    }
+
+    //the size of the newest value of key, or 0 if it was never written.
+    uint8_t size(uint8_t key)
+    {
+      int8_t slot = findKey(key);
+      return slot < 0 ? 0 : _index[slot].size;
+    }
+
+    //false if the region is smaller than SETTINGS_LOG_MIN_SECTORS, commit() then always fails.
+    bool writable() const { return _flash.sectors() >= SETTINGS_LOG_MIN_SECTORS; }
+
+    //writes all count entries as one record, so either all of them or none are stored if the power fails.
+    bool commit(const SettingsLogEntry *entries, uint8_t count)
+    {
+      if(!writable()) {
+        return false;
+      }
+      uint32_t record[SETTINGS_LOG_MAX_RECORD_SIZE / 4];
+      uint16_t length = 0;
+      uint8_t new_keys = 0;
+      for(uint8_t i = 0; i < count; i++) {
+        if(findKey(entries[i].key) < 0) {
+          new_keys++;
+        }
+        if(!appendEntry(record, length, entries[i].key, entries[i].size, entries[i].value)) {
+          return false;
+        }
+      }
+      if(_num_keys + new_keys > SETTINGS_LOG_MAX_KEYS) {
+        return false;
+      }
+
+      //append to the active sector while the record fits, otherwise start the next sector with a copy of everything
+      uint32_t size = SETTINGS_LOG_RECORD_HEADER_SIZE + length;
+      if(_active == NO_SECTOR || _write_offset + size > SETTINGS_LOG_SECTOR_SIZE) {
+        return compact(entries, count);
+      }
+      if(!writeRecord(_active, _write_offset, _sequence + 1, record, length)) {
+        //whatever part of the record made it to the flash can't be written over, so don't append after it
+        _write_offset = SETTINGS_LOG_SECTOR_SIZE;
+        return false;
+      }
+      indexRecord(_write_offset, record, length);
+      _sequence++;
+      _write_offset += size;
+      return true;
+    }
+
+    //erases the whole region, forgetting every setting.
+    bool clear()
+    {
+      bool ok = true;
+      for(uint8_t sector = 0; sector < _flash.sectors(); sector++) {
+        ok &= _flash.erase(sector);
+      }
+      _active = NO_SECTOR;
+      _num_keys = 0;
+      return ok;
+    }
+
+    //the sequence number of the newest record, it goes up by one per commit().
+    uint32_t sequence() const { return _sequence; }
+
+    //how many more bytes of records fit before the next commit() has to start a new sector.
+    uint16_t bytesFree() const { return _active == NO_SECTOR ? 0 : SETTINGS_LOG_SECTOR_SIZE - _write_offset; }
+
+  private:
+    static constexpr uint8_t NO_SECTOR = 0xFF;
+
+    //where the newest value of one key is in the active sector.
+    struct IndexEntry {
+      uint8_t key;
+      uint8_t size;
+      uint16_t offset;
+    };
+
+    Flash _flash;
+    uint8_t _active = NO_SECTOR;
+    uint16_t _write_offset = SETTINGS_LOG_SECTOR_SIZE;
+    uint32_t _sequence = 0;
+    IndexEntry _index[SETTINGS_LOG_MAX_KEYS];
+    uint8_t _num_keys = 0;
+
+    int8_t findKey(uint8_t key)
+    {
+      for(uint8_t i = 0; i < _num_keys; i++) {
+        if(_index[i].key == key) {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+    //adds one entry to the payload in record, returning false if it doesn't fit.
+    static bool appendEntry(uint32_t *record, uint16_t &length, uint8_t key, uint8_t size, const void *value)
+    {
+      uint16_t padded = (size + 3) & ~3;
+      if(size == 0 || size > SETTINGS_LOG_MAX_VALUE_SIZE ||
+         SETTINGS_LOG_RECORD_HEADER_SIZE + length + SETTINGS_LOG_ENTRY_HEADER_SIZE + padded > SETTINGS_LOG_MAX_RECORD_SIZE) {
+        return false;
+      }
+      uint8_t *payload = (uint8_t *)(record + SETTINGS_LOG_RECORD_HEADER_SIZE / 4) + length;
+      payload[0] = key;
+      payload[1] = size;
+      payload[2] = 0xFF;
+      payload[3] = 0xFF;
+      memset(payload + SETTINGS_LOG_ENTRY_HEADER_SIZE, 0xFF, padded);
+      memcpy(payload + SETTINGS_LOG_ENTRY_HEADER_SIZE, value, size);
+      length += SETTINGS_LOG_ENTRY_HEADER_SIZE + padded;
+      return true;
+    }
+
+    //fills in the header of the record built in record and writes it in one go.
+    bool writeRecord(uint8_t sector, uint16_t offset, uint32_t sequence, uint32_t *record, uint16_t length)
+    {
+      record[0] = sequence;
+      record[1] = length;
+      record[2] = settingsLogCrc32(record, 8);
+      record[2] = settingsLogCrc32(record + SETTINGS_LOG_RECORD_HEADER_SIZE / 4, length, record[2]);
+      return _flash.write(sector * SETTINGS_LOG_SECTOR_SIZE + offset, record, SETTINGS_LOG_RECORD_HEADER_SIZE + length);
+    }
+
+    //points the index at the values of a record stored at offset in the active sector.
+    void indexRecord(uint16_t offset, const uint32_t *record, uint16_t length)
+    {
+      const uint8_t *payload = (const uint8_t *)(record + SETTINGS_LOG_RECORD_HEADER_SIZE / 4);
+      for(uint16_t i = 0; i + SETTINGS_LOG_ENTRY_HEADER_SIZE <= length;) {
+        uint8_t key = payload[i];
+        uint8_t size = payload[i + 1];
+        int8_t slot = findKey(key);
+        if(slot < 0) {
+          if(_num_keys == SETTINGS_LOG_MAX_KEYS) {
+            return;
+          }
+          slot = _num_keys++;
+        }
+        _index[slot].key = key;
+        _index[slot].size = size;
+        _index[slot].offset = offset + SETTINGS_LOG_RECORD_HEADER_SIZE + i + SETTINGS_LOG_ENTRY_HEADER_SIZE;
+        i += SETTINGS_LOG_ENTRY_HEADER_SIZE + ((size + 3) & ~3);
+      }
+    }
+
+    //reads the records of the active sector in order, up to the erased space after the last one.
+    //a record that fails its CRC was torn by a power loss, the log ends before it and the next commit() compacts.
+    void scan(uint32_t first_sequence)
+    {
+      uint32_t record[SETTINGS_LOG_MAX_RECORD_SIZE / 4];
+      uint32_t base = _active * SETTINGS_LOG_SECTOR_SIZE;
+      uint32_t expected = first_sequence;
+      uint16_t offset = SETTINGS_LOG_SECTOR_HEADER_SIZE;
+      _num_keys = 0;
+      _sequence = first_sequence - 1;
+      _write_offset = SETTINGS_LOG_SECTOR_SIZE;
+      while(offset + SETTINGS_LOG_RECORD_HEADER_SIZE <= SETTINGS_LOG_SECTOR_SIZE) {
+        if(!_flash.read(base + offset, record, SETTINGS_LOG_RECORD_HEADER_SIZE)) {
+          return;
+        }
+        if(record[0] == SETTINGS_LOG_ERASED && record[1] == SETTINGS_LOG_ERASED && record[2] == SETTINGS_LOG_ERASED) {
+          break;
+        }
+        uint32_t length = record[1];
+        if(record[0] != expected || length % 4 || length > SETTINGS_LOG_MAX_RECORD_SIZE - SETTINGS_LOG_RECORD_HEADER_SIZE ||
+           offset + SETTINGS_LOG_RECORD_HEADER_SIZE + length > SETTINGS_LOG_SECTOR_SIZE ||
+           !_flash.read(base + offset + SETTINGS_LOG_RECORD_HEADER_SIZE, record + SETTINGS_LOG_RECORD_HEADER_SIZE / 4, length)) {
+          return;
+        }
+        uint32_t crc = settingsLogCrc32(record, 8);
+        if(settingsLogCrc32(record + SETTINGS_LOG_RECORD_HEADER_SIZE / 4, length, crc) != record[2]) {
+          return;
+        }
+        indexRecord(offset, record, length);
+        _sequence = expected++;
+        offset += SETTINGS_LOG_RECORD_HEADER_SIZE + length;
+      }
+      _write_offset = offset;
+    }
+
+    //writes entries and the newest value of every other key as the first record of the next sector.
+    //the sector header goes last, magic after sequence, so until the copy is complete the old sector stays the newest one.
+    bool compact(const SettingsLogEntry *entries, uint8_t count)
+    {
+      uint32_t record[SETTINGS_LOG_MAX_RECORD_SIZE / 4];
+      uint16_t length = 0;
+      for(uint8_t i = 0; i < count; i++) {
+        appendEntry(record, length, entries[i].key, entries[i].size, entries[i].value);
+      }
+      for(uint8_t slot = 0; slot < _num_keys; slot++) {
+        bool replaced = false;
+        for(uint8_t i = 0; i < count; i++) {
+          replaced |= entries[i].key == _index[slot].key;
+        }
+        if(replaced) {
+          continue;
+        }
+        uint8_t value[SETTINGS_LOG_MAX_VALUE_SIZE];
+        if(!read(_index[slot].key, value, _index[slot].size) ||
+           !appendEntry(record, length, _index[slot].key, _index[slot].size, value)) {
+          return false;
+        }
+      }
+
+      uint8_t target = _active == NO_SECTOR ? 0 : (_active + 1) % _flash.sectors();
+      uint32_t sequence = _sequence + 1;
+      uint32_t magic = SETTINGS_LOG_MAGIC;
+      if(!_flash.erase(target) || !writeRecord(target, SETTINGS_LOG_SECTOR_HEADER_SIZE, sequence, record, length) ||
+         !_flash.write(target * SETTINGS_LOG_SECTOR_SIZE + 4, &sequence, 4) ||
+         !_flash.write(target * SETTINGS_LOG_SECTOR_SIZE, &magic, 4)) {
+        if(target == _active) {
+          _active = NO_SECTOR;
+          _num_keys = 0;
+        }
+        return false;
+      }
+      _active = target;
+      _num_keys = 0;
+      indexRecord(SETTINGS_LOG_SECTOR_HEADER_SIZE, record, length);
+      _sequence = sequence;
+      _write_offset = SETTINGS_LOG_SECTOR_HEADER_SIZE + SETTINGS_LOG_RECORD_HEADER_SIZE + length;
+      return true;
+    }
+};
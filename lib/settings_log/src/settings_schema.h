@@ -0,0 +1,161 @@
+// settings schema by kiyoshigawa
+//describes a packed settings struct field by field: where each field is, its range and default, and the schema
+//version that added it. fields are only ever appended, so the bytes stored by an older version are a prefix of the
+//current struct and load in one read, the fields added since then keep their defaults.
+//the struct's first member must be a uint8_t version, it is not one of the fields.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <settings_log.h>
+
+//one field of a settings struct.
+struct SettingsField {
+  uint8_t offset;
+  uint8_t size;         //1, 2 or 4 bytes
+  bool is_signed;
+  uint8_t since;        //the schema version that added the field
+  int32_t min;
+  int32_t max;
+  int32_t value;        //the default
+};
+
+//upgrades settings stored by version from_version to the next one. it runs after the stored bytes are loaded, when
+//the fields added since then hold their defaults, and can read keys an older firmware used from the log, or settings
+//it kept somewhere else. from version 0 there are no stored bytes, it also runs when the log is empty.
+template <class Log, class Settings>
+struct SettingsMigration {
+  uint8_t from_version;
+  void (*migrate)(Log &log, Settings &values);
+};
+
+//everything needed to store one settings struct as the value of key.
+template <class Log, class Settings>
+struct SettingsSchema {
+  uint8_t key;
+  uint8_t version;
+  const SettingsField *fields;
+  uint8_t num_fields;
+  const SettingsMigration<Log, Settings> *migrations;
+  uint8_t num_migrations;
+};
+
+//the packed size of the fields of version, with the version byte in front.
+template <size_t N>
+constexpr uint8_t settingsLayoutSize(const SettingsField (&fields)[N], uint8_t version = 0xFF)
+{
+  uint8_t size = 1;
+  for(size_t i = 0; i < N; i++) {
+    if(fields[i].since <= version) {
+      size += fields[i].size;
+    }
+  }
+  return size;
+}
+
+//a CRC-32 of the position, size, signedness and version of the fields of version, names and ranges don't count.
+//pinning it with a static_assert catches a released layout being changed instead of appended to.
+template <size_t N>
+constexpr uint32_t settingsLayoutCrc(const SettingsField (&fields)[N], uint8_t version)
+{
+  uint32_t crc = 0xFFFFFFFFUL;
+  for(size_t i = 0; i < N; i++) {
+    if(fields[i].since <= version) {
+      crc = settingsCrc32Byte(crc, fields[i].offset);
+      crc = settingsCrc32Byte(crc, fields[i].size);
+      crc = settingsCrc32Byte(crc, fields[i].is_signed);
+      crc = settingsCrc32Byte(crc, fields[i].since);
+    }
+  }
+  return ~crc;
+}
+
+//true if the fields are packed back to back after the version byte, in the order of the versions that added them.
+template <size_t N>
+constexpr bool settingsLayoutIsAppendOnly(const SettingsField (&fields)[N])
+{
+  uint8_t offset = 1;
+  for(size_t i = 0; i < N; i++) {
+    if(fields[i].offset != offset || (i > 0 && fields[i].since < fields[i - 1].since) ||
+       (fields[i].size != 1 && fields[i].size != 2 && fields[i].size != 4)) {
+      return false;
+    }
+    offset += fields[i].size;
+  }
+  return true;
+}
+
+inline int32_t settingsFieldGet(const SettingsField &field, const void *values)
+{
+  const uint8_t *p = (const uint8_t *)values + field.offset;
+  if(field.size == 1) {
+    return field.is_signed ? (int32_t)(int8_t)*p : (int32_t)*p;
+  }
+  if(field.size == 2) {
+    uint16_t value;
+    memcpy(&value, p, 2);
+    return field.is_signed ? (int32_t)(int16_t)value : (int32_t)value;
+  }
+  int32_t value;
+  memcpy(&value, p, 4);
+  return value;
+}
+
+inline void settingsFieldSet(const SettingsField &field, void *values, int32_t value)
+{
+  //the struct is little endian like the ESP8266, so the low bytes come first for every size
+  memcpy((uint8_t *)values + field.offset, &value, field.size);
+}
+
+//sets every field of values and the version to their defaults.
+template <class Log, class Settings>
+void settingsDefaults(const SettingsSchema<Log, Settings> &schema, Settings &values)
+{
+  memset(&values, 0, sizeof(values));
+  values.version = schema.version;
+  for(uint8_t i = 0; i < schema.num_fields; i++) {
+    settingsFieldSet(schema.fields[i], &values, schema.fields[i].value);
+  }
+}
+
+//puts every field of values back in its range, returning false if one was out of it.
+template <class Log, class Settings>
+bool settingsClamp(const SettingsSchema<Log, Settings> &schema, Settings &values)
+{
+  bool valid = true;
+  for(uint8_t i = 0; i < schema.num_fields; i++) {
+    const SettingsField &field = schema.fields[i];
+    int32_t value = settingsFieldGet(field, &values);
+    if(value < field.min || value > field.max) {
+      settingsFieldSet(field, &values, value < field.min ? field.min : field.max);
+      valid = false;
+    }
+  }
+  return valid;
+}
+
+//loads values from the log in one read and upgrades them to the schema's version.
+//returns the version they were stored by, 0 if the key was never written. the log must have been begun.
+template <class Log, class Settings>
+uint8_t settingsLoad(const SettingsSchema<Log, Settings> &schema, Log &log, Settings &values)
+{
+  settingsDefaults(schema, values);
+  uint8_t stored = log.size(schema.key);
+  //a newer firmware may have appended fields, those are left out
+  if(stored > sizeof(values)) {
+    stored = sizeof(values);
+  }
+  uint8_t version = 0;
+  if(stored && log.read(schema.key, &values, stored)) {
+    version = values.version;
+  }
+  for(uint8_t i = 0; i < schema.num_migrations; i++) {
+    if(schema.migrations[i].from_version >= version && schema.migrations[i].from_version < schema.version) {
+      schema.migrations[i].migrate(log, values);
+    }
+  }
+  values.version = schema.version;
+  settingsClamp(schema, values);
+  return version;
+}
@@ -0,0 +1,318 @@
+// POSIX TZ rule timezone by kiyoshigawa
+//converts UTC epoch times to local time using a POSIX TZ string, e.g. "MST7MDT,M3.2.0,M11.1.0".
+//the offset in effect and the period it is valid for are cached, so converting a time within that period only
+//costs one compare. the transitions are only worked out again once the time leaves the period.
+
+#pragma once
+
+#include <stdint.h>
+
+//POSIX leaves the rules of a DST zone without any up to the implementation, this uses the current US ones.
+#define TIMEZONE_DEFAULT_DST_RULES "M3.2.0,M11.1.0"
+
+//the local time of day a rule switches at when the TZ string doesn't give one, in seconds (02:00:00).
+#define TIMEZONE_DEFAULT_TRANSITION_TIME 7200L
+
+//days from Jan. 1, 1970 to year-month-day, from http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+inline int32_t timezoneDaysFromCivil(int32_t year, uint8_t month, uint8_t day)
+{
+  year -= month <= 2;
+  int32_t era = (year >= 0 ? year : year - 399) / 400;
+  uint32_t year_of_era = year - era * 400;
+  uint32_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + (int32_t)day_of_era - 719468;
+}
+
+//the year that days since Jan. 1, 1970 falls in, days must not be negative.
+inline int32_t timezoneYearOfDays(uint32_t days)
+{
+  uint32_t day_number = days + 719468;
+  uint32_t era = day_number / 146097;
+  uint32_t day_of_era = day_number - era * 146097;
+  uint32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+  uint32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  //the year above starts in March, so January and February belong to the next one
+  return era * 400 + year_of_era + (day_of_year >= 306);
+}
+
+inline bool timezoneIsLeapYear(int32_t year)
+{
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+//one of the two yearly switches of a TZ string.
+struct TimezoneRule {
+  char type;        //'M' for month.week.weekday, 'J' for a day of the year 1-365 without Feb. 29, 'D' for 0-365 with it
+  uint16_t day;     //day of the year for 'J' and 'D', weekday (0 is Sunday) for 'M'
+  uint8_t month;
+  uint8_t week;     //1-5, 5 is the last one of the month
+  int32_t time;     //local time of day in seconds, may be negative or past midnight
+};
+
+class PosixTimezone {
+  public:
+    //parses a POSIX TZ string, returning false if it isn't one. the timezone is UTC in that case.
+    bool begin(const char *tz)
+    {
+      _period_start = 0;
+      _period_length = 0;
+      if(tz && parse(tz)) {
+        return true;
+      }
+      _has_dst = false;
+      _std_offset = 0;
+      _dst_offset = 0;
+      return false;
+    }
+
+    //the offset from UTC in seconds at the UTC time utc.
+    int32_t offsetAt(uint32_t utc)
+    {
+      //unsigned wrap-around makes this one compare cover both ends of the period
+      if(utc - _period_start >= _period_length) {
+        findPeriod(utc);
+      }
+      return _offset;
+    }
+
+    //the local time at the UTC time utc.
+    uint32_t toLocal(uint32_t utc)
+    {
+      return utc + offsetAt(utc);
+    }
+
+    //true if daylight saving time is in effect at the UTC time utc.
+    bool isDst(uint32_t utc)
+    {
+      offsetAt(utc);
+      return _is_dst;
+    }
+
+    //the UTC time the offset found by the last call changes, or 0xFFFFFFFF if it never does.
+    uint32_t nextTransition()
+    {
+      return _period_start + _period_length;
+    }
+
+    //the UTC time the offset found by the last call took effect, or 0 if it always has.
+    uint32_t previousTransition()
+    {
+      return _period_start;
+    }
+
+    int32_t standardOffset() { return _std_offset; }
+    int32_t dstOffset() { return _has_dst ? _dst_offset : _std_offset; }
+    bool hasDst() { return _has_dst; }
+
+  private:
+    int32_t _std_offset = 0;
+    int32_t _dst_offset = 0;
+    bool _has_dst = false;
+    TimezoneRule _dst_start;
+    TimezoneRule _dst_end;
+
+    //the cached period, [_period_start, _period_start + _period_length), and the offset in effect during it.
+    uint32_t _period_start = 0;
+    uint32_t _period_length = 0;
+    int32_t _offset = 0;
+    bool _is_dst = false;
+
+    //parses std offset [dst [offset] [,start[/time],end[/time]]].
+    bool parse(const char *tz)
+    {
+      _has_dst = false;
+      if(!parseName(tz) || !parseOffset(tz, _std_offset)) {
+        return false;
+      }
+      //POSIX offsets count west of Greenwich, so UTC-7 is written as 7
+      _std_offset = -_std_offset;
+      if(!*tz) {
+        return true;
+      }
+
+      if(!parseName(tz)) {
+        return false;
+      }
+      _dst_offset = _std_offset + 3600;
+      if(*tz && *tz != ',') {
+        if(!parseOffset(tz, _dst_offset)) {
+          return false;
+        }
+        _dst_offset = -_dst_offset;
+      }
+      const char *rules = *tz == ',' ? tz + 1 : TIMEZONE_DEFAULT_DST_RULES;
+      if(!parseRule(rules, _dst_start) || *rules++ != ',' || !parseRule(rules, _dst_end) || *rules) {
+        return false;
+      }
+      _has_dst = true;
+      return true;
+    }
+
+    //skips a zone abbreviation, either letters or anything between angle brackets like <+05>.
+    static bool parseName(const char *&tz)
+    {
+      const char *start = tz;
+      if(*tz == '<') {
+        while(*tz && *tz != '>') {
+          tz++;
+        }
+        if(*tz++ != '>') {
+          return false;
+        }
+        return tz - start > 2;
+      }
+      while((*tz >= 'A' && *tz <= 'Z') || (*tz >= 'a' && *tz <= 'z')) {
+        tz++;
+      }
+      return tz - start >= 3;
+    }
+
+    static bool parseNumber(const char *&tz, int32_t &value)
+    {
+      if(*tz < '0' || *tz > '9') {
+        return false;
+      }
+      value = 0;
+      while(*tz >= '0' && *tz <= '9') {
+        value = value * 10 + (*tz++ - '0');
+      }
+      return true;
+    }
+
+    //parses [+|-]hh[:mm[:ss]] into seconds.
+    static bool parseOffset(const char *&tz, int32_t &seconds)
+    {
+      bool negative = *tz == '-';
+      if(*tz == '+' || *tz == '-') {
+        tz++;
+      }
+      int32_t part;
+      if(!parseNumber(tz, part)) {
+        return false;
+      }
+      seconds = part * 3600;
+      for(int32_t scale = 60; scale >= 1 && *tz == ':'; scale /= 60) {
+        tz++;
+        if(!parseNumber(tz, part)) {
+          return false;
+        }
+        seconds += part * scale;
+      }
+      if(negative) {
+        seconds = -seconds;
+      }
+      return true;
+    }
+
+    //parses Mm.w.d, Jn or n, optionally followed by /time.
+    static bool parseRule(const char *&tz, TimezoneRule &rule)
+    {
+      int32_t value;
+      rule.time = TIMEZONE_DEFAULT_TRANSITION_TIME;
+      if(*tz == 'M') {
+        tz++;
+        rule.type = 'M';
+        if(!parseNumber(tz, value) || value < 1 || value > 12 || *tz++ != '.') {
+          return false;
+        }
+        rule.month = value;
+        if(!parseNumber(tz, value) || value < 1 || value > 5 || *tz++ != '.') {
+          return false;
+        }
+        rule.week = value;
+        if(!parseNumber(tz, value) || value > 6) {
+          return false;
+        }
+        rule.day = value;
+      } else {
+        rule.type = *tz == 'J' ? 'J' : 'D';
+        if(*tz == 'J') {
+          tz++;
+        }
+        if(!parseNumber(tz, value) || value > 365 || (rule.type == 'J' && value < 1)) {
+          return false;
+        }
+        rule.day = value;
+      }
+      if(*tz == '/') {
+        tz++;
+        return parseOffset(tz, rule.time);
+      }
+      return true;
+    }
+
+    //days since Jan. 1, 1970 of the day rule switches on in year.
+    static int32_t ruleDay(const TimezoneRule &rule, int32_t year)
+    {
+      int32_t jan_first = timezoneDaysFromCivil(year, 1, 1);
+      if(rule.type == 'J') {
+        //Feb. 29 is never counted, so from March on leap years are one day further along
+        return jan_first + rule.day - 1 + (timezoneIsLeapYear(year) && rule.day >= 60);
+      }
+      if(rule.type == 'D') {
+        return jan_first + rule.day;
+      }
+      static const uint8_t month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+      int32_t first = timezoneDaysFromCivil(year, rule.month, 1);
+      //Jan. 1, 1970 was a Thursday
+      int32_t first_weekday = ((first % 7) + 11) % 7;
+      int32_t day_of_month = 1 + (rule.day - first_weekday + 7) % 7 + (rule.week - 1) * 7;
+      int32_t month_length = month_days[rule.month - 1] + (rule.month == 2 && timezoneIsLeapYear(year));
+      while(day_of_month > month_length) {
+        day_of_month -= 7;
+      }
+      return first + day_of_month - 1;
+    }
+
+    //works out the offset in effect at utc and the period it lasts, from the transitions around it.
+    void findPeriod(uint32_t utc)
+    {
+      if(!_has_dst) {
+        _offset = _std_offset;
+        _is_dst = false;
+        _period_start = 0;
+        _period_length = 0xFFFFFFFFUL;
+        return;
+      }
+
+      //the transitions of the year before, this one and the next always surround utc.
+      //DST starts at a local standard time and ends at a local daylight time.
+      int32_t year = timezoneYearOfDays(utc / 86400UL);
+      int64_t transitions[6];
+      for(uint8_t i = 0; i < 3; i++) {
+        transitions[i * 2] = (int64_t)ruleDay(_dst_start, year - 1 + i) * 86400 + _dst_start.time - _std_offset;
+        transitions[i * 2 + 1] = (int64_t)ruleDay(_dst_end, year - 1 + i) * 86400 + _dst_end.time - _dst_offset;
+      }
+
+      //the transitions alternate start, end, start... in time even for the southern hemisphere, whose DST
+      //runs across new year, so the last one at or before utc tells which offset is in effect.
+      int64_t start = INT64_MIN, end = INT64_MAX;
+      int8_t last = -1;
+      for(uint8_t i = 0; i < 6; i++) {
+        if(transitions[i] <= (int64_t)utc && (last < 0 || transitions[i] >= transitions[last])) {
+          last = i;
+        }
+      }
+      for(uint8_t i = 0; i < 6; i++) {
+        if(transitions[i] > (int64_t)utc && transitions[i] < end) {
+          end = transitions[i];
+        }
+      }
+      if(last >= 0) {
+        start = transitions[last];
+      }
+      _is_dst = last >= 0 ? (last % 2 == 0) : false;
+      _offset = _is_dst ? _dst_offset : _std_offset;
+
+      //clamp the period to the range of a 32-bit epoch
+      if(start < 0) {
+        start = 0;
+      }
+      if(end > 0xFFFFFFFFLL) {
+        end = 0x100000000LL;
+      }
+      _period_start = (uint32_t)start;
+      _period_length = (uint32_t)(end - start - (end == 0x100000000LL ? 1 : 0));
+    }
+};
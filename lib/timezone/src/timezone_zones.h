@@ -0,0 +1,287 @@
+// time zone tables generated by tools/tzcompile.py from tzdata 2025b, do not edit.
+//regenerate with: python3 tools/tzcompile.py -o lib/timezone/src/timezone_zones.h America/Denver America/Phoenix America/Los_Angeles America/Chicago America/New_York America/Sao_Paulo Europe/London Europe/Berlin Asia/Kolkata Asia/Tokyo Australia/Sydney Pacific/Auckland Etc/UTC
+
+#pragma once
+
+#include <zone_timezone.h>
+
+//America/Denver: 75 transitions, then MST7MDT,M3.2.0,M11.1.0 (405 bytes)
+const char tz_america_denver_name[] PROGMEM = "America/Denver";
+const char tz_america_denver_rule[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
+const int32_t tz_america_denver_offsets[] PROGMEM = { -25200, -21600 };
+const uint32_t tz_america_denver_checkpoints[] PROGMEM = { 9968400, 126694800, 262774800, 388573200, 514976400, 638960400, 765363600, 891766800, 1018170000, 1143968400 };
+const uint16_t tz_america_denver_positions[] PROGMEM = { 0, 32, 63, 95, 127, 159, 191, 223, 255, 287 };
+const uint8_t tz_america_denver_data[] PROGMEM = {
+  0xC1, 0x9F, 0xA2, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02,
+  0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01,
+  0xC1, 0xBF, 0x62, 0xC0, 0xB0, 0x9D, 0x03, 0xC1, 0xB3, 0xA7, 0x01, 0xC0, 0xBC, 0xD8, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0x8B, 0xBB, 0x01,
+};
+
+//America/Phoenix: 0 transitions, then MST7 (25 bytes)
+const char tz_america_phoenix_name[] PROGMEM = "America/Phoenix";
+const char tz_america_phoenix_rule[] PROGMEM = "MST7";
+const int32_t tz_america_phoenix_offsets[] PROGMEM = { -25200 };
+
+//America/Los_Angeles: 75 transitions, then PST8PDT,M3.2.0,M11.1.0 (410 bytes)
+const char tz_america_los_angeles_name[] PROGMEM = "America/Los_Angeles";
+const char tz_america_los_angeles_rule[] PROGMEM = "PST8PDT,M3.2.0,M11.1.0";
+const int32_t tz_america_los_angeles_offsets[] PROGMEM = { -28800, -25200 };
+const uint32_t tz_america_los_angeles_checkpoints[] PROGMEM = { 9972000, 126698400, 262778400, 388576800, 514980000, 638964000, 765367200, 891770400, 1018173600, 1143972000 };
+const uint16_t tz_america_los_angeles_positions[] PROGMEM = { 0, 32, 63, 95, 127, 159, 191, 223, 255, 287 };
+const uint8_t tz_america_los_angeles_data[] PROGMEM = {
+  0x81, 0xA7, 0xA2, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02,
+  0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01,
+  0xC1, 0xBF, 0x62, 0xC0, 0xB0, 0x9D, 0x03, 0xC1, 0xB3, 0xA7, 0x01, 0xC0, 0xBC, 0xD8, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0x8B, 0xBB, 0x01,
+};
+
+//America/Chicago: 75 transitions, then CST6CDT,M3.2.0,M11.1.0 (406 bytes)
+const char tz_america_chicago_name[] PROGMEM = "America/Chicago";
+const char tz_america_chicago_rule[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
+const int32_t tz_america_chicago_offsets[] PROGMEM = { -21600, -18000 };
+const uint32_t tz_america_chicago_checkpoints[] PROGMEM = { 9964800, 126691200, 262771200, 388569600, 514972800, 638956800, 765360000, 891763200, 1018166400, 1143964800 };
+const uint16_t tz_america_chicago_positions[] PROGMEM = { 0, 32, 63, 95, 127, 159, 191, 223, 255, 287 };
+const uint8_t tz_america_chicago_data[] PROGMEM = {
+  0x81, 0x98, 0xA2, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02,
+  0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01,
+  0xC1, 0xBF, 0x62, 0xC0, 0xB0, 0x9D, 0x03, 0xC1, 0xB3, 0xA7, 0x01, 0xC0, 0xBC, 0xD8, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0x8B, 0xBB, 0x01,
+};
+
+//America/New_York: 75 transitions, then EST5EDT,M3.2.0,M11.1.0 (407 bytes)
+const char tz_america_new_york_name[] PROGMEM = "America/New_York";
+const char tz_america_new_york_rule[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
+const int32_t tz_america_new_york_offsets[] PROGMEM = { -18000, -14400 };
+const uint32_t tz_america_new_york_checkpoints[] PROGMEM = { 9961200, 126687600, 262767600, 388566000, 514969200, 638953200, 765356400, 891759600, 1018162800, 1143961200 };
+const uint16_t tz_america_new_york_positions[] PROGMEM = { 0, 32, 63, 95, 127, 159, 191, 223, 255, 287 };
+const uint8_t tz_america_new_york_data[] PROGMEM = {
+  0xC1, 0x90, 0xA2, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02,
+  0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01,
+  0xC1, 0xBF, 0x62, 0xC0, 0xB0, 0x9D, 0x03, 0xC1, 0xB3, 0xA7, 0x01, 0xC0, 0xBC, 0xD8, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1, 0x93, 0xF6, 0x01, 0xC0, 0xDC, 0x89, 0x02, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1,
+  0xFF, 0xFF, 0x01, 0xC0, 0xF0, 0xFF, 0x01, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1, 0xBB, 0xE2, 0x01, 0xC0, 0xB4, 0x9D, 0x02, 0xC1,
+  0xBB, 0xE2, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1,
+  0xCF, 0xD8, 0x01, 0xC0, 0xA0, 0xA7, 0x02, 0xC1, 0x8B, 0xBB, 0x01,
+};
+
+//America/Sao_Paulo: 68 transitions, then <-03>3 (359 bytes)
+const char tz_america_sao_paulo_name[] PROGMEM = "America/Sao_Paulo";
+const char tz_america_sao_paulo_rule[] PROGMEM = "<-03>3";
+const int32_t tz_america_sao_paulo_offsets[] PROGMEM = { -10800, -7200 };
+const uint32_t tz_america_sao_paulo_checkpoints[] PROGMEM = { 499748400, 624423600, 750826800, 876106800, 1003028400, 1129431600, 1255834800, 1382238000, 1508036400 };
+const uint16_t tz_america_sao_paulo_positions[] PROGMEM = { 0, 32, 64, 96, 128, 160, 192, 224, 256 };
+const uint8_t tz_america_sao_paulo_data[] PROGMEM = {
+  0xC1, 0xF6, 0xC5, 0x3F, 0xC0, 0xFC, 0xBA, 0x01, 0xC1, 0x87, 0xBB, 0x02, 0xC0, 0xB8, 0x9D, 0x01,
+  0xC1, 0xEB, 0xE3, 0x02, 0xC0, 0xCC, 0x93, 0x01, 0xC1, 0xB7, 0xE2, 0x02, 0xC0, 0xCC, 0x93, 0x01,
+  0xC1, 0xA3, 0xEC, 0x02, 0xC0, 0xA4, 0xA7, 0x01, 0xC1, 0xB7, 0xE2, 0x02, 0xC0, 0xA4, 0xA7, 0x01,
+  0xC1, 0xCB, 0xD8, 0x02, 0xC0, 0xB8, 0x9D, 0x01, 0xC1, 0xA3, 0xEC, 0x02, 0xC0, 0xE0, 0x89, 0x01,
+  0xC1, 0xA3, 0xEC, 0x02, 0xC0, 0x90, 0xB1, 0x01, 0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0x90, 0xB1, 0x01,
+  0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0xA4, 0xA7, 0x01, 0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0xFC, 0xBA, 0x01,
+  0xC1, 0xA7, 0xC6, 0x02, 0xC0, 0xA0, 0xCD, 0x01, 0xC1, 0x87, 0xBB, 0x02, 0xC0, 0xFC, 0xBA, 0x01,
+  0xC1, 0x87, 0xBB, 0x02, 0xC0, 0xD4, 0xCE, 0x01, 0xC1, 0x87, 0xBB, 0x02, 0xC0, 0xFC, 0xBA, 0x01,
+  0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0x90, 0xB1, 0x01, 0xC1, 0xA3, 0xEC, 0x02, 0xC0, 0xCC, 0x93, 0x01,
+  0xC1, 0xCB, 0xD8, 0x02, 0xC0, 0xA4, 0xA7, 0x01, 0xC1, 0x8B, 0xEF, 0x02, 0xC0, 0xD0, 0x9A, 0x01,
+  0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0x90, 0xB1, 0x01, 0xC1, 0xA3, 0xEC, 0x02, 0xC0, 0xB8, 0x9D, 0x01,
+  0xC1, 0xF3, 0xC4, 0x02, 0xC0, 0x90, 0xB1, 0x01, 0xC1, 0xCB, 0xD8, 0x02, 0xC0, 0xA4, 0xA7, 0x01,
+  0xC1, 0xCB, 0xD8, 0x02, 0xC0, 0x90, 0xB1, 0x01, 0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0x90, 0xB1, 0x01,
+  0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0xFC, 0xBA, 0x01, 0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0xA4, 0xA7, 0x01,
+  0xC1, 0xCB, 0xD8, 0x02, 0xC0, 0xA4, 0xA7, 0x01, 0xC1, 0xCB, 0xD8, 0x02, 0xC0, 0x90, 0xB1, 0x01,
+  0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0x90, 0xB1, 0x01, 0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0x90, 0xB1, 0x01,
+  0xC1, 0xDF, 0xCE, 0x02, 0xC0, 0x90, 0xB1, 0x01, 0xC1, 0xA3, 0xEC, 0x02, 0xC0, 0xCC, 0x93, 0x01,
+};
+
+//Europe/London: 50 transitions, then GMT0BST,M3.5.0/1,M10.5.0 (289 bytes)
+const char tz_europe_london_name[] PROGMEM = "Europe/London";
+const char tz_europe_london_rule[] PROGMEM = "GMT0BST,M3.5.0/1,M10.5.0";
+const int32_t tz_europe_london_offsets[] PROGMEM = { 3600, 0 };
+const uint32_t tz_europe_london_checkpoints[] PROGMEM = { 57722400, 183520800, 309924000, 435718800, 562122000, 688525200, 814323600 };
+const uint16_t tz_europe_london_positions[] PROGMEM = { 0, 32, 64, 96, 128, 160, 192 };
+const uint8_t tz_europe_london_data[] PROGMEM = {
+  0x81, 0xBF, 0xAB, 0x07, 0x80, 0xF0, 0xC4, 0x01, 0x81, 0x80, 0xBB, 0x02, 0x80, 0xF0, 0xC4, 0x01,
+  0x81, 0x80, 0xBB, 0x02, 0x80, 0xF0, 0xC4, 0x01, 0x81, 0x80, 0xBB, 0x02, 0x80, 0xF0, 0xC4, 0x01,
+  0x81, 0x80, 0xBB, 0x02, 0x80, 0xDC, 0xCE, 0x01, 0x81, 0x94, 0xB1, 0x02, 0x80, 0xDC, 0xCE, 0x01,
+  0x81, 0x94, 0xB1, 0x02, 0x80, 0xDC, 0xCE, 0x01, 0x81, 0x80, 0xBB, 0x02, 0x80, 0xF0, 0xC4, 0x01,
+  0x81, 0x80, 0xBB, 0x02, 0x80, 0xF0, 0xC4, 0x01, 0x81, 0x80, 0xBB, 0x02, 0xC0, 0xC0, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0x94, 0xB1, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0x94, 0xB1, 0x02, 0x80, 0xDC, 0xCE, 0x01, 0x81, 0x94, 0xB1, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xB4, 0xE2, 0x01,
+};
+
+//Europe/Berlin: 33 transitions, then CET-1CEST,M3.5.0,M10.5.0/3 (211 bytes)
+const char tz_europe_berlin_name[] PROGMEM = "Europe/Berlin";
+const char tz_europe_berlin_rule[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
+const int32_t tz_europe_berlin_offsets[] PROGMEM = { 3600, 7200 };
+const uint32_t tz_europe_berlin_checkpoints[] PROGMEM = { 323830800, 449024400, 575427600, 701830800, 828234000 };
+const uint16_t tz_europe_berlin_positions[] PROGMEM = { 0, 32, 64, 96, 128 };
+const uint8_t tz_europe_berlin_data[] PROGMEM = {
+  0xC1, 0xD7, 0x96, 0x29, 0x80, 0x8C, 0xF6, 0x01, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xF8, 0xFF, 0x01, 0x80, 0xE4, 0x89, 0x02, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xF8, 0xFF, 0x01, 0x80, 0xE4, 0x89, 0x02, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01, 0x81, 0xF8, 0xFF, 0x01, 0x80, 0xF8, 0xFF, 0x01,
+  0x81, 0xE4, 0x89, 0x02,
+};
+
+//Asia/Kolkata: 0 transitions, then IST-5:30 (26 bytes)
+const char tz_asia_kolkata_name[] PROGMEM = "Asia/Kolkata";
+const char tz_asia_kolkata_rule[] PROGMEM = "IST-5:30";
+const int32_t tz_asia_kolkata_offsets[] PROGMEM = { 19800 };
+
+//Asia/Tokyo: 0 transitions, then JST-9 (21 bytes)
+const char tz_asia_tokyo_name[] PROGMEM = "Asia/Tokyo";
+const char tz_asia_tokyo_rule[] PROGMEM = "JST-9";
+const int32_t tz_asia_tokyo_offsets[] PROGMEM = { 32400 };
+
+//Australia/Sydney: 74 transitions, then AEST-10AEDT,M10.1.0,M4.1.0/3 (410 bytes)
+const char tz_australia_sydney_name[] PROGMEM = "Australia/Sydney";
+const char tz_australia_sydney_rule[] PROGMEM = "AEST-10AEDT,M10.1.0,M4.1.0/3";
+const int32_t tz_australia_sydney_offsets[] PROGMEM = { 36000, 39600 };
+const uint32_t tz_australia_sydney_checkpoints[] PROGMEM = { 57686400, 183484800, 309888000, 436291200, 562089600, 688492800, 814896000, 941299200, 1067097600, 1193500800 };
+const uint16_t tz_australia_sydney_positions[] PROGMEM = { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288 };
+const uint8_t tz_australia_sydney_data[] PROGMEM = {
+  0x81, 0xF4, 0xAA, 0x07, 0x80, 0xAC, 0xA7, 0x01, 0x81, 0xC4, 0xD8, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x84, 0xBB, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0xB4, 0xE2, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0xF0, 0xC4, 0x01, 0x81, 0x94, 0xB1, 0x02, 0x80, 0xDC, 0xCE, 0x01,
+  0x81, 0x80, 0xBB, 0x02, 0x80, 0xDC, 0xCE, 0x01, 0x81, 0x80, 0xBB, 0x02, 0x80, 0xF0, 0xC4, 0x01,
+  0x81, 0x80, 0xBB, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x84, 0xBB, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0x94, 0xB1, 0x02, 0x80, 0xDC, 0xCE, 0x01, 0x81, 0xC8, 0xD8, 0x01, 0x80, 0xA8, 0xA7, 0x02,
+  0x81, 0x94, 0xB1, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01,
+  0x81, 0xA8, 0xA7, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0x94, 0xB1, 0x02, 0x80, 0xDC, 0xCE, 0x01,
+  0x81, 0x94, 0xB1, 0x02, 0x80, 0xC8, 0xD8, 0x01, 0x81, 0xA8, 0xA7, 0x02, 0x80, 0xDC, 0xCE, 0x01,
+  0x81, 0x94, 0xB1, 0x02, 0x80, 0xB4, 0xE2, 0x01,
+};
+
+//Pacific/Auckland: 67 transitions, then NZST-12NZDT,M9.5.0,M4.1.0/3 (375 bytes)
+const char tz_pacific_auckland_name[] PROGMEM = "Pacific/Auckland";
+const char tz_pacific_auckland_rule[] PROGMEM = "NZST-12NZDT,M9.5.0,M4.1.0/3";
+const int32_t tz_pacific_auckland_offsets[] PROGMEM = { 43200, 46800 };
+const uint32_t tz_pacific_auckland_checkpoints[] PROGMEM = { 152632800, 278431200, 404834400, 530632800, 655221600, 781020000, 907423200, 1033826400, 1159624800 };
+const uint16_t tz_pacific_auckland_positions[] PROGMEM = { 0, 32, 64, 96, 128, 160, 192, 224, 256 };
+const uint8_t tz_pacific_auckland_data[] PROGMEM = {
+  0x81, 0xA1, 0xB4, 0x13, 0x80, 0xC0, 0x9D, 0x01, 0x81, 0xC4, 0xD8, 0x02, 0x80, 0x84, 0xBB, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x84, 0xBB, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0xD8, 0xCE, 0x02, 0x80, 0x84, 0xBB, 0x01,
+  0x81, 0xD8, 0xCE, 0x02, 0x80, 0x98, 0xB1, 0x01, 0x81, 0x94, 0xB1, 0x02, 0x80, 0xB4, 0xE2, 0x01,
+  0x81, 0xBC, 0x9D, 0x02, 0x80, 0xB4, 0xE2, 0x01, 0x81, 0xBC, 0x9D, 0x02, 0x80, 0xB4, 0xE2, 0x01,
+  0x81, 0xBC, 0x9D, 0x02, 0x80, 0xA0, 0xEC, 0x01, 0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01,
+  0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01, 0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01,
+  0x81, 0xBC, 0x9D, 0x02, 0x80, 0xB4, 0xE2, 0x01, 0x81, 0xBC, 0x9D, 0x02, 0x80, 0xB4, 0xE2, 0x01,
+  0x81, 0xBC, 0x9D, 0x02, 0x80, 0xA0, 0xEC, 0x01, 0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01,
+  0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01, 0x81, 0xBC, 0x9D, 0x02, 0x80, 0xB4, 0xE2, 0x01,
+  0x81, 0xBC, 0x9D, 0x02, 0x80, 0xB4, 0xE2, 0x01, 0x81, 0xBC, 0x9D, 0x02, 0x80, 0xA0, 0xEC, 0x01,
+  0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01, 0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01,
+  0x81, 0xD0, 0x93, 0x02, 0x80, 0xA0, 0xEC, 0x01, 0x81, 0xD0, 0x93, 0x02,
+};
+
+//Etc/UTC: 0 transitions, then UTC0 (17 bytes)
+const char tz_etc_utc_name[] PROGMEM = "Etc/UTC";
+const char tz_etc_utc_rule[] PROGMEM = "UTC0";
+const int32_t tz_etc_utc_offsets[] PROGMEM = { 0 };
+
+const TimezoneZone timezone_zones[] PROGMEM = {
+  { tz_america_denver_name, tz_america_denver_rule, tz_america_denver_offsets, tz_america_denver_checkpoints, tz_america_denver_positions, tz_america_denver_data, 75 },
+  { tz_america_phoenix_name, tz_america_phoenix_rule, tz_america_phoenix_offsets, nullptr, nullptr, nullptr, 0 },
+  { tz_america_los_angeles_name, tz_america_los_angeles_rule, tz_america_los_angeles_offsets, tz_america_los_angeles_checkpoints, tz_america_los_angeles_positions, tz_america_los_angeles_data, 75 },
+  { tz_america_chicago_name, tz_america_chicago_rule, tz_america_chicago_offsets, tz_america_chicago_checkpoints, tz_america_chicago_positions, tz_america_chicago_data, 75 },
+  { tz_america_new_york_name, tz_america_new_york_rule, tz_america_new_york_offsets, tz_america_new_york_checkpoints, tz_america_new_york_positions, tz_america_new_york_data, 75 },
+  { tz_america_sao_paulo_name, tz_america_sao_paulo_rule, tz_america_sao_paulo_offsets, tz_america_sao_paulo_checkpoints, tz_america_sao_paulo_positions, tz_america_sao_paulo_data, 68 },
+  { tz_europe_london_name, tz_europe_london_rule, tz_europe_london_offsets, tz_europe_london_checkpoints, tz_europe_london_positions, tz_europe_london_data, 50 },
+  { tz_europe_berlin_name, tz_europe_berlin_rule, tz_europe_berlin_offsets, tz_europe_berlin_checkpoints, tz_europe_berlin_positions, tz_europe_berlin_data, 33 },
+  { tz_asia_kolkata_name, tz_asia_kolkata_rule, tz_asia_kolkata_offsets, nullptr, nullptr, nullptr, 0 },
+  { tz_asia_tokyo_name, tz_asia_tokyo_rule, tz_asia_tokyo_offsets, nullptr, nullptr, nullptr, 0 },
+  { tz_australia_sydney_name, tz_australia_sydney_rule, tz_australia_sydney_offsets, tz_australia_sydney_checkpoints, tz_australia_sydney_positions, tz_australia_sydney_data, 74 },
+  { tz_pacific_auckland_name, tz_pacific_auckland_rule, tz_pacific_auckland_offsets, tz_pacific_auckland_checkpoints, tz_pacific_auckland_positions, tz_pacific_auckland_data, 67 },
+  { tz_etc_utc_name, tz_etc_utc_rule, tz_etc_utc_offsets, nullptr, nullptr, nullptr, 0 },
+};
+
+#define TIMEZONE_NUM_ZONES 13
+
+//finds a compiled zone by its IANA name, returning nullptr if it isn't one of the zones above.
+inline const TimezoneZone *findTimezoneZone(const char *name)
+{
+  for(uint8_t i = 0; i < TIMEZONE_NUM_ZONES; i++) {
+    if(strcmp_P(name, (const char *)pgm_read_ptr(&timezone_zones[i].name)) == 0) {
+      return &timezone_zones[i];
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,151 @@
+// compiled IANA time zone lookup by kiyoshigawa
+//looks up the UTC offset in the transition tables written by tools/tzcompile.py (see timezone_zones.h), and follows
+//the zone's POSIX TZ rule after the last table entry. like PosixTimezone, the offset is cached for the period it
+//is valid for, so converting a time only costs a table search when a transition has passed.
+
+#pragma once
+
+#include <Arduino.h>
+#include <timezone.h>
+
+//a zone's transitions are stored as varints of (minutes since the previous transition << 4 | offset index).
+//every TIMEZONE_CHECKPOINT_INTERVAL'th transition also has its absolute time and data position in a checkpoint,
+//so a lookup binary searches the checkpoints and decodes at most this many entries. keep in sync with the generator.
+#define TIMEZONE_CHECKPOINT_INTERVAL 8
+
+//longest POSIX TZ rule a compiled zone can carry, with the terminating null.
+#define TIMEZONE_MAX_RULE_LENGTH 48
+
+//one compiled zone, all pointers are to PROGMEM.
+struct TimezoneZone {
+  const char *name;             //IANA name, e.g. "America/Denver"
+  const char *rule;             //POSIX TZ rule in effect from the last transition on
+  const int32_t *offsets;       //UTC offsets in seconds, the first one is in effect before the first transition
+  const uint32_t *checkpoints;  //time of every TIMEZONE_CHECKPOINT_INTERVAL'th transition
+  const uint16_t *positions;    //position in data of every checkpoint's transition
+  const uint8_t *data;          //the transitions, from 1970 on
+  uint16_t transitions;
+};
+
+class ZoneTimezone {
+  public:
+    //sets the zone to look up, usually from findTimezoneZone(). returns false and uses UTC if zone is nullptr.
+    bool begin(const TimezoneZone *zone)
+    {
+      _period_start = 0;
+      _period_length = 0;
+      if(!zone) {
+        memset(&_zone, 0, sizeof(_zone));
+        _rule.begin("UTC0");
+        return false;
+      }
+      //the zone list itself lives in PROGMEM, keep a copy of the entry so lookups can use its pointers directly
+      memcpy_P(&_zone, zone, sizeof(_zone));
+      char rule[TIMEZONE_MAX_RULE_LENGTH];
+      strncpy_P(rule, _zone.rule, sizeof(rule));
+      rule[sizeof(rule) - 1] = '\0';
+      return _rule.begin(rule);
+    }
+
+    //the offset from UTC in seconds at the UTC time utc.
+    int32_t offsetAt(uint32_t utc)
+    {
+      //unsigned wrap-around makes this one compare cover both ends of the period
+      if(utc - _period_start >= _period_length) {
+        findPeriod(utc);
+      }
+      return _offset;
+    }
+
+    //the local time at the UTC time utc.
+    uint32_t toLocal(uint32_t utc)
+    {
+      return utc + offsetAt(utc);
+    }
+
+    //the UTC time the offset found by the last call changes, or 0xFFFFFFFF if it never does.
+    uint32_t nextTransition()
+    {
+      return _period_start + _period_length;
+    }
+
+    //the offsets of the zone's current rule, e.g. for a manual DST override.
+    int32_t standardOffset() { return _rule.standardOffset(); }
+    int32_t dstOffset() { return _rule.dstOffset(); }
+
+  private:
+    TimezoneZone _zone = {};
+    PosixTimezone _rule;
+
+    //the cached period, [_period_start, _period_start + _period_length), and the offset in effect during it.
+    uint32_t _period_start = 0;
+    uint32_t _period_length = 0;
+    int32_t _offset = 0;
+
+    //reads one varint transition entry at p and moves p past it.
+    static uint32_t readEntry(const uint8_t *&p)
+    {
+      uint32_t value = 0;
+      uint8_t shift = 0;
+      uint8_t byte;
+      do {
+        byte = pgm_read_byte(p++);
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+      } while(byte & 0x80);
+      return value;
+    }
+
+    void setPeriod(uint32_t start, uint32_t end, int32_t offset)
+    {
+      _period_start = start;
+      _period_length = end - start;
+      _offset = offset;
+    }
+
+    void findPeriod(uint32_t utc)
+    {
+      uint16_t count = _zone.transitions;
+      uint32_t first = count ? pgm_read_dword(&_zone.checkpoints[0]) : 0;
+      if(count && utc < first) {
+        setPeriod(0, first, (int32_t)pgm_read_dword(&_zone.offsets[0]));
+        return;
+      }
+
+      uint32_t time = 0;
+      if(count) {
+        //find the last checkpoint at or before utc
+        uint16_t low = 0;
+        uint16_t high = (count - 1) / TIMEZONE_CHECKPOINT_INTERVAL;
+        while(low < high) {
+          uint16_t mid = (low + high + 1) / 2;
+          if(pgm_read_dword(&_zone.checkpoints[mid]) <= utc) {
+            low = mid;
+          } else {
+            high = mid - 1;
+          }
+        }
+
+        //then decode the transitions after it, until the next one is past utc
+        uint16_t index = low * TIMEZONE_CHECKPOINT_INTERVAL;
+        const uint8_t *p = _zone.data + pgm_read_word(&_zone.positions[low]);
+        time = pgm_read_dword(&_zone.checkpoints[low]);
+        uint8_t offset_index = readEntry(p) & 0x0F;
+        for(index++; index < count; index++) {
+          uint32_t entry = readEntry(p);
+          uint32_t next = time + (entry >> 4) * 60;
+          if(next > utc) {
+            setPeriod(time, next, (int32_t)pgm_read_dword(&_zone.offsets[offset_index]));
+            return;
+          }
+          time = next;
+          offset_index = entry & 0x0F;
+        }
+      }
+
+      //past the last transition the zone's rule takes over, which starts no earlier than that transition
+      int32_t offset = _rule.offsetAt(utc);
+      uint32_t start = _rule.previousTransition();
+      setPeriod(start > time ? start : time, _rule.nextTransition(), offset);
+    }
+};
@@ -0,0 +1,100 @@
+/*
+This draws the time string on the display. After the first draw it keeps the string and its layout, so the next
+second only the glyphs from the first changed character on are laid out again, and only their columns are cleared,
+redrawn and marked for refreshDirty(). Most seconds that is just the last digit. Everything else that draws on the
+display has to call invalidate().
+That saves drawing and running the rotation kernel for the chips that did not change, not bus traffic: refreshAll()
+already sends only the rows that changed, so a second costs the same bytes either way.
+*/
+
+#pragma once
+
+#include <string.h>
+#include <fonts.h>
+#include <text_layout.h>
+
+//Reversed draws the text from the last column back in the flipped fonts, like DISPLAY_TEXT_REVERSED does for
+//render_text_to_buffer().
+template <class Display, bool Reversed>
+class ClockFace {
+  public:
+    ClockFace(Display &display) : _display(display) {}
+
+    //the next draw() clears the display and draws the whole string.
+    void invalidate() { _valid = false; }
+
+    //draws string at align in the display's columns.
+    void draw(const char *string, TextAlign align)
+    {
+      if(!_valid) {
+        _layout.layout(font_upright, string);
+        _x = _layout.alignedX(align, 0, Display::num_columns);
+        _display.clr();
+        _layout.render(face(), _display, _x, Reversed);
+        _display.markDirty(0, Display::num_columns);
+        remember(string);
+        _valid = true;
+        return;
+      }
+      uint8_t changed = 0;
+      while(changed < TEXT_LAYOUT_MAX_GLYPHS && string[changed] != '\0' && string[changed] == _string[changed]) {
+        changed++;
+      }
+      if(string[changed] == _string[changed]) {
+        return;
+      }
+      //the glyphs before the first changed character keep their place unless the alignment moves the whole string
+      uint8_t first_glyph = _layout.firstGlyphFrom(changed);
+      int16_t old_first = _x + (first_glyph < _layout.count() ? _layout.glyphX(first_glyph) : _layout.width());
+      int16_t old_last = _x + _layout.width();
+      _layout.relayout(font_upright, string, changed);
+      int16_t x = _layout.alignedX(align, 0, Display::num_columns);
+      if(x != _x) {
+        _x = x;
+        redraw(0, Display::num_columns);
+      } else {
+        int16_t new_first = x + (first_glyph < _layout.count() ? _layout.glyphX(first_glyph) : _layout.width());
+        int16_t new_last = x + _layout.width();
+        redraw(old_first < new_first ? old_first : new_first, old_last > new_last ? old_last : new_last);
+      }
+      remember(string);
+    }
+
+  private:
+    Display &_display;
+    TextLayout _layout;
+    char _string[TEXT_LAYOUT_MAX_GLYPHS + 1];
+    int16_t _x = 0;
+    bool _valid = false;
+
+    static const FontDescriptor &face() { return Reversed ? font_flipped : font_upright; }
+
+    void remember(const char *string)
+    {
+      strncpy(_string, string, TEXT_LAYOUT_MAX_GLYPHS);
+      _string[TEXT_LAYOUT_MAX_GLYPHS] = '\0';
+    }
+
+    //clears the columns from first up to last (not included) and draws the part of the layout that falls into them.
+    void redraw(int16_t first, int16_t last)
+    {
+      if(first < 0) {
+        first = 0;
+      }
+      if(last > Display::num_columns) {
+        last = Display::num_columns;
+      }
+      if(first >= last) {
+        return;
+      }
+      for(int16_t column = first; column < last; column++) {
+        _display.column(Reversed ? Display::num_columns - 1 - column : column) = 0;
+      }
+      _layout.render(face(), _display, _x, Reversed, first, last);
+      if(Reversed) {
+        _display.markDirty(Display::num_columns - last, Display::num_columns - first);
+      } else {
+        _display.markDirty(first, last);
+      }
+    }
+};
@@ -0,0 +1,140 @@
+/*
+These are the clock's settings, stored in flash as one value of the settings log (see lib/settings_log).
+To add a setting, append a member to ClockSettings and a line to clock_settings_fields with the next version in
+"since", then bump CLOCK_SETTINGS_VERSION. Units running an older version keep their settings and get the default
+for the new one. Never change or reorder the existing members, the static_asserts below catch that.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <type_traits>
+#include <EEPROM.h>
+#include <settings_schema.h>
+#include <timezone_zones.h>
+
+//these are named variables to make the intent of the code more readable.
+#define _12H_MODE true
+#define _24H_MODE false
+
+//default brightness - can be from 0x0 to 0xF
+#define DEFAULT_BRIGHTNESS 0x4U
+
+//default display mode for time - seconds on or off
+#define DEFAULT_DISPLAY_MODE false
+
+//this controls whether or not the clock displays time in 12H or 24H mode
+#define DEFAULT_12H_24H_MODE _12H_MODE
+
+//this is the local time zone as an IANA name. It has to be one of the zones compiled into lib/timezone/src/timezone_zones.h,
+//add others with tools/tzcompile.py. The clock follows DST and past changes of the zone's rules on its own.
+#define TIMEZONE_NAME "America/Denver"
+
+//this is added to the zone's UTC offset in seconds, to run the clock ahead or behind the zone. (60 s/min * 60min/hour * (+/-)Offset in Hours)
+#define DEFAULT_TIME_CORRECTION 0L
+
+//this is the version of the settings layout below.
+#define CLOCK_SETTINGS_VERSION 2
+
+//this is the key the settings are stored under in the settings log.
+#define CLOCK_SETTINGS_KEY 0x10
+
+//this is where version 0 firmware kept the settings in the emulated EEPROM, one value every 4 bytes, of which only the
+//3 lowest were written, Least Significant Byte first. The init value is 1 once the defaults have been written.
+#define LEGACY_EEPROM_BYTE_OFFSET 4U
+#define LEGACY_EEPROM_NUM_BYTES (LEGACY_EEPROM_BYTE_OFFSET * (4U + 1U))
+#define LEGACY_EEPROM_INIT_ADDRESS         (0x00*LEGACY_EEPROM_BYTE_OFFSET)
+#define LEGACY_EEPROM_BRIGHTNESS_ADDRESS   (0x01*LEGACY_EEPROM_BYTE_OFFSET)
+#define LEGACY_EEPROM_DISPLAY_MODE_ADDRESS (0x02*LEGACY_EEPROM_BYTE_OFFSET)
+#define LEGACY_EEPROM_12H_24H_ADDRESS      (0x03*LEGACY_EEPROM_BYTE_OFFSET)
+#define LEGACY_EEPROM_TIME_OFFSET_ADDRESS  (0x04*LEGACY_EEPROM_BYTE_OFFSET)
+#define LEGACY_EEPROM_HAS_BEEN_INITIALIZED 1
+
+struct __attribute__((packed)) ClockSettings {
+  uint8_t version;
+  uint8_t brightness;             //0-15
+  uint8_t display_mode;           //seconds on or off
+  uint8_t display_time_in_24_h;   //see _12H_MODE and _24H_MODE
+  int32_t time_correction;        //in seconds, added to the UTC offset of TIMEZONE_NAME. Version 1 kept the UTC offset here
+};
+
+#define CLOCK_SETTINGS_FIELD(member, min_value, max_value, default_value, since_version) \
+  {offsetof(ClockSettings, member), sizeof(ClockSettings::member), std::is_signed<decltype(ClockSettings::member)>::value, \
+   since_version, min_value, max_value, default_value}
+
+constexpr SettingsField clock_settings_fields[] = {
+  //                   name                  min                max               default               since
+  CLOCK_SETTINGS_FIELD(brightness,           0,                 15,               DEFAULT_BRIGHTNESS,   1),
+  CLOCK_SETTINGS_FIELD(display_mode,         0,                 1,                DEFAULT_DISPLAY_MODE, 1),
+  CLOCK_SETTINGS_FIELD(display_time_in_24_h, 0,                 1,                DEFAULT_12H_24H_MODE, 1),
+  CLOCK_SETTINGS_FIELD(time_correction,      -26L * 60L * 60L,  26L * 60L * 60L,  DEFAULT_TIME_CORRECTION, 1),
+};
+
+#define CLOCK_SETTINGS_NUM_FIELDS (sizeof(clock_settings_fields) / sizeof(clock_settings_fields[0]))
+
+static_assert(settingsLayoutIsAppendOnly(clock_settings_fields), "ClockSettings fields must be packed in order, with the newest last.");
+static_assert(sizeof(ClockSettings) == settingsLayoutSize(clock_settings_fields), "Every ClockSettings member needs a clock_settings_fields line.");
+static_assert(sizeof(ClockSettings) <= SETTINGS_LOG_MAX_VALUE_SIZE, "ClockSettings is too large for one settings log value.");
+
+//the layout of every released version, so changing one fails to compile. add a line when bumping the version.
+static_assert(settingsLayoutCrc(clock_settings_fields, 1) == 0xEF9F960EUL, "The version 1 ClockSettings layout changed.");
+static_assert(settingsLayoutCrc(clock_settings_fields, 2) == 0xEF9F960EUL, "The version 2 ClockSettings layout changed.");
+
+//versions 0 and 1 kept the standard UTC offset and added an hour when the DST switch was on. The zone has the offsets
+//now, so an old offset is kept as its difference to the zone's, which is 0 unless the clock was set to another zone.
+inline int32_t clockTimeCorrectionFromOffset(int32_t time_offset)
+{
+  ZoneTimezone zone;
+  zone.begin(findTimezoneZone(TIMEZONE_NAME));
+  return time_offset - zone.standardOffset();
+}
+
+//reads one 24-bit value the way version 0 firmware wrote it.
+inline uint32_t readLegacyEepromValue(unsigned int address)
+{
+  uint32_t value = 0;
+  for(int i=0; i<3; i++){
+    value = value | ((uint32_t)EEPROM.read(address+i) << i*8);
+  }
+  return value;
+}
+
+//version 0 firmware kept the settings in the EEPROM, this copies them into the struct. The EEPROM sector is only read,
+//so the values are still there if the log lives somewhere else, and an unused or erased EEPROM leaves the defaults.
+template <class Log>
+void migrateClockSettingsFromV0(Log &, ClockSettings &values)
+{
+  EEPROM.begin(LEGACY_EEPROM_NUM_BYTES);
+  if(EEPROM.read(LEGACY_EEPROM_INIT_ADDRESS) == LEGACY_EEPROM_HAS_BEEN_INITIALIZED){
+    values.brightness = readLegacyEepromValue(LEGACY_EEPROM_BRIGHTNESS_ADDRESS);
+    values.display_mode = readLegacyEepromValue(LEGACY_EEPROM_DISPLAY_MODE_ADDRESS);
+    values.display_time_in_24_h = readLegacyEepromValue(LEGACY_EEPROM_12H_24H_ADDRESS);
+    //the offset lost its top byte, so sign extend it from 24 bits
+    uint32_t time_offset = readLegacyEepromValue(LEGACY_EEPROM_TIME_OFFSET_ADDRESS);
+    values.time_correction = clockTimeCorrectionFromOffset((int32_t)(time_offset << 8) >> 8);
+  }
+  EEPROM.end();
+}
+
+//version 1 stored the UTC offset where the correction is now. This also runs for version 0, whose migration above
+//already stored a correction, but the version is only 1 if version 1 settings were loaded.
+template <class Log>
+void migrateClockSettingsFromV1(Log &, ClockSettings &values)
+{
+  if(values.version == 1){
+    values.time_correction = clockTimeCorrectionFromOffset(values.time_correction);
+  }
+}
+
+template <class Log>
+struct ClockSettingsSchema {
+  static constexpr SettingsMigration<Log, ClockSettings> migrations[] = {
+    {0, migrateClockSettingsFromV0<Log>},
+    {1, migrateClockSettingsFromV1<Log>},
+  };
+
+  static constexpr SettingsSchema<Log, ClockSettings> schema = {
+    CLOCK_SETTINGS_KEY, CLOCK_SETTINGS_VERSION, clock_settings_fields, CLOCK_SETTINGS_NUM_FIELDS,
+    migrations, sizeof(migrations) / sizeof(migrations[0]),
+  };
+};
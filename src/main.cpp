@@ -5,7 +5,7 @@ It will then continuously try to connect to the NTP server to keep the time corr
 while running on its own clock crystal between connections to the NTP server.
 
 There is also code that allows for settings to be cahnged by pressing a config button, followed by up/down adjustment buttons.
-ALl settings will be saved in persistant FLASH memory using the EEPROM.h library for ESP8266
+ALl settings will be saved in persistant FLASH memory in a log of records, see lib/settings_log
 The following items can be set via this method:
   Brightness: 0-15 value, controls the brightness of all LEDs on the display.
   GMT Offset: from -12 to +14 hours per GMT specs. This will snap to any valid GMT offset per the GMT_OFFSETS enum
@@ -19,77 +19,126 @@ The following items can be set via this method:
 #include <esp8266_pins.h>
 #include <ESP8266WiFi.h>
 #include <WiFiUdp.h>
-#include <EEPROM.h>
+#include <settings_log.h>
+#include <settings_flash.h>
+#include <settings_cache.h>
 #include <max7219.h>
 #include <fonts.h>
+#include <text_layout.h>
+#include <timezone_zones.h>
 #include <pgmspace.h>
+#include <lwip/dns.h>
 #include "wifi_creds.h"
-
-//these are named variables to make the intent of the code more readable.
-#define _12H_MODE true
-#define _24H_MODE false
-#define EEPROM_HAS_BEEN_INITIALIZED 1
+#include "clock_settings.h"
+#include "clock_face.h"
 
 //this is the offset from 0 for the ascii numerals - allows easy conversion of numbers into ascii characters:
 #define ASCII_NUMERAL_0_OFFSET 48
 
-//default brightness - can be from 0x0 to 0xF
-#define DEFAULT_BRIGHTNESS 0x4U
-
-//default display mode for time - seconds on or off
-#define DEFAULT_DISPLAY_MODE false
-
-//this controls whether or not the clock displays time in 12H or 24H mode
-#define DEFAULT_12H_24H_MODE _12H_MODE
+//the local time zone, TIMEZONE_NAME, is set in clock_settings.h along with the other defaults.
 
-//Change this to adjust the default time zone on power up in seconds - Adjust as needed. (60 s/min * 60min/hour * (+/-)Offset in Hours)
-#define DEFAULT_TIME_OFFSET (60L * 60L * -7L)
+//uncomment this to let the DST switch pick standard or daylight time instead of the zone's DST dates:
+//#define DST_SWITCH_OVERRIDE
 
-//this is how often the NTP client object will check for updates in milliseconds. (1000ms/s * 60s/min * 5 min)
-#define DEFAULT_NTP_SERVER_CHECK_INTERVAL (1000UL * 60UL * 5UL)
+//this is the shortest time between NTP checks in milliseconds. (1000ms/s * 64s)
+//the client measures and corrects the drift of the clock crystal between checks, and doubles the interval each
+//time the clock proves stable, up to NTP_MAX_POLL_EXPONENT doublings. (64s * 2^6 = about 68 min)
+#define DEFAULT_NTP_SERVER_CHECK_INTERVAL (1000UL * 64UL)
+#define NTP_MAX_POLL_EXPONENT 6
 
 //this timeout is for initial connections to the wifi. It will only try for this many ms.
 #define WIFI_TIMEOUT 10000UL
 
+//this is how often the connection status is checked while connecting to the wifi in ms.
+//a short interval lets the first NTP request go out as soon as the connection is up.
+#define WIFI_CONNECT_POLL_INTERVAL 20UL
+
 //this is how often the wifi will try to reconnect if it becomes disconnected in ms. (1000ms/s * 60s/min * 5 min)
 #define WIFI_RECONNECT_CHECK_INTERVAL (1000UL * 60UL * 5UL)
 
 //this is how long to wait for the NTP server to send back a valid time before giving up in ms (1000ms/s * 2s)
 #define NTP_CONNECTION_TIMEOUT (1000UL * 2UL)
 
+//this is the longest round-trip delay in ms an NTP reply can have and still be trusted to set the clock.
+//the time from a reply can be off by up to half of its round-trip delay.
+#define NTP_MAX_ROUND_TRIP_DELAY 500UL
+
+//these are the NTP servers sampled on each update. The time is only set from servers that agree with the majority,
+//so one bad server can't pull the clock off. The numbered pool names each resolve to a different set of servers.
+const char *ntp_servers[] = {"0.pool.ntp.org", "1.pool.ntp.org", "2.pool.ntp.org", "3.pool.ntp.org"};
+
+//this is how long to wait for a DNS lookup of an NTP server name before giving up in ms.
+//the lookup runs in the background while loop() keeps going, so this doesn't hold up the display. The client caches
+//the addresses it looks up, keeps using them while DNS is unreachable and waits NTP_DNS_NEGATIVE_TTL after a failed
+//lookup before trying the name again.
+#define NTP_DNS_TIMEOUT 5000UL
+
+//define this (or add -D BENCHMARK_DISPLAY_REFRESH to build_flags) to print the average display frame time on boot:
+//#define BENCHMARK_DISPLAY_REFRESH
+
+//this is how many frames the display refresh benchmark will time and average.
+#define BENCHMARK_FRAMES 100U
+
 //this is how many characters a string can be at most. Trying to display strings longer than this will result in truncation:
 #define MAX_STRING_BUFFER_LENGTH 128
 
-//this is the offset between EEPROM data values in bytes:
-//set to 4U so you get 4*8 = 32 bit values for each address location
-#define EEPROM_BYTE_OFFSET 4U
+//this is how many flash sectors the settings log rotates through. They are taken from the end of the filesystem
+//area, which this firmware doesn't use. If the flash layout's filesystem area is too small the settings aren't saved
+//at all, pick a board layout with a filesystem area of at least this many sectors.
+#define SETTINGS_FLASH_SECTORS 2
+
+//these are the pin numbers for the display. With the HSPI transport CLK must be D5 and DIN must be D7.
+#define DISPLAY_CLK_PIN D5
+#define DISPLAY_CS_PIN D6
+#define DISPLAY_DIN_PIN D7
 
-//this is how many bytes of EEPROM are reserved for storing settings data 
-//the total is: (Number of bytes per item stored * (number of items being stored + 1U for the init address)):
-//the init address will be 0 of the EEPROM has not been initialized, and any other value in the LSB if it has been.
-#define NUM_EEPROM_BYTES (EEPROM_BYTE_OFFSET * (4U + 1U))
+//this is how many MAX7219 chips are chained together in the display.
+#define DISPLAY_NUM_CHIPS 4
 
-//these are the pin numbers for the DST switch. One is used as a GND pin, since the PCB didn't have enough
+//this is how far the display modules are rotated, can be 0, 90, 180 or 270.
+#define DISPLAY_ROTATION 90
+
+//set this to true if text has to be drawn from the last column of the chain back, with each glyph column upside down.
+//That is how the chain is wired on the clock PCB. It is separate from DISPLAY_ROTATION, which only turns each module.
+#define DISPLAY_TEXT_REVERSED true
+
+//these are the pin numbers for the DST switch, only used with DST_SWITCH_OVERRIDE. One is used as a GND pin, since the PCB didn't have enough
 //the second pin is an input making use of the internal pullup resistor to check the state of the DST switch.
 #define DST_SWITCH_GND_PIN D3
 #define DST_SWITCH_PIN D4
 
-//these are the EEPROM addressed where things are stored:
-//the EEPROM data is bropken into 32-bit values, Least Significant Bytes first.
-#define EEPROM_INIT_ADDRESS         (0x00*EEPROM_BYTE_OFFSET)
-#define EEPROM_BRIGHTNESS_ADDRESS   (0x01*EEPROM_BYTE_OFFSET)
-#define EEPROM_DISPLAY_MODE_ADDRESS (0x02*EEPROM_BYTE_OFFSET)
-#define EEPROM_12H_24H_ADDRESS      (0x03*EEPROM_BYTE_OFFSET)
-#define EEPROM_TIME_OFFSET_ADDRESS  (0x04*EEPROM_BYTE_OFFSET)
+//set this to true to force a settings reset:
+bool FORCE_SETTINGS_INIT = false;
+
+//this is the settings log, kept in the flash sectors picked by SettingsEspFlash::fromLayout():
+typedef SettingsLog<SettingsEspFlash> ClockSettingsLog;
+ClockSettingsLog settings_log(SettingsEspFlash::fromLayout(SETTINGS_FLASH_SECTORS));
+static_assert(SETTINGS_FLASH_SECTORS >= SETTINGS_LOG_MIN_SECTORS, "The settings log needs at least 2 flash sectors.");
 
-//set this to true to force an EEPROM reset:
-bool FORCE_EEPROM_INIT = false;
+//this holds the current settings in RAM, see clock_settings.h. Changes are written to the settings log a few seconds after the last one.
+SettingsCache<ClockSettingsLog, ClockSettings> settings(settings_log, ClockSettingsSchema<ClockSettingsLog>::schema);
 
 //this is the NTP client's UDP object.
 WiFiUDP ntpUDP;
 
+//this is the display object, using the bus transport selected by MAX7219_TRANSPORT:
+#if MAX7219_TRANSPORT == MAX7219_TRANSPORT_HSPI
+typedef Max7219Display<DISPLAY_NUM_CHIPS, DISPLAY_ROTATION, Max7219HspiTransport> ClockDisplay;
+ClockDisplay display{Max7219HspiTransport(DISPLAY_CS_PIN)};
+#else
+typedef Max7219Display<DISPLAY_NUM_CHIPS, DISPLAY_ROTATION, Max7219BitBangTransport> ClockDisplay;
+ClockDisplay display{Max7219BitBangTransport(DISPLAY_CLK_PIN, DISPLAY_CS_PIN, DISPLAY_DIN_PIN)};
+#endif
+
+//this draws the time, redrawing only the digits that changed since the last second.
+ClockFace<ClockDisplay, DISPLAY_TEXT_REVERSED> clock_face(display);
+
 //this si the NTP client object:
-NTPClient timeClient(ntpUDP, "pool.ntp.org", DEFAULT_TIME_OFFSET, DEFAULT_NTP_SERVER_CHECK_INTERVAL);
+//the client keeps UTC, local_timezone converts it to local time for the display.
+NTPClient timeClient(ntpUDP, ntp_servers[0], 0, DEFAULT_NTP_SERVER_CHECK_INTERVAL);
+
+//this is the time zone object, it caches the current UTC offset until the next DST transition:
+ZoneTimezone local_timezone;
 
 //this tracks the last wifi connection time for reconnect attempts:
 uint32_t last_wifi_connection_attempt = 0;
@@ -98,20 +147,8 @@ uint32_t last_wifi_connection_attempt = 0;
 //Until this is true, the clock will not display any time, only the INIT_MESSAGE
 bool valid_NTP_time_received = false;
 
-//this will keep track of the last value for seconds returned from the loop, so the display will only be updated once per second
-uint8_t last_seconds = 0;
-
-//this tracks the display mode. True means 24H time display, false is 12h time display
-uint32_t display_time_in_24_h = DEFAULT_12H_24H_MODE;
-
-//this tracks whether or not to display seconds on the clock display mode.
-uint32_t display_mode = DEFAULT_DISPLAY_MODE;
-
-//this stores the current brightness setting.
-uint32_t display_brightness = DEFAULT_BRIGHTNESS;
-
-//this stores the current UTC offset in seconds:
-uint32_t current_time_offset = DEFAULT_TIME_OFFSET;
+//this is the millis() time when the next second starts, so the display will only be redrawn once per second, right as the second changes
+uint32_t next_redraw_time = 0;
 
 //this is a string buffer that stores the current time for use in printing time strings to the display:
 char print_string_buffer[MAX_STRING_BUFFER_LENGTH];
@@ -119,65 +156,47 @@ char print_string_buffer[MAX_STRING_BUFFER_LENGTH];
 //this is how many characters are currently being used in the string buffer:
 uint8_t current_num_chars_in_buffer = 0;
 
-//this will be updated by the DST switch. If DST is active, the hours counter will be incremented by 1
-bool DST_is_active = false;
+//this is the NTP server name resolve_NTP_server() is waiting on DNS for, or nullptr if there is no lookup running:
+const char *dns_lookup_name = nullptr;
 
-//this will write all 4 bytes of EEPROM memory with a 32-bit integer value
-void write_32_bit_EEPROM_value(unsigned int address, uint32_t value)
-{
-  for(int i=0; i<3; i++){
-    //get the current LSB
-    uint8_t lsb = (uint8_t)value & 0x000000FF;
-    Serial.println(lsb);
-    //write the current LSB to the appropriate address
-    EEPROM.write(address+i, lsb);
-    //shift the value over 8 bits to make the next iteration use the byte above the previous lsb
-    value = value >> 8;
-    EEPROM.commit();
-  }
-}
+//this is the millis() time the running lookup was started:
+uint32_t dns_lookup_started = 0;
 
-//this reads a 32-bit value from the EEPROM, starting at address as the Least signifigant byte, and moving throught he next three bytes after that.
-uint32_t read_32_bit_EEPROM_value(unsigned int address)
-{
-  uint32_t combined_value = 0;
-  for(int i=0; i<3; i++){
-    //shift the value over by the byte number so it lands in the right place
-    combined_value = combined_value & (EEPROM.read(address+i) << i*8);
-  }
-  return combined_value;
-}
+//this numbers the lookups, so an answer that comes in after its lookup was given up on can be told apart:
+uint32_t dns_lookup_id = 0;
 
-//this will initialize the EEPROM data to the default values, which can then be updated by the code or changed later.
-void init_EEPROM(void)
-{
-  //write the init bit so that the MCU will know the EEPROM has valid initial values:
-  write_32_bit_EEPROM_value(EEPROM_INIT_ADDRESS, 0x01U);
-  //write the default values for the various settings options to their EEPROM addresses:
-  write_32_bit_EEPROM_value(EEPROM_BRIGHTNESS_ADDRESS, DEFAULT_BRIGHTNESS);
-  write_32_bit_EEPROM_value(EEPROM_DISPLAY_MODE_ADDRESS, DEFAULT_DISPLAY_MODE);
-  write_32_bit_EEPROM_value(EEPROM_12H_24H_ADDRESS, DEFAULT_12H_24H_MODE);
-  write_32_bit_EEPROM_value(EEPROM_TIME_OFFSET_ADDRESS, DEFAULT_TIME_OFFSET);
-  //print a debug serial message to let everyone know you reset the EEPROM:
-  Serial.println("EEPROM Reset to default values.");
-}
+//these are set by NTP_server_found() when the answer to the running lookup comes in, the address is unset if it failed:
+volatile bool dns_lookup_done = false;
+IPAddress dns_lookup_address;
 
-void restore_from_EEPROM(void)
+//this loads the settings from flash once at boot, after this they are only read from RAM.
+void load_settings(void)
 {
-  //this will set the current values to the values currently stored in EEPROM.
-  Serial.println("Reading values from EEPROM:");
-  display_brightness = read_32_bit_EEPROM_value(EEPROM_BRIGHTNESS_ADDRESS);
-  display_mode = read_32_bit_EEPROM_value(EEPROM_DISPLAY_MODE_ADDRESS);
-  display_time_in_24_h = read_32_bit_EEPROM_value(EEPROM_12H_24H_ADDRESS);
-  current_time_offset = read_32_bit_EEPROM_value(EEPROM_TIME_OFFSET_ADDRESS);
+  if(FORCE_SETTINGS_INIT){
+    settings_log.clear();
+  }
+  uint8_t version = settings.begin();
+  if(FORCE_SETTINGS_INIT){
+    //don't keep what the migration found in the old EEPROM settings either
+    settings.reset();
+  }
+  if(!settings_log.writable()){
+    Serial.println("The flash layout has no room for the settings log, settings changes won't be saved.");
+  }
+  if(version == 0){
+    Serial.println("No settings in the settings log, using the old EEPROM settings if there are any, or the defaults.");
+  } else {
+    Serial.printf("Read version %u settings from flash:\n", version);
+  }
+  const ClockSettings &values = settings.get();
   Serial.print("Brightness set to: ");
-  Serial.println(display_brightness);
+  Serial.println(values.brightness);
   Serial.print("DIsplay Mode set to: ");
-  Serial.println(display_mode);
+  Serial.println(values.display_mode);
   Serial.print("24 Hour mode set to: ");
-  Serial.println(display_time_in_24_h);
-  Serial.print("Current time offset from GMT in seconds set to: ");
-  Serial.println(current_time_offset);
+  Serial.println(values.display_time_in_24_h);
+  Serial.print("Time correction on top of " TIMEZONE_NAME " in seconds set to: ");
+  Serial.println(values.time_correction);
 }
 
 bool connect_to_wifi(void)
@@ -188,9 +207,13 @@ bool connect_to_wifi(void)
   WiFi.begin(WIFI_NAME, WIFI_PASS);
 
   Serial.print("Connecting");
+  uint32_t last_dot_time = millis();
   while (WiFi.status() != WL_CONNECTED){
-    delay(500);
-    Serial.print(".");
+    delay(WIFI_CONNECT_POLL_INTERVAL);
+    if(millis() - last_dot_time >= 500){
+      last_dot_time = millis();
+      Serial.print(".");
+    }
     if(millis() >= wifi_connection_timeout + WIFI_TIMEOUT){
       Serial.println();
       Serial.println("Unable to connect.");
@@ -204,24 +227,93 @@ bool connect_to_wifi(void)
   return true;
 }
 
-//this will force an update of the ntp time
-bool update_NTP_time()
+//this is called by lwIP with the answer to a lookup started in resolve_NTP_server(), ip_address is NULL if it failed.
+void NTP_server_found(const char *, const ip_addr_t *ip_address, void *lookup_id)
 {
-  uint32_t ntp_connection_start_time = millis();
-  while(!timeClient.update()) {
-    timeClient.forceUpdate();
-    if(millis() >= NTP_CONNECTION_TIMEOUT + ntp_connection_start_time){
-      Serial.println("Unable to connect to NTP server, will try again later.");
-      return false;
+  if((uint32_t)(uintptr_t)lookup_id != dns_lookup_id) {
+    return;
+  }
+  dns_lookup_address = ip_address ? IPAddress(ip_address) : IPAddress();
+  dns_lookup_done = true;
+}
+
+//this looks up NTP server names for timeClient, which caches the results. It never waits for the DNS server: the
+//first call for a name starts the lookup, and timeClient asks again on each update() until the answer is in.
+NTPResolveResult resolve_NTP_server(const char *server_name, IPAddress &address)
+{
+  if(dns_lookup_name != server_name) {
+    //lwIP answers right away if it has the name cached or it is an IP address already
+    ip_addr_t ip_address;
+    dns_lookup_id++;
+    dns_lookup_done = false;
+    err_t result = dns_gethostbyname(server_name, &ip_address, NTP_server_found, (void *)(uintptr_t)dns_lookup_id);
+    if(result == ERR_INPROGRESS) {
+      dns_lookup_name = server_name;
+      dns_lookup_started = millis();
+      return NTP_RESOLVE_PENDING;
+    }
+    if(result != ERR_OK) {
+      return NTP_RESOLVE_FAILED;
     }
+    address = IPAddress(&ip_address);
+    return NTP_RESOLVE_DONE;
   }
+  if(!dns_lookup_done) {
+    if(millis() - dns_lookup_started < NTP_DNS_TIMEOUT) {
+      return NTP_RESOLVE_PENDING;
+    }
+    //give up on it, the next lookup gets a new id so a late answer to this one is ignored
+    dns_lookup_name = nullptr;
+    return NTP_RESOLVE_FAILED;
+  }
+  dns_lookup_name = nullptr;
+  if(!dns_lookup_address.isSet()) {
+    return NTP_RESOLVE_FAILED;
+  }
+  address = dns_lookup_address;
+  return NTP_RESOLVE_DONE;
+}
+
+//this will start an update of the ntp time. It returns right away, timeClient.update() in loop() finishes the
+//request and calls handle_NTP_result() with the outcome, so the display keeps running while waiting on the server.
+void update_NTP_time()
+{
+  if(timeClient.getRequestState() != NTP_REQUEST_PENDING){
+    timeClient.startRequest();
+  }
+}
+
+//this is called by timeClient each time an NTP request succeeds or times out.
+void handle_NTP_result(bool success)
+{
+  NTPClientStats stats = timeClient.getStats();
+  if(!success){
+    Serial.print("Unable to connect to NTP server, will try again in ms: ");
+    Serial.println(stats.nextPollIn);
+    return;
+  }
+  char date_string[21];
+  timeClient.formatDate(date_string, sizeof(date_string));
   Serial.print("NTP time updated to ");
-  Serial.println(timeClient.getFormattedDate());
+  Serial.print(date_string);
+  Serial.print(", offset ms: ");
+  Serial.print(timeClient.getLastOffset());
+  Serial.print(", round-trip delay ms: ");
+  Serial.print(timeClient.getLastDelay());
+  Serial.print(", clock drift ppb: ");
+  Serial.print(timeClient.getDriftPpb());
+  Serial.print(", servers agreeing: ");
+  Serial.print(stats.truechimers);
+  Serial.print("/");
+  Serial.print(stats.sourceCount);
+  Serial.print(", next check in ms: ");
+  Serial.println(stats.nextPollIn);
   valid_NTP_time_received = true;
-  return true;
+  //the time may have stepped, so redraw right away and line the next redraw up with the new second boundary:
+  next_redraw_time = millis();
 }
 
-//this will regularly check to make sure we're connected to the internet, and if we are, it will update the NTP time.
+//this will regularly check to make sure we're connected to the internet, and update the NTP time right after reconnecting.
 void verify_time()
 {
   if(millis() >= last_wifi_connection_attempt + WIFI_RECONNECT_CHECK_INTERVAL){
@@ -235,71 +327,144 @@ void verify_time()
         update_NTP_time();
       }
     }
-    else{
-      //force an update of the NTP time
-      update_NTP_time();
-      //set the clock to show the current time.
+    //while connected, timeClient.update() keeps the time synced on its own schedule.
+  }
+}
+
+//this is reused for every string drawn, it holds where each glyph goes.
+TextLayout text_layout;
+
+//with DISPLAY_TEXT_REVERSED the text comes from font_flipped, which has the column bits reversed at compile time,
+//and TextLayout draws it from the last column back. Both fonts have the same widths, so the string is measured once
+//and only the glyphs and columns that land on the display are drawn.
+//characters the font has no glyph for are skipped.
+template <class Display>
+void render_text_to_buffer(const char *string, TextAlign align, Display &target)
+{
+  text_layout.layout(font_upright, string);
+  text_layout.render(DISPLAY_TEXT_REVERSED ? font_flipped : font_upright, target,
+                     text_layout.alignedX(align, 0, Display::num_columns), DISPLAY_TEXT_REVERSED);
+}
+
+#ifdef BENCHMARK_DISPLAY_REFRESH
+//this times BENCHMARK_FRAMES display refreshes and prints the average frame time in us and bytes sent per frame.
+//force_full_refresh resends every row, otherwise only rows that changed since the last frame are sent.
+void benchmark_display_refresh(bool force_full_refresh)
+{
+  uint32_t benchmark_start_bytes = display.bytesSent();
+  uint32_t benchmark_start_time = micros();
+  for(uint32_t i=0; i<BENCHMARK_FRAMES; i++){
+    if(force_full_refresh){
+      display.forceRefreshAll();
+    } else {
+      display.refreshAll();
     }
   }
+  uint32_t benchmark_elapsed_time = micros() - benchmark_start_time;
+  Serial.print(MAX7219_TRANSPORT == MAX7219_TRANSPORT_HSPI ? "HSPI" : "Bit-bang");
+  Serial.print(force_full_refresh ? " full" : " diff");
+  Serial.print(" refresh frame time in us: ");
+  Serial.print(benchmark_elapsed_time / BENCHMARK_FRAMES);
+  Serial.print(", bytes per frame: ");
+  Serial.println((display.bytesSent() - benchmark_start_bytes) / BENCHMARK_FRAMES);
 }
 
-// ref: https://stackoverflow.com/a/2603254/1053092
-//8-bit byte reverse function - i.e. 0b11000001 --> 0b10000011
-static unsigned char lookup[16] = {
-0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
-0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf};
+//this times only the rotation kernel for BENCHMARK_FRAMES frames, without sending anything to the chips.
+void benchmark_rotation_kernel()
+{
+  uint8_t rows[8];
+  uint8_t checksum = 0;
+  uint32_t benchmark_start_time = micros();
+  for(uint32_t i=0; i<BENCHMARK_FRAMES; i++){
+    for(int addr=0; addr<ClockDisplay::num_chips; addr++){
+      display.chipRows(addr, rows);
+      checksum ^= rows[i & 7];
+    }
+  }
+  uint32_t benchmark_elapsed_time = micros() - benchmark_start_time;
+  Serial.print("Rotation ");
+  Serial.print(ClockDisplay::rotation);
+  Serial.print(" kernel time per frame in ns: ");
+  Serial.print(benchmark_elapsed_time * 1000UL / BENCHMARK_FRAMES);
+  //printing the checksum keeps the compiler from optimizing the kernel away.
+  Serial.print(", checksum: ");
+  Serial.println(checksum);
+}
 
-uint8_t reverse(uint8_t n) {
-   // Reverse the top and bottom nibble then swap them.
-   return (lookup[n&0b1111] << 4) | lookup[n>>4];
+//this times rendering a full clock string into the framebuffer for BENCHMARK_FRAMES frames.
+void benchmark_text_render()
+{
+  uint32_t benchmark_start_time = micros();
+  for(uint32_t i=0; i<BENCHMARK_FRAMES; i++){
+    render_text_to_buffer("12:34:56", TEXT_ALIGN_LEFT, display);
+  }
+  uint32_t benchmark_elapsed_time = micros() - benchmark_start_time;
+  Serial.print("Text render time per frame in ns: ");
+  Serial.println(benchmark_elapsed_time * 1000UL / BENCHMARK_FRAMES);
 }
 
-void render_font_char_to_buffer (char *string, int x_offset, uint8_t *buffer)
+//this times BENCHMARK_FRAMES seconds ticking by, drawn and sent to the chips the way print_time_from_NTP() does it,
+//and again clearing and redrawing the whole string every second. it prints the time in us and bytes sent per frame.
+void benchmark_clock_face(bool incremental)
 {
-  uint16_t row_count = NUM_MAX*8;
-  uint8_t font_data_width = pgm_read_byte(font);
-  uint8_t font_char_width;
-  uint8_t font_char_column;
-  size_t font_data_offset;
-  size_t character_offset = 0;
-  char character;
-  while ((character = string[character_offset]) != '\0')
-  {
-    font_data_offset = 1 + (font_data_width * character);
-    font_char_width = pgm_read_byte(font + font_data_offset);
-    font_char_column = 0;
-    while (font_char_column < font_char_width)
-    {
-      //prevent buffer overflow crashes by making sure the offset is never larger than the number of bytes in scr[]:
-      uint8_t offset = row_count - (x_offset + font_char_column + 1);
-      if(offset >= NUM_MAX*8 + 8){
-        break;
-      }
-      scr[offset] = reverse(pgm_read_byte(font + font_data_offset + 1 + font_char_column));
-      font_char_column++;
+  char time_string[] = "12:34:00";
+  clock_face.invalidate();
+  uint32_t benchmark_start_bytes = display.bytesSent();
+  uint32_t benchmark_start_time = micros();
+  for(uint32_t i=0; i<BENCHMARK_FRAMES; i++){
+    time_string[6] = i / 10 % 6 + ASCII_NUMERAL_0_OFFSET;
+    time_string[7] = i % 10 + ASCII_NUMERAL_0_OFFSET;
+    if(incremental){
+      clock_face.draw(time_string, TEXT_ALIGN_LEFT);
+      display.refreshDirty();
+    } else {
+      display.clr();
+      render_text_to_buffer(time_string, TEXT_ALIGN_LEFT, display);
+      display.refreshAll();
     }
-    x_offset += font_char_width + 1;
-    character_offset++;
   }
+  uint32_t benchmark_elapsed_time = micros() - benchmark_start_time;
+  clock_face.invalidate();
+  Serial.print(incremental ? "Incremental" : "Full");
+  Serial.print(" clock redraw time per second in us: ");
+  Serial.print(benchmark_elapsed_time / BENCHMARK_FRAMES);
+  Serial.print(", bytes per second: ");
+  Serial.println((display.bytesSent() - benchmark_start_bytes) / BENCHMARK_FRAMES);
 }
+#endif
 
 void display_error_pattern()
 {
-  render_font_char_to_buffer("ConnErr", 0x00, scr);
-  refreshAll();
+  //this draws over the clock face, so it has to start over once the time is back
+  clock_face.invalidate();
+  display.clr();
+  render_text_to_buffer("ConnErr", TEXT_ALIGN_CENTER, display);
+  display.refreshAll();
 }
 
 void print_time_from_NTP()
 {
-  //first get the hours, minutes, and seconds
-  uint8_t hours = timeClient.getHours();
-  if(DST_is_active) {
-    hours = hours + 1;
-    if(hours > 24) {
-      hours = 0;
-    }
+  //wait for the start of the next second before redrawing:
+  if((int32_t)(millis() - next_redraw_time) < 0){
+    return;
   }
-  if(!display_time_in_24_h){
+  //take one snapshot of the time, so the digits can't tear across a second boundary
+  uint16_t milliseconds;
+  uint32_t utc = timeClient.getEpochTime(milliseconds);
+  //schedule the next redraw for when the NTP time reaches the next whole second:
+  next_redraw_time = millis() + (1000U - milliseconds);
+#ifdef DST_SWITCH_OVERRIDE
+  //the switch is read once per redraw, HIGH (open) selects daylight time:
+  int32_t utc_offset = digitalRead(DST_SWITCH_PIN) ? local_timezone.dstOffset() : local_timezone.standardOffset();
+#else
+  int32_t utc_offset = local_timezone.offsetAt(utc);
+#endif
+  utc_offset += settings.get().time_correction;
+  //first get the hours, minutes, and seconds of the local time
+  DateTime now;
+  NTPClient::toDateTime(utc + utc_offset, now);
+  uint8_t hours = now.hours;
+  if(!settings.get().display_time_in_24_h){
     //correct to 12h time display values from 24h time values provided by ntp
     if(hours > 12){
       hours = hours - 12;
@@ -308,32 +473,25 @@ void print_time_from_NTP()
       hours = 12;
     }
   }
-  uint8_t minutes = timeClient.getMinutes();
-  uint8_t seconds = timeClient.getSeconds();
-  if(last_seconds != seconds){
-    last_seconds = seconds;
-    //create a time string to be displayed:
-    if(hours >= 10){
-      print_string_buffer[0] = hours/10 + ASCII_NUMERAL_0_OFFSET; //larger digit of hours
-    } else {
-      print_string_buffer[0] = ' '; //lead with a space if the time has a leading 0.
-    }
-    print_string_buffer[1] = hours%10 + ASCII_NUMERAL_0_OFFSET; //smaller digit of hours
-    print_string_buffer[2] = ':';
-    print_string_buffer[3] = minutes/10 + ASCII_NUMERAL_0_OFFSET; //larger digit of minutes
-    print_string_buffer[4] = minutes%10 + ASCII_NUMERAL_0_OFFSET; //smaller digit of minutes
-    print_string_buffer[5] = ':';
-    print_string_buffer[6] = seconds/10 + ASCII_NUMERAL_0_OFFSET; //larger digit of seconds
-    print_string_buffer[7] = seconds%10 + ASCII_NUMERAL_0_OFFSET; //smaller digit of seconds
-    print_string_buffer[8] = '\0';
-    clr();
-    render_font_char_to_buffer(print_string_buffer, 0x00, scr);
-    refreshAll();
-  }
-  else{
-    last_seconds = seconds;
-    //do nothing, only update when the seconds changes
+  uint8_t minutes = now.minutes;
+  uint8_t seconds = now.seconds;
+  //create a time string to be displayed:
+  if(hours >= 10){
+    print_string_buffer[0] = hours/10 + ASCII_NUMERAL_0_OFFSET; //larger digit of hours
+  } else {
+    print_string_buffer[0] = ' '; //lead with a space if the time has a leading 0.
   }
+  print_string_buffer[1] = hours%10 + ASCII_NUMERAL_0_OFFSET; //smaller digit of hours
+  print_string_buffer[2] = ':';
+  print_string_buffer[3] = minutes/10 + ASCII_NUMERAL_0_OFFSET; //larger digit of minutes
+  print_string_buffer[4] = minutes%10 + ASCII_NUMERAL_0_OFFSET; //smaller digit of minutes
+  print_string_buffer[5] = ':';
+  print_string_buffer[6] = seconds/10 + ASCII_NUMERAL_0_OFFSET; //larger digit of seconds
+  print_string_buffer[7] = seconds%10 + ASCII_NUMERAL_0_OFFSET; //smaller digit of seconds
+  print_string_buffer[8] = '\0';
+  //the time stays left aligned, so the digits don't shift sideways as their widths change
+  clock_face.draw(print_string_buffer, TEXT_ALIGN_LEFT);
+  display.refreshDirty();
 }
 
 //this will output the current time to the LCD display
@@ -347,7 +505,7 @@ void display_time(void)
   else{
     //output an error pattern:
     display_error_pattern();
-    refreshAll();
+    display.refreshAll();
   }
 }
 
@@ -357,32 +515,49 @@ void setup()
   Serial.begin(115200);
   Serial.println();
 
+#ifdef DST_SWITCH_OVERRIDE
   // Configure the DST switch pins:
   pinMode(DST_SWITCH_PIN, INPUT_PULLUP);
   pinMode(DST_SWITCH_GND_PIN, OUTPUT);
   digitalWrite(DST_SWITCH_GND_PIN, LOW);
+#endif
 
-  //set up the EEPROM section of the flash:
-  EEPROM.begin(NUM_EEPROM_BYTES);
-
-  //check the EEPROM memory to see if it has been initialized.
-  Serial.println(EEPROM.read(EEPROM_INIT_ADDRESS));
-  if(EEPROM.read(EEPROM_INIT_ADDRESS) != EEPROM_HAS_BEEN_INITIALIZED || FORCE_EEPROM_INIT){
-    init_EEPROM();
-    Serial.println(EEPROM.read(EEPROM_INIT_ADDRESS));
-  } else {
-    restore_from_EEPROM();
+  //set up the time zone rules:
+  if(!local_timezone.begin(findTimezoneZone(TIMEZONE_NAME))){
+    Serial.println("Unknown TIMEZONE_NAME, showing UTC.");
   }
 
+  //load the settings, the first change starts a new settings log if there isn't one yet:
+  load_settings();
+
   //init displays:
-  initMAX7219();
-  sendCmdAll(CMD_SHUTDOWN, 1); //turn shutdown mode off
-  sendCmdAll(CMD_INTENSITY, DEFAULT_BRIGHTNESS); //set brightness
+  display.begin();
+  display.sendCmdAll(CMD_SHUTDOWN, 1); //turn shutdown mode off
+  display.sendCmdAll(CMD_INTENSITY, settings.get().brightness); //set brightness
 
   //print an init message to the display:
   display_error_pattern();
 
+#ifdef BENCHMARK_DISPLAY_REFRESH
+  benchmark_display_refresh(true);
+  benchmark_display_refresh(false);
+  benchmark_rotation_kernel();
+  benchmark_text_render();
+  benchmark_clock_face(false);
+  benchmark_clock_face(true);
+#endif
+
   //start the NTP Client object
+  timeClient.setRequestTimeout(NTP_CONNECTION_TIMEOUT);
+  timeClient.setMaxDelay(NTP_MAX_ROUND_TRIP_DELAY);
+  timeClient.setMaxPollExponent(NTP_MAX_POLL_EXPONENT);
+  for(const char *server : ntp_servers){
+    timeClient.addServer(server);
+  }
+  timeClient.setResolver(resolve_NTP_server);
+  //show the time from the first server to answer after boot, the rest of the replies refine it a moment later:
+  timeClient.setHedging(true);
+  timeClient.onResult(handle_NTP_result);
   timeClient.begin();
 
   if(!connect_to_wifi()){
@@ -396,12 +571,12 @@ void setup()
 
 void loop()
 {
-  //update the ntpClient object
+  //update the ntpClient object, this never waits on the network
   timeClient.update();
-  //check the state of the DST switch and set the bool accordingly:
-  DST_is_active = digitalRead(DST_SWITCH_PIN);
   //check connectivity and update time from remote NTP servers
   verify_time();
   //display the current time if a valid time has been received.
   display_time();
+  //write any changed settings to flash once they have settled
+  settings.update();
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+// a UDP stack on the host with simulated NTP servers behind it. each server answers after its own delays with a
+//clock that is off by its own offset, or not at all. the true UTC time is true_base_ms + millis(), plus skew_ppb of
+//millis() for a local crystal that runs slow (or fast, if negative). replies only show up in parsePacket() once millis() has reached their arrival time, so tests move time on to receive them.
+
+#pragma once
+
+#include <Arduino.h>
+#include <Udp.h>
+#include <vector>
+#include <string>
+
+struct FakeNtpServer {
+  std::string name;
+  IPAddress address;
+  long offset_ms;              //how far the server's clock is off
+  unsigned long up_delay;      //ms from the request leaving to it reaching the server
+  unsigned long down_delay;    //ms from the server answering to the reply arriving
+  bool alive;
+};
+
+class FakeUdp : public UDP {
+  public:
+    unsigned long long true_base_ms = 1700000000000ULL;
+    long long skew_ppb = 0;
+    std::vector<FakeNtpServer> servers;
+    int packets_sent = 0;
+    int name_lookups = 0;      //beginPacket() calls with a host name, each would be a DNS lookup
+
+    unsigned long long trueMillis() const { return true_base_ms + millis() + (long long)millis() * skew_ppb / 1000000000LL; }
+
+    uint8_t begin(uint16_t) override { return 1; }
+    void stop() override {}
+
+    int beginPacket(IPAddress ip, uint16_t) override
+    {
+      _target = -1;
+      for(size_t i = 0; i < servers.size(); i++) {
+        if(servers[i].address == ip) _target = i;
+      }
+      return 1;
+    }
+
+    int beginPacket(const char *host, uint16_t) override
+    {
+      name_lookups++;
+      _target = -1;
+      for(size_t i = 0; i < servers.size(); i++) {
+        if(servers[i].name == host) _target = i;
+      }
+      return _target >= 0;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+      memcpy(_request, buffer, size < sizeof(_request) ? size : sizeof(_request));
+      return size;
+    }
+
+    //queues the server's reply: the request's transmit timestamp comes back as the origin, and the receive and
+    //transmit timestamps are the server's clock when the request arrived.
+    int endPacket() override
+    {
+      packets_sent++;
+      if(_target < 0 || !servers[_target].alive) return 1;
+      const FakeNtpServer &server = servers[_target];
+      Reply reply;
+      memset(reply.packet, 0, sizeof(reply.packet));
+      reply.packet[0] = 0b00100100;   //LI 0, version 4, mode server
+      reply.packet[1] = 2;            //stratum
+      reply.packet[16] = 1;           //reference timestamp
+      memcpy(reply.packet + 24, _request + 40, 8);
+      unsigned long long served = trueMillis() + server.up_delay + server.offset_ms;
+      putTimestamp(reply.packet + 32, served);
+      putTimestamp(reply.packet + 40, served);
+      reply.arrives_at = millis() + server.up_delay + server.down_delay;
+      reply.from = server.address;
+      _replies.push_back(reply);
+      return 1;
+    }
+
+    int parsePacket() override
+    {
+      for(size_t i = 0; i < _replies.size(); i++) {
+        if((long)(millis() - _replies[i].arrives_at) >= 0) {
+          _received = _replies[i];
+          _replies.erase(_replies.begin() + i);
+          _have_packet = true;
+          return sizeof(_received.packet);
+        }
+      }
+      _have_packet = false;
+      return 0;
+    }
+
+    int read(unsigned char *buffer, size_t len) override
+    {
+      if(!_have_packet) return 0;
+      if(len > sizeof(_received.packet)) len = sizeof(_received.packet);
+      memcpy(buffer, _received.packet, len);
+      return len;
+    }
+
+    IPAddress remoteIP() override { return _received.from; }
+    uint16_t remotePort() override { return 123; }
+
+  private:
+    struct Reply {
+      uint8_t packet[48];
+      unsigned long arrives_at;
+      IPAddress from;
+    };
+
+    std::vector<Reply> _replies;
+    Reply _received;
+    bool _have_packet = false;
+    int _target = -1;
+    uint8_t _request[48];
+
+    //writes unix time in ms as a 64-bit NTP timestamp.
+    static void putTimestamp(uint8_t *p, unsigned long long unix_ms)
+    {
+      unsigned long long seconds = unix_ms / 1000 + 2208988800ULL;
+      unsigned long long fraction = ((unix_ms % 1000) << 32) / 1000;
+      for(int i = 0; i < 4; i++) {
+        p[i] = seconds >> (24 - 8 * i);
+        p[4 + i] = fraction >> (24 - 8 * i);
+      }
+    }
+};
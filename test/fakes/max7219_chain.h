@@ -0,0 +1,38 @@
+// a MAX7219 chain on the host: a transport that decodes every frame into the digit registers each chip would hold,
+//so tests can compare what the chips show against what the framebuffer says they should.
+
+#pragma once
+
+#include <Arduino.h>
+#include <max7219.h>
+
+template <uint8_t NumChips>
+struct Max7219Chain {
+  uint8_t digits[NumChips][8] = {};
+  uint32_t frames = 0;
+  uint32_t bytes = 0;
+};
+
+template <uint8_t NumChips>
+class Max7219ChainTransport {
+  public:
+    Max7219ChainTransport(Max7219Chain<NumChips> &chain) : _chain(&chain) {}
+
+    void begin() {}
+
+    //the first pair shifted out ends up in the last chip of the chain.
+    void send(const uint8_t *data, size_t len)
+    {
+      _chain->frames++;
+      _chain->bytes += len;
+      for(size_t pair = 0; pair < len / 2 && pair < NumChips; pair++) {
+        uint8_t cmd = data[pair * 2];
+        if(cmd >= CMD_DIGIT0 && cmd <= CMD_DIGIT7) {
+          _chain->digits[NumChips - 1 - pair][cmd - CMD_DIGIT0] = data[pair * 2 + 1];
+        }
+      }
+    }
+
+  private:
+    Max7219Chain<NumChips> *_chain;
+};
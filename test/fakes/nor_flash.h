@@ -0,0 +1,88 @@
+// a NOR flash chip on the host for the settings log: erasing sets a whole sector to ones and writing can only clear
+//bits, like the ESP8266's SPI flash. it counts reads, writes and erases per sector, and can cut the power after a
+//number of bytes.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <settings_log.h>
+#include <vector>
+
+struct NorFlashChip {
+  std::vector<uint8_t> bytes;
+  std::vector<uint32_t> erases;
+  uint32_t reads = 0;
+  uint32_t writes = 0;
+  //writes that tried to turn a 0 bit back into a 1, which real flash silently ignores
+  uint32_t set_bit_writes = 0;
+  //once this many more bytes have been written every write and erase fails, -1 never cuts the power
+  long power_cut_after = -1;
+
+  //a new chip is not erased, so nothing can depend on the flash starting out as ones.
+  NorFlashChip(uint8_t num_sectors) : bytes(num_sectors * SETTINGS_LOG_SECTOR_SIZE, 0x5A), erases(num_sectors, 0) {}
+
+  uint8_t sectors() const { return erases.size(); }
+
+  uint32_t totalErases() const
+  {
+    uint32_t total = 0;
+    for(uint32_t count : erases) {
+      total += count;
+    }
+    return total;
+  }
+};
+
+//the flash class handed to SettingsLog, which keeps its own copy, so the bytes live in the chip.
+class NorFlash {
+  public:
+    NorFlash(NorFlashChip &chip) : _chip(&chip) {}
+
+    uint8_t sectors() const { return _chip->sectors(); }
+
+    bool read(uint32_t address, uint32_t *data, size_t size)
+    {
+      if(address % 4 || size % 4 || address + size > _chip->bytes.size()) {
+        return false;
+      }
+      _chip->reads++;
+      memcpy(data, &_chip->bytes[address], size);
+      return true;
+    }
+
+    bool write(uint32_t address, const uint32_t *data, size_t size)
+    {
+      if(address % 4 || size % 4 || address + size > _chip->bytes.size()) {
+        return false;
+      }
+      _chip->writes++;
+      const uint8_t *source = (const uint8_t *)data;
+      for(size_t i = 0; i < size; i++) {
+        if(_chip->power_cut_after == 0) {
+          return false;
+        }
+        if(_chip->power_cut_after > 0) {
+          _chip->power_cut_after--;
+        }
+        if(source[i] & ~_chip->bytes[address + i]) {
+          _chip->set_bit_writes++;
+        }
+        _chip->bytes[address + i] &= source[i];
+      }
+      return true;
+    }
+
+    bool erase(uint8_t sector)
+    {
+      if(_chip->power_cut_after == 0 || sector >= sectors()) {
+        return false;
+      }
+      memset(&_chip->bytes[sector * SETTINGS_LOG_SECTOR_SIZE], 0xFF, SETTINGS_LOG_SECTOR_SIZE);
+      _chip->erases[sector]++;
+      return true;
+    }
+
+  private:
+    NorFlashChip *_chip;
+};
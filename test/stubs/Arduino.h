@@ -0,0 +1,90 @@
+// host stand-in for the parts of the ESP8266 Arduino core the libraries use, for the native test env.
+//time only moves when a test moves it: millis() and micros() return host_millis and host_micros, delay() adds to them.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "binary.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void * const *)(p))
+#define memcpy_P memcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LSBFIRST 0
+#define MSBFIRST 1
+#define DEC 10
+#define HEX 16
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline unsigned long host_millis = 0;
+inline unsigned long host_micros = 0;
+
+inline unsigned long millis() { return host_millis; }
+inline unsigned long micros() { return host_micros; }
+inline void delay(unsigned long ms) { host_millis += ms; host_micros += ms * 1000UL; }
+inline void yield() {}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline void shiftOut(uint8_t, uint8_t, uint8_t, uint8_t) {}
+
+inline uint16_t word(uint8_t high, uint8_t low) { return (uint16_t)(high << 8 | low); }
+inline long random(long howbig) { return rand() % howbig; }
+inline long random(long howsmall, long howbig) { return howsmall + rand() % (howbig - howsmall); }
+
+//only what the String overloads of NTPClient need.
+class String {
+  public:
+    String() {}
+    String(const char *string) : _string(string) {}
+    const char *c_str() const { return _string.c_str(); }
+    size_t length() const { return _string.length(); }
+    bool operator==(const char *string) const { return _string == string; }
+
+  private:
+    std::string _string;
+};
+
+class IPAddress {
+  public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d} {}
+    uint8_t operator[](int index) const { return _bytes[index]; }
+    bool operator==(const IPAddress &other) const { return memcmp(_bytes, other._bytes, 4) == 0; }
+    bool operator!=(const IPAddress &other) const { return !(*this == other); }
+
+  private:
+    uint8_t _bytes[4] = {0, 0, 0, 0};
+};
+
+class HardwareSerial {
+  public:
+    void begin(unsigned long) {}
+    template <class T> void print(T) {}
+    template <class T> void print(T, int) {}
+    template <class T> void println(T) {}
+    template <class T> void println(T, int) {}
+    void println() {}
+};
+
+inline HardwareSerial Serial;
@@ -0,0 +1,20 @@
+// host stand-in for the ESP8266 EEPROM library, backed by RAM that starts out erased. tests write bytes into it
+//to stand for what older firmware left behind.
+
+#pragma once
+
+#include <Arduino.h>
+
+class EEPROMClass {
+  public:
+    EEPROMClass() { memset(bytes, 0xFF, sizeof(bytes)); }
+    void begin(size_t) {}
+    uint8_t read(int address) const { return bytes[address]; }
+    void write(int address, uint8_t value) { bytes[address] = value; }
+    bool commit() { return true; }
+    bool end() { return true; }
+
+    uint8_t bytes[4096];
+};
+
+inline EEPROMClass EEPROM;
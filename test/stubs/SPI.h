@@ -0,0 +1,23 @@
+// host stand-in for the ESP8266 SPI library, the bytes written go nowhere.
+
+#pragma once
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0
+
+class SPISettings {
+  public:
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+  public:
+    void begin() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    void writeBytes(const uint8_t *, uint32_t) {}
+};
+
+inline SPIClass SPI;
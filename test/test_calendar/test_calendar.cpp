@@ -0,0 +1,147 @@
+// host tests for NTPClient::toDateTime(), checked against the C library's gmtime() over the whole range of 32-bit
+//unix times (1970 to 2106), and a benchmark against the year by year loop getFormattedDate() used before it.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <chrono>
+#include <fake_udp.h>
+#include <stdio.h>
+#include <time.h>
+#include <unity.h>
+
+static void checkAgainstGmtime(unsigned long secs)
+{
+  time_t t = (time_t)secs;
+  struct tm expected;
+  gmtime_r(&t, &expected);
+  DateTime date_time;
+  NTPClient::toDateTime(secs, date_time);
+  if(date_time.year != expected.tm_year + 1900 || date_time.month != expected.tm_mon + 1 ||
+     date_time.day != expected.tm_mday || date_time.hours != expected.tm_hour ||
+     date_time.minutes != expected.tm_min || date_time.seconds != expected.tm_sec ||
+     date_time.weekday != expected.tm_wday || date_time.milliseconds != 0) {
+    char message[120];
+    snprintf(message, sizeof(message), "%lu: got %04u-%02u-%02u %02u:%02u:%02u weekday %u", secs, date_time.year,
+             date_time.month, date_time.day, date_time.hours, date_time.minutes, date_time.seconds, date_time.weekday);
+    TEST_FAIL_MESSAGE(message);
+  }
+}
+
+//the day, month and year only change at midnight, so every day of the range is checked at its first and last second
+//and at a time that drifts through the day.
+void test_every_day_matches_gmtime()
+{
+  TEST_ASSERT_EQUAL(8, sizeof(time_t));
+  for(unsigned long long day_start = 0; day_start <= 0xFFFFFFFFULL; day_start += 86400) {
+    checkAgainstGmtime(day_start);
+    checkAgainstGmtime((unsigned long)(day_start + (day_start / 86400 * 7919) % 86400));
+    if(day_start + 86399 <= 0xFFFFFFFFULL) {
+      checkAgainstGmtime(day_start + 86399);
+    }
+  }
+  checkAgainstGmtime(0xFFFFFFFFUL);
+}
+
+void test_range_ends()
+{
+  DateTime date_time;
+  NTPClient::toDateTime(0, date_time);
+  TEST_ASSERT_EQUAL(1970, date_time.year);
+  TEST_ASSERT_EQUAL(4, date_time.weekday);
+  NTPClient::toDateTime(0xFFFFFFFFUL, date_time);
+  TEST_ASSERT_EQUAL(2106, date_time.year);
+  TEST_ASSERT_EQUAL(2, date_time.month);
+  TEST_ASSERT_EQUAL(7, date_time.day);
+  TEST_ASSERT_EQUAL(6, date_time.hours);
+  TEST_ASSERT_EQUAL(28, date_time.minutes);
+  TEST_ASSERT_EQUAL(15, date_time.seconds);
+}
+
+//getDateTime() takes its fields from one reading of the clock, milliseconds included.
+void test_snapshot_matches_epoch()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 60000UL);
+  client.setEpochTime(1078067961UL);
+  host_millis += 1234;
+  DateTime date_time;
+  client.getDateTime(date_time);
+  TEST_ASSERT_EQUAL(2004, date_time.year);
+  TEST_ASSERT_EQUAL(2, date_time.month);
+  TEST_ASSERT_EQUAL(29, date_time.day);
+  TEST_ASSERT_EQUAL(15, date_time.hours);
+  TEST_ASSERT_EQUAL(19, date_time.minutes);
+  TEST_ASSERT_EQUAL(22, date_time.seconds);
+  TEST_ASSERT_EQUAL(234, date_time.milliseconds);
+  TEST_ASSERT_EQUAL(0, date_time.weekday);
+}
+
+//the date part of the old getFormattedDate(): a loop over the years since 1970, then over the months.
+static void yearLoopDate(unsigned long secs, unsigned &year_out, unsigned &month_out, unsigned &day_out)
+{
+  static const uint8_t month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  unsigned long rawTime = secs / 86400L;
+  unsigned long days = 0, year = 1970;
+  uint8_t month, monthLength;
+  while((days += (LEAP_YEAR(year) ? 366 : 365)) <= rawTime) year++;
+  rawTime -= days - (LEAP_YEAR(year) ? 366 : 365);
+  for(month = 0; month < 12; month++) {
+    monthLength = month == 1 ? (LEAP_YEAR(year) ? 29 : 28) : month_days[month];
+    if(rawTime < monthLength) break;
+    rawTime -= monthLength;
+  }
+  year_out = year;
+  month_out = month + 1;
+  day_out = rawTime + 1;
+}
+
+//prints the cost of one conversion, averaged over times spread evenly across the whole range.
+void test_benchmark_calendar()
+{
+  const unsigned long step = 3907;
+  const double calls = 0xFFFFFFFFULL / step + 1;
+  volatile unsigned sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for(unsigned long long secs = 0; secs <= 0xFFFFFFFFULL; secs += step) {
+    unsigned year, month, day;
+    yearLoopDate(secs, year, month, day);
+    sink += year + month + day;
+  }
+  double year_loop_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+
+  start = std::chrono::steady_clock::now();
+  for(unsigned long long secs = 0; secs <= 0xFFFFFFFFULL; secs += step) {
+    time_t t = (time_t)secs;
+    struct tm result;
+    gmtime_r(&t, &result);
+    sink += result.tm_year + result.tm_mon + result.tm_mday;
+  }
+  double gmtime_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+
+  start = std::chrono::steady_clock::now();
+  for(unsigned long long secs = 0; secs <= 0xFFFFFFFFULL; secs += step) {
+    DateTime date_time;
+    NTPClient::toDateTime(secs, date_time);
+    sink += date_time.year + date_time.month + date_time.day;
+  }
+  double to_date_time_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+
+  char message[160];
+  snprintf(message, sizeof(message), "1970-2106: year loop %.1f ns, gmtime_r %.1f ns, toDateTime %.1f ns per date",
+           year_loop_ns, gmtime_ns, to_date_time_ns);
+  TEST_MESSAGE(message);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_every_day_matches_gmtime);
+  RUN_TEST(test_range_ends);
+  RUN_TEST(test_snapshot_matches_epoch);
+  RUN_TEST(test_benchmark_calendar);
+  return UNITY_END();
+}
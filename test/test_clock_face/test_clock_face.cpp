@@ -0,0 +1,163 @@
+// host tests for the clock face: after every second drawn incrementally, the chips must show exactly what a full
+//redraw of the time would put on them, at every rotation and in both text directions. also prints what a second
+//costs either way, in time and in bytes sent to the chain.
+
+#include <Arduino.h>
+#include <max7219.h>
+#include <max7219_chain.h>
+#include <clock_face.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+
+struct NullTransport {
+  void begin() {}
+  void send(const uint8_t *, size_t) {}
+};
+
+//what render_text_to_buffer() in main.cpp does after clearing the display.
+template <bool Reversed, class Display>
+static void renderText(const char *string, TextAlign align, Display &target)
+{
+  TextLayout text_layout;
+  text_layout.layout(font_upright, string);
+  text_layout.render(Reversed ? font_flipped : font_upright, target, text_layout.alignedX(align, 0, Display::num_columns),
+                     Reversed);
+}
+
+//the time the way the clock shows it in 12 hour mode, with a blank instead of a leading zero.
+static void formatClock(char *string, long seconds)
+{
+  int hours = seconds / 3600 % 12;
+  if(hours == 0) {
+    hours = 12;
+  }
+  string[0] = hours >= 10 ? '1' : ' ';
+  string[1] = '0' + hours % 10;
+  string[2] = ':';
+  string[3] = '0' + seconds / 60 % 60 / 10;
+  string[4] = '0' + seconds / 60 % 10;
+  string[5] = ':';
+  string[6] = '0' + seconds % 60 / 10;
+  string[7] = '0' + seconds % 10;
+  string[8] = '\0';
+}
+
+//runs through a stretch of consecutive seconds across the 12 o'clock rollover, then random jumps like a resync, with
+//an error message drawn over the face once and a change of alignment near the end.
+template <uint16_t Rotation, bool Reversed>
+static void checkIncrementalMatchesFull()
+{
+  Max7219Chain<4> chain;
+  Max7219Display<4, Rotation, Max7219ChainTransport<4>> display{Max7219ChainTransport<4>(chain)};
+  Max7219Display<4, Rotation, NullTransport> reference{NullTransport()};
+  ClockFace<Max7219Display<4, Rotation, Max7219ChainTransport<4>>, Reversed> clock_face(display);
+  display.begin();
+  srand(Rotation + Reversed);
+  char string[9];
+  for(int step = 0; step < 20000; step++) {
+    long seconds = step < 10000 ? 11L * 3600 + 59 * 60 + step : rand() % 86400L;
+    formatClock(string, seconds);
+    if(step == 5000) {
+      clock_face.invalidate();
+      display.clr();
+      renderText<Reversed>("ConnErr", TEXT_ALIGN_CENTER, display);
+      display.refreshAll();
+    }
+    TextAlign align = step > 15000 ? TEXT_ALIGN_CENTER : TEXT_ALIGN_LEFT;
+    clock_face.draw(string, align);
+    display.refreshDirty();
+
+    reference.clr();
+    renderText<Reversed>(string, align, reference);
+    for(int addr = 0; addr < 4; addr++) {
+      uint8_t rows[8];
+      reference.chipRows(addr, rows);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(rows, chain.digits[addr], 8, string);
+    }
+  }
+}
+
+void test_incremental_matches_full_rotation_0() { checkIncrementalMatchesFull<0, false>(); checkIncrementalMatchesFull<0, true>(); }
+void test_incremental_matches_full_rotation_90() { checkIncrementalMatchesFull<90, false>(); checkIncrementalMatchesFull<90, true>(); }
+void test_incremental_matches_full_rotation_180() { checkIncrementalMatchesFull<180, false>(); checkIncrementalMatchesFull<180, true>(); }
+void test_incremental_matches_full_rotation_270() { checkIncrementalMatchesFull<270, false>(); checkIncrementalMatchesFull<270, true>(); }
+
+//an unchanged string redraws nothing and sends nothing.
+void test_same_second_sends_nothing()
+{
+  Max7219Chain<4> chain;
+  Max7219Display<4, 90, Max7219ChainTransport<4>> display{Max7219ChainTransport<4>(chain)};
+  ClockFace<Max7219Display<4, 90, Max7219ChainTransport<4>>, true> clock_face(display);
+  display.begin();
+  clock_face.draw("12:34:56", TEXT_ALIGN_LEFT);
+  display.refreshDirty();
+  uint32_t bytes = chain.bytes;
+  clock_face.draw("12:34:56", TEXT_ALIGN_LEFT);
+  display.refreshDirty();
+  TEST_ASSERT_EQUAL_UINT32(bytes, chain.bytes);
+}
+
+//prints the cost of one second, drawn in full with refreshAll() the way the clock did before the face, and drawn
+//incrementally with refreshDirty(), each split into drawing the framebuffer and building and sending the rows.
+void test_benchmark_redraw()
+{
+  const long seconds = 200000;
+  Max7219Chain<4> chain;
+  Max7219Display<4, 90, Max7219ChainTransport<4>> display{Max7219ChainTransport<4>(chain)};
+  ClockFace<Max7219Display<4, 90, Max7219ChainTransport<4>>, true> clock_face(display);
+  display.begin();
+  char string[9];
+  //[incremental][refresh]
+  double ns[2][2];
+  uint32_t bytes[2];
+  for(int incremental = 0; incremental < 2; incremental++) {
+    for(int refresh = 0; refresh < 2; refresh++) {
+      uint32_t bytes_before = chain.bytes;
+      clock_face.invalidate();
+      auto start = std::chrono::steady_clock::now();
+      for(long second = 0; second < seconds; second++) {
+        formatClock(string, 12L * 3600 + second);
+        if(incremental) {
+          clock_face.draw(string, TEXT_ALIGN_LEFT);
+          if(refresh) {
+            display.refreshDirty();
+          }
+        } else {
+          display.clr();
+          renderText<true>(string, TEXT_ALIGN_LEFT, display);
+          if(refresh) {
+            display.refreshAll();
+          }
+        }
+      }
+      ns[incremental][refresh] =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / seconds;
+      bytes[incremental] = chain.bytes - bytes_before;
+    }
+  }
+  char message[200];
+  snprintf(message, sizeof(message), "one second: full redraw %.0f ns drawing + %.0f ns refreshing and %.1f bytes, "
+           "incremental %.0f ns drawing + %.0f ns refreshing and %.1f bytes", ns[0][0], ns[0][1] - ns[0][0],
+           bytes[0] / (double)seconds, ns[1][0], ns[1][1] - ns[1][0], bytes[1] / (double)seconds);
+  TEST_MESSAGE(message);
+  //refreshAll() already only sends the rows that changed, so the saving is in the drawing and the rotation kernel,
+  //not on the wire
+  TEST_ASSERT_EQUAL_UINT32(bytes[0], bytes[1]);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_incremental_matches_full_rotation_0);
+  RUN_TEST(test_incremental_matches_full_rotation_90);
+  RUN_TEST(test_incremental_matches_full_rotation_180);
+  RUN_TEST(test_incremental_matches_full_rotation_270);
+  RUN_TEST(test_same_second_sends_nothing);
+  RUN_TEST(test_benchmark_redraw);
+  return UNITY_END();
+}
@@ -0,0 +1,152 @@
+// host tests for upgrading a clock from the EEPROM settings of version 0 firmware to the settings log: the values are
+//read from the layout that firmware wrote, stored in the log once, and read from there after every later boot. the
+//UTC offset of versions 0 and 1 becomes a correction on top of TIMEZONE_NAME, America/Denver, which is UTC-7 in winter.
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <nor_flash.h>
+#include <settings_cache.h>
+#include <clock_settings.h>
+#include <unity.h>
+
+typedef SettingsLog<NorFlash> TestLog;
+typedef SettingsCache<TestLog, ClockSettings> TestCache;
+
+//writes a value the way version 0 firmware did: the 3 lowest bytes, Least Significant Byte first.
+static void writeLegacyValue(unsigned int address, uint32_t value)
+{
+  for(int i = 0; i < 3; i++) {
+    EEPROM.write(address + i, value & 0xFF);
+    value >>= 8;
+  }
+}
+
+static void writeLegacySettings(uint32_t brightness, uint32_t display_mode, uint32_t time_in_24_h, int32_t time_offset)
+{
+  writeLegacyValue(LEGACY_EEPROM_INIT_ADDRESS, LEGACY_EEPROM_HAS_BEEN_INITIALIZED);
+  writeLegacyValue(LEGACY_EEPROM_BRIGHTNESS_ADDRESS, brightness);
+  writeLegacyValue(LEGACY_EEPROM_DISPLAY_MODE_ADDRESS, display_mode);
+  writeLegacyValue(LEGACY_EEPROM_12H_24H_ADDRESS, time_in_24_h);
+  writeLegacyValue(LEGACY_EEPROM_TIME_OFFSET_ADDRESS, (uint32_t)time_offset);
+}
+
+void setUp()
+{
+  host_millis = 10000;
+  memset(EEPROM.bytes, 0xFF, sizeof(EEPROM.bytes));
+}
+
+void tearDown() {}
+
+void test_erased_eeprom_gives_defaults()
+{
+  NorFlashChip chip(2);
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+  TEST_ASSERT_EQUAL(0, cache.begin());
+  TEST_ASSERT_EQUAL(DEFAULT_BRIGHTNESS, cache.get().brightness);
+  TEST_ASSERT_EQUAL(DEFAULT_DISPLAY_MODE, cache.get().display_mode);
+  TEST_ASSERT_EQUAL(DEFAULT_12H_24H_MODE, cache.get().display_time_in_24_h);
+  TEST_ASSERT_EQUAL(DEFAULT_TIME_CORRECTION, cache.get().time_correction);
+}
+
+//a clock set to the zone's own standard offset needs no correction.
+void test_zone_offset_needs_no_correction()
+{
+  writeLegacySettings(4, 0, _12H_MODE, -7L * 60L * 60L);
+  NorFlashChip chip(2);
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+  cache.begin();
+  TEST_ASSERT_EQUAL(0, cache.get().time_correction);
+}
+
+void test_version_0_settings_are_migrated_once()
+{
+  writeLegacySettings(9, 1, _24H_MODE, -5L * 60L * 60L);
+  NorFlashChip chip(2);
+  {
+    TestLog log{NorFlash(chip)};
+    TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+    TEST_ASSERT_EQUAL(0, cache.begin());
+    TEST_ASSERT_EQUAL(9, cache.get().brightness);
+    TEST_ASSERT_EQUAL(1, cache.get().display_mode);
+    TEST_ASSERT_EQUAL(_24H_MODE, cache.get().display_time_in_24_h);
+    //a clock set to Eastern time keeps showing it, 2 hours ahead of Denver
+    TEST_ASSERT_EQUAL(2L * 60L * 60L, cache.get().time_correction);
+    TEST_ASSERT_TRUE(cache.dirty());
+    TEST_ASSERT_TRUE(cache.flush());
+  }
+  //the EEPROM is left alone, but once the log holds the settings it is no longer read
+  writeLegacyValue(LEGACY_EEPROM_BRIGHTNESS_ADDRESS, 3);
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+  TEST_ASSERT_EQUAL(CLOCK_SETTINGS_VERSION, cache.begin());
+  TEST_ASSERT_EQUAL(9, cache.get().brightness);
+  TEST_ASSERT_EQUAL(2L * 60L * 60L, cache.get().time_correction);
+  TEST_ASSERT_FALSE(cache.dirty());
+}
+
+//the offsets east of UTC are positive and were stored the same way.
+void test_positive_offset()
+{
+  writeLegacySettings(15, 0, _12H_MODE, 9L * 60L * 60L);
+  NorFlashChip chip(2);
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+  cache.begin();
+  TEST_ASSERT_EQUAL(15, cache.get().brightness);
+  TEST_ASSERT_EQUAL(16L * 60L * 60L, cache.get().time_correction);
+}
+
+//version 0 never checked the values it read back, they are clamped into range on the way in.
+void test_out_of_range_values_are_clamped()
+{
+  writeLegacySettings(0x20, 1, _24H_MODE, 20L * 60L * 60L);
+  //20 hours east of UTC is 27 ahead of Denver
+  NorFlashChip chip(2);
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+  cache.begin();
+  TEST_ASSERT_EQUAL(15, cache.get().brightness);
+  TEST_ASSERT_EQUAL(26L * 60L * 60L, cache.get().time_correction);
+}
+
+//version 1 stored the UTC offset in the log, it is converted once and stored as a correction.
+void test_version_1_offset_becomes_a_correction()
+{
+  NorFlashChip chip(2);
+  {
+    TestLog log{NorFlash(chip)};
+    log.begin();
+    ClockSettings version_1 = {1, 7, 0, _24H_MODE, -6L * 60L * 60L};
+    SettingsLogEntry entry = {CLOCK_SETTINGS_KEY, sizeof(version_1), &version_1};
+    TEST_ASSERT_TRUE(log.commit(&entry, 1));
+  }
+  {
+    TestLog log{NorFlash(chip)};
+    TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+    TEST_ASSERT_EQUAL(1, cache.begin());
+    TEST_ASSERT_EQUAL(7, cache.get().brightness);
+    TEST_ASSERT_EQUAL(60L * 60L, cache.get().time_correction);
+    TEST_ASSERT_TRUE(cache.dirty());
+    TEST_ASSERT_TRUE(cache.flush());
+  }
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, ClockSettingsSchema<TestLog>::schema);
+  TEST_ASSERT_EQUAL(CLOCK_SETTINGS_VERSION, cache.begin());
+  TEST_ASSERT_EQUAL(60L * 60L, cache.get().time_correction);
+  TEST_ASSERT_FALSE(cache.dirty());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_erased_eeprom_gives_defaults);
+  RUN_TEST(test_zone_offset_needs_no_correction);
+  RUN_TEST(test_version_0_settings_are_migrated_once);
+  RUN_TEST(test_positive_offset);
+  RUN_TEST(test_out_of_range_values_are_clamped);
+  RUN_TEST(test_version_1_offset_becomes_a_correction);
+  return UNITY_END();
+}
@@ -0,0 +1,35 @@
+// font dig6x8_rle generated by tools/fontc.py from dig6x8.bdf, do not edit.
+//regenerate with: python3 tools/fontc.py -o test/test_font_rle/font_dig6x8_rle.h --name dig6x8_rle --first 0 --fixed --encoding rle test/test_font_rle/dig6x8.bdf
+//10 glyphs '0' to '9' (48 to 57), 8 rows, up to 6 columns wide
+//fixed stride: 71 bytes
+//raw: 60 column bytes + 11 index = 71 bytes, drawn straight from flash
+//rle: 70 encoded bytes + 11 index = 81 bytes, unpacked on every draw
+//rle encoded, 81 bytes per orientation.
+
+#pragma once
+
+#include <fonts.h>
+
+const uint8_t dig6x8_rle_upright_columns[] PROGMEM = {
+  0x05, 0x7E, 0xFF, 0x81, 0x81, 0xFF, 0x7E, 0x05, 0x00, 0x82, 0xFF, 0xFF, 0x80, 0x00, 0x05, 0xC2,
+  0xE3, 0xB1, 0x99, 0x8F, 0x86, 0x05, 0x42, 0xC3, 0x89, 0x89, 0xFF, 0x76, 0x05, 0x38, 0x3C, 0x26,
+  0x23, 0xFF, 0xFF, 0x05, 0x4F, 0xCF, 0x89, 0x89, 0xF9, 0x71, 0x05, 0x7E, 0xFF, 0x89, 0x89, 0xFB,
+  0x72, 0x80, 0x01, 0x03, 0xF1, 0xF9, 0x0F, 0x07, 0x05, 0x76, 0xFF, 0x89, 0x89, 0xFF, 0x76, 0x05,
+  0x4E, 0xDF, 0x91, 0x91, 0xFF, 0x7E,
+};
+const uint8_t dig6x8_rle_upright_offsets[] PROGMEM = {
+  0, 7, 14, 21, 28, 35, 42, 49, 56, 63, 70,
+};
+const FontDescriptor dig6x8_rle_upright = {dig6x8_rle_upright_columns, dig6x8_rle_upright_offsets, 48, 57, 8, false, true};
+
+const uint8_t dig6x8_rle_flipped_columns[] PROGMEM = {
+  0x05, 0x7E, 0xFF, 0x81, 0x81, 0xFF, 0x7E, 0x05, 0x00, 0x41, 0xFF, 0xFF, 0x01, 0x00, 0x05, 0x43,
+  0xC7, 0x8D, 0x99, 0xF1, 0x61, 0x05, 0x42, 0xC3, 0x91, 0x91, 0xFF, 0x6E, 0x05, 0x1C, 0x3C, 0x64,
+  0xC4, 0xFF, 0xFF, 0x05, 0xF2, 0xF3, 0x91, 0x91, 0x9F, 0x8E, 0x05, 0x7E, 0xFF, 0x91, 0x91, 0xDF,
+  0x4E, 0x80, 0x80, 0x03, 0x8F, 0x9F, 0xF0, 0xE0, 0x05, 0x6E, 0xFF, 0x91, 0x91, 0xFF, 0x6E, 0x05,
+  0x72, 0xFB, 0x89, 0x89, 0xFF, 0x7E,
+};
+const uint8_t dig6x8_rle_flipped_offsets[] PROGMEM = {
+  0, 7, 14, 21, 28, 35, 42, 49, 56, 63, 70,
+};
+const FontDescriptor dig6x8_rle_flipped = {dig6x8_rle_flipped_columns, dig6x8_rle_flipped_offsets, 48, 57, 8, false, true};
@@ -0,0 +1,37 @@
+// font dweek_en_rle generated by tools/fontc.py from dweek_en.bdf, do not edit.
+//regenerate with: python3 tools/fontc.py -o test/test_font_rle/font_dweek_en_rle.h --name dweek_en_rle --first 0 --fixed --encoding rle test/test_font_rle/dweek_en.bdf
+//8 glyphs '0' to '7' (48 to 55), 8 rows, up to 10 columns wide
+//fixed stride: 89 bytes
+//raw: 76 column bytes + 9 index = 85 bytes, drawn straight from flash
+//rle: 83 encoded bytes + 9 index = 92 bytes, unpacked on every draw
+//rle encoded, 92 bytes per orientation.
+
+#pragma once
+
+#include <fonts.h>
+
+const uint8_t dweek_en_rle_upright_columns[] PROGMEM = {
+  0x08, 0x9C, 0x94, 0x94, 0xF4, 0x00, 0xFC, 0x80, 0x80, 0xFC, 0x09, 0xFC, 0x04, 0x3C, 0x04, 0xFC,
+  0x00, 0xFC, 0x84, 0x84, 0xFC, 0x80, 0x04, 0x07, 0xFC, 0x04, 0x04, 0x00, 0xFC, 0x80, 0x80, 0xFC,
+  0x09, 0xFC, 0x80, 0xF0, 0x80, 0xFC, 0x00, 0xFC, 0x94, 0x94, 0x84, 0x80, 0x04, 0x07, 0xFC, 0x04,
+  0x04, 0x00, 0xFC, 0x10, 0x10, 0xFC, 0x08, 0xFC, 0x24, 0x24, 0x04, 0x00, 0xFC, 0x24, 0x64, 0xBC,
+  0x08, 0x9C, 0x94, 0x94, 0xF4, 0x00, 0xFC, 0x24, 0x24, 0xFC, 0x05, 0x07, 0x05, 0x07, 0x00, 0xFF,
+  0xFF, 0x81, 0x81,
+};
+const uint8_t dweek_en_rle_upright_offsets[] PROGMEM = {
+  0, 10, 21, 32, 43, 54, 64, 74, 83,
+};
+const FontDescriptor dweek_en_rle_upright = {dweek_en_rle_upright_columns, dweek_en_rle_upright_offsets, 48, 55, 8, false, true};
+
+const uint8_t dweek_en_rle_flipped_columns[] PROGMEM = {
+  0x08, 0x39, 0x29, 0x29, 0x2F, 0x00, 0x3F, 0x01, 0x01, 0x3F, 0x09, 0x3F, 0x20, 0x3C, 0x20, 0x3F,
+  0x00, 0x3F, 0x21, 0x21, 0x3F, 0x80, 0x20, 0x07, 0x3F, 0x20, 0x20, 0x00, 0x3F, 0x01, 0x01, 0x3F,
+  0x09, 0x3F, 0x01, 0x0F, 0x01, 0x3F, 0x00, 0x3F, 0x29, 0x29, 0x21, 0x80, 0x20, 0x07, 0x3F, 0x20,
+  0x20, 0x00, 0x3F, 0x08, 0x08, 0x3F, 0x08, 0x3F, 0x24, 0x24, 0x20, 0x00, 0x3F, 0x24, 0x26, 0x3D,
+  0x08, 0x39, 0x29, 0x29, 0x2F, 0x00, 0x3F, 0x24, 0x24, 0x3F, 0x05, 0xE0, 0xA0, 0xE0, 0x00, 0xFF,
+  0xFF, 0x81, 0x81,
+};
+const uint8_t dweek_en_rle_flipped_offsets[] PROGMEM = {
+  0, 10, 21, 32, 43, 54, 64, 74, 83,
+};
+const FontDescriptor dweek_en_rle_flipped = {dweek_en_rle_flipped_columns, dweek_en_rle_flipped_offsets, 48, 55, 8, false, true};
@@ -0,0 +1,91 @@
+// font text_rle generated by tools/fontc.py from font.bdf, do not edit.
+//regenerate with: python3 tools/fontc.py -o test/test_font_rle/font_text_rle.h --name text_rle --first 0x20 --last 0x7E --height 7 --fixed --encoding rle test/test_font_rle/font.bdf
+//95 glyphs ' ' to '~' (32 to 126), 7 rows, up to 5 columns wide
+//fixed stride: 571 bytes
+//raw: 353 column bytes + 192 index = 545 bytes, drawn straight from flash
+//rle: 438 encoded bytes + 192 index = 630 bytes, unpacked on every draw
+//rle encoded, 630 bytes per orientation.
+
+#pragma once
+
+#include <fonts.h>
+
+const uint8_t text_rle_upright_columns[] PROGMEM = {
+  0x80, 0x00, 0x00, 0x5F, 0x02, 0x03, 0x00, 0x03, 0x04, 0x14, 0x3E, 0x14, 0x3E, 0x14, 0x03, 0x24,
+  0x6A, 0x2B, 0x12, 0x04, 0x63, 0x13, 0x08, 0x64, 0x63, 0x04, 0x36, 0x49, 0x56, 0x20, 0x50, 0x00,
+  0x03, 0x02, 0x1C, 0x22, 0x41, 0x02, 0x41, 0x22, 0x1C, 0x04, 0x28, 0x18, 0x0E, 0x18, 0x28, 0x80,
+  0x08, 0x02, 0x3E, 0x08, 0x08, 0x01, 0xB0, 0x70, 0x82, 0x08, 0x00, 0x40, 0x02, 0x60, 0x1C, 0x03,
+  0x03, 0x3E, 0x41, 0x41, 0x3E, 0x02, 0x42, 0x7F, 0x40, 0x03, 0x62, 0x51, 0x49, 0x46, 0x03, 0x22,
+  0x41, 0x49, 0x36, 0x03, 0x18, 0x14, 0x12, 0x7F, 0x03, 0x27, 0x45, 0x45, 0x39, 0x03, 0x3E, 0x49,
+  0x49, 0x32, 0x03, 0x61, 0x11, 0x09, 0x07, 0x03, 0x36, 0x49, 0x49, 0x36, 0x03, 0x26, 0x49, 0x49,
+  0x3E, 0x00, 0x44, 0x01, 0x80, 0x50, 0x02, 0x10, 0x28, 0x44, 0x81, 0x14, 0x02, 0x44, 0x28, 0x10,
+  0x03, 0x02, 0x59, 0x09, 0x06, 0x04, 0x3E, 0x49, 0x55, 0x5D, 0x0E, 0x03, 0x7E, 0x11, 0x11, 0x7E,
+  0x03, 0x7F, 0x49, 0x49, 0x36, 0x03, 0x3E, 0x41, 0x41, 0x22, 0x03, 0x7F, 0x41, 0x41, 0x3E, 0x03,
+  0x7F, 0x49, 0x49, 0x41, 0x03, 0x7F, 0x09, 0x09, 0x01, 0x03, 0x3E, 0x41, 0x49, 0x7A, 0x03, 0x7F,
+  0x08, 0x08, 0x7F, 0x02, 0x41, 0x7F, 0x41, 0x03, 0x30, 0x40, 0x41, 0x3F, 0x03, 0x7F, 0x08, 0x14,
+  0x63, 0x00, 0x7F, 0x81, 0x40, 0x04, 0x7F, 0x02, 0x0C, 0x02, 0x7F, 0x04, 0x7F, 0x04, 0x08, 0x10,
+  0x7F, 0x03, 0x3E, 0x41, 0x41, 0x3E, 0x03, 0x7F, 0x09, 0x09, 0x06, 0x03, 0x3E, 0x41, 0x41, 0xBE,
+  0x03, 0x7F, 0x09, 0x09, 0x76, 0x03, 0x26, 0x49, 0x49, 0x32, 0x80, 0x01, 0x02, 0x7F, 0x01, 0x01,
+  0x03, 0x3F, 0x40, 0x40, 0x3F, 0x04, 0x0F, 0x30, 0x40, 0x30, 0x0F, 0x04, 0x3F, 0x40, 0x38, 0x40,
+  0x3F, 0x04, 0x63, 0x14, 0x08, 0x14, 0x63, 0x04, 0x07, 0x08, 0x70, 0x08, 0x07, 0x03, 0x61, 0x51,
+  0x49, 0x47, 0x01, 0x7F, 0x41, 0x03, 0x01, 0x06, 0x18, 0x60, 0x01, 0x41, 0x7F, 0x02, 0x02, 0x01,
+  0x02, 0x82, 0x40, 0x01, 0x01, 0x02, 0x03, 0x20, 0x54, 0x54, 0x78, 0x03, 0x7F, 0x44, 0x44, 0x38,
+  0x03, 0x38, 0x44, 0x44, 0x28, 0x03, 0x38, 0x44, 0x44, 0x7F, 0x03, 0x38, 0x54, 0x54, 0x18, 0x02,
+  0x04, 0x7E, 0x05, 0x03, 0x98, 0xA4, 0xA4, 0x78, 0x03, 0x7F, 0x04, 0x04, 0x78, 0x02, 0x44, 0x7D,
+  0x40, 0x03, 0x40, 0x80, 0x84, 0x7D, 0x03, 0x7F, 0x10, 0x28, 0x44, 0x02, 0x41, 0x7F, 0x40, 0x04,
+  0x7C, 0x04, 0x7C, 0x04, 0x78, 0x03, 0x7C, 0x04, 0x04, 0x78, 0x03, 0x38, 0x44, 0x44, 0x38, 0x03,
+  0xFC, 0x24, 0x24, 0x18, 0x03, 0x18, 0x24, 0x24, 0xFC, 0x03, 0x7C, 0x08, 0x04, 0x04, 0x03, 0x48,
+  0x54, 0x54, 0x24, 0x02, 0x04, 0x3F, 0x44, 0x03, 0x3C, 0x40, 0x40, 0x7C, 0x04, 0x1C, 0x20, 0x40,
+  0x20, 0x1C, 0x04, 0x3C, 0x40, 0x3C, 0x40, 0x3C, 0x04, 0x44, 0x28, 0x10, 0x28, 0x44, 0x03, 0x9C,
+  0xA0, 0xA0, 0x7C, 0x02, 0x64, 0x54, 0x4C, 0x02, 0x08, 0x36, 0x41, 0x00, 0x7F, 0x02, 0x41, 0x36,
+  0x08, 0x03, 0x08, 0x04, 0x08, 0x04,
+};
+const uint16_t text_rle_upright_offsets[] PROGMEM = {
+  0, 2, 4, 8, 14, 19, 25, 31, 33, 37, 41, 47, 53, 56, 58, 60,
+  64, 69, 73, 78, 83, 88, 93, 98, 103, 108, 113, 115, 118, 122, 124, 128,
+  133, 139, 144, 149, 154, 159, 164, 169, 174, 179, 183, 188, 193, 197, 203, 209,
+  214, 219, 224, 229, 234, 240, 245, 251, 257, 263, 269, 274, 277, 282, 285, 289,
+  291, 294, 299, 304, 309, 314, 319, 323, 328, 333, 337, 342, 347, 351, 357, 362,
+  367, 372, 377, 382, 387, 391, 396, 402, 408, 414, 419, 423, 427, 429, 433, 438,
+};
+const FontDescriptor text_rle_upright = {text_rle_upright_columns, text_rle_upright_offsets, 32, 126, 7, true, true};
+
+const uint8_t text_rle_flipped_columns[] PROGMEM = {
+  0x80, 0x00, 0x00, 0xFA, 0x02, 0xC0, 0x00, 0xC0, 0x04, 0x28, 0x7C, 0x28, 0x7C, 0x28, 0x03, 0x24,
+  0x56, 0xD4, 0x48, 0x04, 0xC6, 0xC8, 0x10, 0x26, 0xC6, 0x04, 0x6C, 0x92, 0x6A, 0x04, 0x0A, 0x00,
+  0xC0, 0x02, 0x38, 0x44, 0x82, 0x02, 0x82, 0x44, 0x38, 0x04, 0x14, 0x18, 0x70, 0x18, 0x14, 0x80,
+  0x10, 0x02, 0x7C, 0x10, 0x10, 0x01, 0x0D, 0x0E, 0x82, 0x10, 0x00, 0x02, 0x02, 0x06, 0x38, 0xC0,
+  0x03, 0x7C, 0x82, 0x82, 0x7C, 0x02, 0x42, 0xFE, 0x02, 0x03, 0x46, 0x8A, 0x92, 0x62, 0x03, 0x44,
+  0x82, 0x92, 0x6C, 0x03, 0x18, 0x28, 0x48, 0xFE, 0x03, 0xE4, 0xA2, 0xA2, 0x9C, 0x03, 0x7C, 0x92,
+  0x92, 0x4C, 0x03, 0x86, 0x88, 0x90, 0xE0, 0x03, 0x6C, 0x92, 0x92, 0x6C, 0x03, 0x64, 0x92, 0x92,
+  0x7C, 0x00, 0x22, 0x01, 0x01, 0x0A, 0x02, 0x08, 0x14, 0x22, 0x81, 0x28, 0x02, 0x22, 0x14, 0x08,
+  0x03, 0x40, 0x9A, 0x90, 0x60, 0x04, 0x7C, 0x92, 0xAA, 0xBA, 0x70, 0x03, 0x7E, 0x88, 0x88, 0x7E,
+  0x03, 0xFE, 0x92, 0x92, 0x6C, 0x03, 0x7C, 0x82, 0x82, 0x44, 0x03, 0xFE, 0x82, 0x82, 0x7C, 0x03,
+  0xFE, 0x92, 0x92, 0x82, 0x03, 0xFE, 0x90, 0x90, 0x80, 0x03, 0x7C, 0x82, 0x92, 0x5E, 0x03, 0xFE,
+  0x10, 0x10, 0xFE, 0x02, 0x82, 0xFE, 0x82, 0x03, 0x0C, 0x02, 0x82, 0xFC, 0x03, 0xFE, 0x10, 0x28,
+  0xC6, 0x00, 0xFE, 0x81, 0x02, 0x04, 0xFE, 0x40, 0x30, 0x40, 0xFE, 0x04, 0xFE, 0x20, 0x10, 0x08,
+  0xFE, 0x03, 0x7C, 0x82, 0x82, 0x7C, 0x03, 0xFE, 0x90, 0x90, 0x60, 0x03, 0x7C, 0x82, 0x82, 0x7D,
+  0x03, 0xFE, 0x90, 0x90, 0x6E, 0x03, 0x64, 0x92, 0x92, 0x4C, 0x80, 0x80, 0x02, 0xFE, 0x80, 0x80,
+  0x03, 0xFC, 0x02, 0x02, 0xFC, 0x04, 0xF0, 0x0C, 0x02, 0x0C, 0xF0, 0x04, 0xFC, 0x02, 0x1C, 0x02,
+  0xFC, 0x04, 0xC6, 0x28, 0x10, 0x28, 0xC6, 0x04, 0xE0, 0x10, 0x0E, 0x10, 0xE0, 0x03, 0x86, 0x8A,
+  0x92, 0xE2, 0x01, 0xFE, 0x82, 0x03, 0x80, 0x60, 0x18, 0x06, 0x01, 0x82, 0xFE, 0x02, 0x40, 0x80,
+  0x40, 0x82, 0x02, 0x01, 0x80, 0x40, 0x03, 0x04, 0x2A, 0x2A, 0x1E, 0x03, 0xFE, 0x22, 0x22, 0x1C,
+  0x03, 0x1C, 0x22, 0x22, 0x14, 0x03, 0x1C, 0x22, 0x22, 0xFE, 0x03, 0x1C, 0x2A, 0x2A, 0x18, 0x02,
+  0x20, 0x7E, 0xA0, 0x03, 0x19, 0x25, 0x25, 0x1E, 0x03, 0xFE, 0x20, 0x20, 0x1E, 0x02, 0x22, 0xBE,
+  0x02, 0x03, 0x02, 0x01, 0x21, 0xBE, 0x03, 0xFE, 0x08, 0x14, 0x22, 0x02, 0x82, 0xFE, 0x02, 0x04,
+  0x3E, 0x20, 0x3E, 0x20, 0x1E, 0x03, 0x3E, 0x20, 0x20, 0x1E, 0x03, 0x1C, 0x22, 0x22, 0x1C, 0x03,
+  0x3F, 0x24, 0x24, 0x18, 0x03, 0x18, 0x24, 0x24, 0x3F, 0x03, 0x3E, 0x10, 0x20, 0x20, 0x03, 0x12,
+  0x2A, 0x2A, 0x24, 0x02, 0x20, 0xFC, 0x22, 0x03, 0x3C, 0x02, 0x02, 0x3E, 0x04, 0x38, 0x04, 0x02,
+  0x04, 0x38, 0x04, 0x3C, 0x02, 0x3C, 0x02, 0x3C, 0x04, 0x22, 0x14, 0x08, 0x14, 0x22, 0x03, 0x39,
+  0x05, 0x05, 0x3E, 0x02, 0x26, 0x2A, 0x32, 0x02, 0x10, 0x6C, 0x82, 0x00, 0xFE, 0x02, 0x82, 0x6C,
+  0x10, 0x03, 0x10, 0x20, 0x10, 0x20,
+};
+const uint16_t text_rle_flipped_offsets[] PROGMEM = {
+  0, 2, 4, 8, 14, 19, 25, 31, 33, 37, 41, 47, 53, 56, 58, 60,
+  64, 69, 73, 78, 83, 88, 93, 98, 103, 108, 113, 115, 118, 122, 124, 128,
+  133, 139, 144, 149, 154, 159, 164, 169, 174, 179, 183, 188, 193, 197, 203, 209,
+  214, 219, 224, 229, 234, 240, 245, 251, 257, 263, 269, 274, 277, 282, 285, 289,
+  291, 294, 299, 304, 309, 314, 319, 323, 328, 333, 337, 342, 347, 351, 357, 362,
+  367, 372, 377, 382, 387, 391, 396, 402, 408, 414, 419, 423, 427, 429, 433, 438,
+};
+const FontDescriptor text_rle_flipped = {text_rle_flipped_columns, text_rle_flipped_offsets, 32, 126, 7, true, true};
@@ -0,0 +1,117 @@
+// host tests for run-length encoded fonts: every glyph of the fonts tools/fontc.py encoded from the .bdf files here
+//unpacks to the columns of the fixed-stride table in fonts.h they were made from, and text drawn with them gives the
+//framebuffer the raw fonts give. the .bdf files are those tables with one column per byte.
+
+#include <Arduino.h>
+#include <text_layout.h>
+#include <stdlib.h>
+#include <unity.h>
+#include "font_text_rle.h"
+#include "font_dig6x8_rle.h"
+#include "font_dweek_en_rle.h"
+
+struct TestDisplay {
+  static constexpr int16_t num_columns = 32;
+  uint8_t columns[num_columns] = {};
+  uint8_t &column(int x) { return columns[x]; }
+  uint8_t *columnRun(int x, int &length)
+  {
+    length = num_columns - x;
+    return columns + x;
+  }
+};
+
+//checks the upright and flipped encoding of a table from glyph number first_glyph on against the table.
+static void checkRoundTrip(const FontDescriptor &upright, const FontDescriptor &flipped, const uint8_t *table,
+                           uint8_t first_glyph, uint8_t first, uint8_t last)
+{
+  TEST_ASSERT_TRUE(upright.rle);
+  TEST_ASSERT_TRUE(flipped.rle);
+  TEST_ASSERT_EQUAL(first, upright.first);
+  TEST_ASSERT_EQUAL(last, upright.last);
+  TEST_ASSERT_EQUAL(first, flipped.first);
+  TEST_ASSERT_EQUAL(last, flipped.last);
+  uint8_t stride = table[0];
+  for(int code = first; code <= last; code++) {
+    const uint8_t *source = table + 1 + (code - first + first_glyph) * stride;
+    uint8_t upright_columns[FONT_MAX_GLYPH_WIDTH];
+    uint8_t flipped_columns[FONT_MAX_GLYPH_WIDTH];
+    uint8_t upright_width, flipped_width, width;
+    TEST_ASSERT_TRUE(fontGlyphColumns(upright, code, upright_columns, upright_width));
+    TEST_ASSERT_TRUE(fontGlyphColumns(flipped, code, flipped_columns, flipped_width));
+    TEST_ASSERT_EQUAL(source[0], upright_width);
+    TEST_ASSERT_EQUAL(source[0], flipped_width);
+    for(uint8_t column = 0; column < upright_width; column++) {
+      TEST_ASSERT_EQUAL(source[1 + column], upright_columns[column]);
+      TEST_ASSERT_EQUAL(fontReverseBits(source[1 + column]), flipped_columns[column]);
+    }
+    TEST_ASSERT_TRUE(fontGlyphWidth(upright, code, width));
+    TEST_ASSERT_EQUAL(source[0], width);
+    //encoded glyphs have no plain columns to point at
+    const uint8_t *columns;
+    TEST_ASSERT_FALSE(fontGlyph(upright, code, columns, width));
+  }
+  uint8_t columns[FONT_MAX_GLYPH_WIDTH];
+  uint8_t width;
+  TEST_ASSERT_FALSE(fontGlyphColumns(upright, first - 1, columns, width));
+  TEST_ASSERT_FALSE(fontGlyphColumns(upright, last + 1, columns, width));
+}
+
+void setUp()
+{
+  srand(1);
+}
+
+void tearDown() {}
+
+void test_text_font_round_trips()
+{
+  checkRoundTrip(text_rle_upright, text_rle_flipped, font, ' ', ' ', '~');
+}
+
+void test_digit_font_round_trips()
+{
+  checkRoundTrip(dig6x8_rle_upright, dig6x8_rle_flipped, dig6x8, 0, '0', '9');
+}
+
+//the day names are up to 10 columns wide, with repeats both at the start of a glyph and after a literal.
+void test_wide_font_round_trips()
+{
+  checkRoundTrip(dweek_en_rle_upright, dweek_en_rle_flipped, dweek_en, 0, '0', '7');
+}
+
+//random strings laid out in the raw text font, drawn with it and with the encoded one at random offsets and clips.
+void test_render_matches_raw_font()
+{
+  for(int test = 0; test < 2000; test++) {
+    char string[10];
+    uint8_t length = rand() % sizeof(string);
+    for(uint8_t i = 0; i < length; i++) {
+      string[i] = ' ' + rand() % ('~' - ' ' + 1);
+    }
+    string[length] = '\0';
+    TextLayout text_layout;
+    text_layout.layout(font_upright, string);
+    int16_t x = rand() % 48 - 16;
+    int16_t clip_left = rand() % 36 - 2;
+    int16_t clip_right = rand() % 36 - 2;
+    bool reversed = rand() % 2;
+    TestDisplay expected, actual;
+    for(int column = 0; column < TestDisplay::num_columns; column++) {
+      expected.columns[column] = actual.columns[column] = rand();
+    }
+    text_layout.render(reversed ? font_flipped : font_upright, expected, x, reversed, clip_left, clip_right);
+    text_layout.render(reversed ? text_rle_flipped : text_rle_upright, actual, x, reversed, clip_left, clip_right);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected.columns, actual.columns, TestDisplay::num_columns, string);
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_text_font_round_trips);
+  RUN_TEST(test_digit_font_round_trips);
+  RUN_TEST(test_wide_font_round_trips);
+  RUN_TEST(test_render_matches_raw_font);
+  return UNITY_END();
+}
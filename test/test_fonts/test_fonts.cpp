@@ -0,0 +1,229 @@
+// host tests for the packed fonts: the flipped glyphs are the upright ones with their bits reversed, and drawing text
+//with them gives the framebuffer the old per-column reverse() blit gave, which is also benchmarked against it, and
+//gives the same framebuffer when it is a ring that wraps.
+
+#include <Arduino.h>
+#include <text_layout.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+
+//a framebuffer with one column per byte and the 8 spare columns the old scr[] had after the display.
+struct TestDisplay {
+  static constexpr int16_t num_columns = 32;
+  uint8_t columns[num_columns + 8] = {};
+  uint8_t &column(int16_t x) { return columns[x]; }
+  uint8_t *columnRun(int x, int &length)
+  {
+    length = num_columns + 8 - x;
+    return columns + x;
+  }
+};
+
+//the same framebuffer in a ring that starts at head, like the scrolling Max7219Display's, so a run of columns can wrap
+//around its end.
+struct WrappedDisplay {
+  static constexpr int16_t num_columns = 32;
+  uint8_t ring[64] = {};
+  int head = 0;
+  uint8_t &column(int16_t x) { return ring[(head + x) & 63]; }
+  uint8_t *columnRun(int x, int &length)
+  {
+    int index = (head + x) & 63;
+    length = 64 - index;
+    return ring + index;
+  }
+};
+
+//the old reverse() and render_font_char_to_buffer(), drawing right to left from the raw font table.
+static unsigned char lookup[16] = {0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe, 0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf};
+
+static uint8_t reverse(uint8_t n)
+{
+  return (lookup[n & 0b1111] << 4) | lookup[n >> 4];
+}
+
+__attribute__((noinline)) static void oldRender(const char *string, int x_offset, uint8_t *scr)
+{
+  uint16_t row_count = TestDisplay::num_columns;
+  uint8_t font_data_width = pgm_read_byte(font);
+  size_t character_offset = 0;
+  char character;
+  while((character = string[character_offset]) != '\0') {
+    size_t font_data_offset = 1 + (font_data_width * character);
+    uint8_t font_char_width = pgm_read_byte(font + font_data_offset);
+    uint8_t font_char_column = 0;
+    while(font_char_column < font_char_width) {
+      uint8_t offset = row_count - (x_offset + font_char_column + 1);
+      if(offset >= TestDisplay::num_columns + 8) {
+        break;
+      }
+      scr[offset] = reverse(pgm_read_byte(font + font_data_offset + 1 + font_char_column));
+      font_char_column++;
+    }
+    x_offset += font_char_width + 1;
+    character_offset++;
+  }
+}
+
+__attribute__((noinline)) static void newBlit(const TextLayout &text_layout, TestDisplay &target)
+{
+  text_layout.render(font_flipped, target, 0, true);
+}
+
+__attribute__((noinline)) static void newRender(const char *string, TestDisplay &target)
+{
+  TextLayout text_layout;
+  text_layout.layout(font_upright, string);
+  newBlit(text_layout, target);
+}
+
+static void checkFlippedPair(const FontDescriptor &upright, const FontDescriptor &flipped, const uint8_t *table,
+                             uint8_t first_glyph)
+{
+  TEST_ASSERT_EQUAL(upright.first, flipped.first);
+  TEST_ASSERT_EQUAL(upright.last, flipped.last);
+  uint8_t stride = table[0];
+  for(int code = upright.first; code <= upright.last; code++) {
+    const uint8_t *upright_columns;
+    const uint8_t *flipped_columns;
+    uint8_t upright_width, flipped_width;
+    TEST_ASSERT_TRUE(fontGlyph(upright, code, upright_columns, upright_width));
+    TEST_ASSERT_TRUE(fontGlyph(flipped, code, flipped_columns, flipped_width));
+    //the packed glyph is the one in the fixed-stride table, without its padding
+    const uint8_t *source = table + 1 + (code - upright.first + first_glyph) * stride;
+    TEST_ASSERT_EQUAL(source[0], upright_width);
+    TEST_ASSERT_EQUAL(upright_width, flipped_width);
+    for(uint8_t column = 0; column < upright_width; column++) {
+      TEST_ASSERT_EQUAL(source[1 + column], upright_columns[column]);
+      TEST_ASSERT_EQUAL(reverse(upright_columns[column]), flipped_columns[column]);
+    }
+  }
+}
+
+void setUp()
+{
+  srand(1);
+}
+
+void tearDown() {}
+
+void test_flipped_glyphs_are_bit_reversed()
+{
+  checkFlippedPair(font_upright, font_flipped, font, ' ');
+  checkFlippedPair(dig3x8_upright, dig3x8_flipped, dig3x8, 0);
+  checkFlippedPair(dig6x8_upright, dig6x8_flipped, dig6x8, 0);
+  checkFlippedPair(dig4x8_upright, dig4x8_flipped, dig4x8, 0);
+  checkFlippedPair(dig3x7_upright, dig3x7_flipped, dig3x7, 0);
+  checkFlippedPair(dig3x6_upright, dig3x6_flipped, dig3x6, 0);
+  checkFlippedPair(dig3x5_upright, dig3x5_flipped, dig3x5, 0);
+  checkFlippedPair(dig5x8rn_upright, dig5x8rn_flipped, dig5x8rn, 0);
+  checkFlippedPair(dig5x8sq_upright, dig5x8sq_flipped, dig5x8sq, 0);
+  for(int column = 0; column < 256; column++) {
+    TEST_ASSERT_EQUAL(reverse(column), fontReverseBits(column));
+  }
+}
+
+//random printable strings, some too long for the display, drawn both ways into framebuffers full of junk.
+void test_reversed_render_matches_old_blit()
+{
+  for(int test = 0; test < 2000; test++) {
+    char string[12];
+    uint8_t length = rand() % (sizeof(string) - 1);
+    for(uint8_t i = 0; i < length; i++) {
+      string[i] = ' ' + rand() % ('~' - ' ' + 1);
+    }
+    string[length] = '\0';
+    TestDisplay expected, actual;
+    for(uint8_t i = 0; i < sizeof(expected.columns); i++) {
+      expected.columns[i] = actual.columns[i] = rand();
+    }
+    oldRender(string, 0, expected.columns);
+    newRender(string, actual);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected.columns, actual.columns, sizeof(expected.columns), string);
+  }
+}
+
+//random layouts, offsets and clips drawn both ways into a flat framebuffer and into rings wrapping at every place.
+void test_wrapped_framebuffer_matches_flat()
+{
+  for(int test = 0; test < 5000; test++) {
+    char string[8];
+    uint8_t length = rand() % sizeof(string);
+    for(uint8_t i = 0; i < length; i++) {
+      string[i] = ' ' + rand() % ('~' - ' ' + 1);
+    }
+    string[length] = '\0';
+    TextLayout text_layout;
+    text_layout.layout(font_upright, string);
+    int16_t x = rand() % 48 - 16;
+    int16_t clip_left = rand() % 40 - 4;
+    int16_t clip_right = rand() % 40 - 4;
+    bool reversed = rand() % 2;
+    TestDisplay expected;
+    WrappedDisplay actual;
+    actual.head = rand() % 64;
+    for(int column = 0; column < TestDisplay::num_columns; column++) {
+      expected.columns[column] = actual.column(column) = rand();
+    }
+    text_layout.render(reversed ? font_flipped : font_upright, expected, x, reversed, clip_left, clip_right);
+    text_layout.render(reversed ? font_flipped : font_upright, actual, x, reversed, clip_left, clip_right);
+    for(int column = 0; column < TestDisplay::num_columns; column++) {
+      TEST_ASSERT_EQUAL_MESSAGE(expected.columns[column], actual.column(column), string);
+    }
+  }
+}
+
+//the time per call of the fastest of many short runs of draw, so work the host does in between does not count.
+template <class Draw>
+static double fastestRun(Draw draw)
+{
+  double fastest = 0;
+  for(int run = 0; run < 2000; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < 1000; i++) {
+      draw();
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 1000;
+    if(run == 0 || ns < fastest) {
+      fastest = ns;
+    }
+  }
+  return fastest;
+}
+
+//prints the cost of drawing the clock's time string: the old blit, a new layout and render, and only the render of a
+//layout that was kept, as the clock face does while the text stays the same.
+void test_benchmark_glyph_blit()
+{
+  TestDisplay display;
+  TextLayout text_layout;
+  text_layout.layout(font_upright, "12:34:56");
+  double old_ns = fastestRun([&] {
+    oldRender("12:34:56", 0, display.columns);
+    asm volatile("" : : "r"(display.columns) : "memory");
+  });
+  double new_ns = fastestRun([&] {
+    newRender("12:34:56", display);
+    asm volatile("" : : "r"(display.columns) : "memory");
+  });
+  double blit_ns = fastestRun([&] {
+    newBlit(text_layout, display);
+    asm volatile("" : : "r"(display.columns) : "memory");
+  });
+  char message[160];
+  snprintf(message, sizeof(message), "\"12:34:56\": reverse() blit %.1f ns, layout and render %.1f ns, "
+           "render of a kept layout %.1f ns per frame", old_ns, new_ns, blit_ns);
+  TEST_MESSAGE(message);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_flipped_glyphs_are_bit_reversed);
+  RUN_TEST(test_reversed_render_matches_old_blit);
+  RUN_TEST(test_wrapped_framebuffer_matches_flat);
+  RUN_TEST(test_benchmark_glyph_blit);
+  return UNITY_END();
+}
@@ -0,0 +1,236 @@
+// host tests for the MAX7219 rotation kernels and refresh paths.
+//the kernels are checked bit for bit against the bit loops the display code used before them.
+
+#include <Arduino.h>
+#include <max7219.h>
+#include <max7219_chain.h>
+#include <chrono>
+#include <stdio.h>
+#include <unity.h>
+
+//the old refreshAllRot90() inner loops, for the 8 columns of one chip.
+static void bitLoopRot90(const uint8_t *columns, uint8_t *rows)
+{
+  byte mask = 0x80;
+  for(int c = 0; c < 8; c++) {
+    byte bt = 0;
+    for(int b = 0; b < 8; b++) {
+      bt >>= 1;
+      if(columns[b] & mask) bt |= 0x80;
+    }
+    rows[c] = bt;
+    mask >>= 1;
+  }
+}
+
+//the old refreshAllRot270() inner loops.
+static void bitLoopRot270(const uint8_t *columns, uint8_t *rows)
+{
+  byte mask = 0x01;
+  for(int c = 0; c < 8; c++) {
+    byte bt = 0;
+    for(int b = 0; b < 8; b++) {
+      bt <<= 1;
+      if(columns[b] & mask) bt |= 0x01;
+    }
+    rows[c] = bt;
+    mask <<= 1;
+  }
+}
+
+//the rows the old code would have sent for a chip at rotation. 180 degrees is 90 degrees twice.
+static void bitLoopRows(uint16_t rotation, bool mirror, const uint8_t *columns, uint8_t *rows)
+{
+  uint8_t turned[8];
+  if(rotation == 90) {
+    bitLoopRot90(columns, turned);
+  } else if(rotation == 270) {
+    bitLoopRot270(columns, turned);
+  } else if(rotation == 180) {
+    uint8_t once[8];
+    bitLoopRot90(columns, once);
+    bitLoopRot90(once, turned);
+  } else {
+    memcpy(turned, columns, 8);
+  }
+  for(int c = 0; c < 8; c++) {
+    rows[c] = turned[mirror ? 7 - c : c];
+  }
+}
+
+struct NullTransport {
+  void begin() {}
+  void send(const uint8_t *, size_t) {}
+};
+
+template <uint16_t Rotation, bool Mirror>
+static void checkKernel()
+{
+  Max7219Display<4, Rotation, NullTransport, Mirror> display{NullTransport()};
+  srand(Rotation + Mirror);
+  for(int frame = 0; frame < 20000; frame++) {
+    //scroll now and then, so chips straddling the end of the ring are covered too
+    if(frame % 7 == 0) display.scrollLeft();
+    uint8_t columns[32];
+    for(int x = 0; x < 32; x++) {
+      columns[x] = display.column(x) = rand();
+    }
+    for(int addr = 0; addr < 4; addr++) {
+      uint8_t expected[8], rows[8];
+      bitLoopRows(Rotation, Mirror, columns + addr * 8, expected);
+      display.chipRows(addr, rows);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, rows, 8);
+    }
+  }
+}
+
+void test_kernel_rotation_0() { checkKernel<0, false>(); checkKernel<0, true>(); }
+void test_kernel_rotation_90() { checkKernel<90, false>(); checkKernel<90, true>(); }
+void test_kernel_rotation_180() { checkKernel<180, false>(); checkKernel<180, true>(); }
+void test_kernel_rotation_270() { checkKernel<270, false>(); checkKernel<270, true>(); }
+
+//whatever was drawn and refreshed, every chip must end up showing its chipRows().
+template <uint16_t Rotation>
+static void checkChainMatches(Max7219Display<4, Rotation, Max7219ChainTransport<4>> &display, Max7219Chain<4> &chain)
+{
+  for(int addr = 0; addr < 4; addr++) {
+    uint8_t rows[8];
+    display.chipRows(addr, rows);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(rows, chain.digits[addr], 8);
+  }
+}
+
+void test_refresh_paths_keep_the_chips_in_sync()
+{
+  Max7219Chain<4> chain;
+  Max7219Display<4, 90, Max7219ChainTransport<4>> display{Max7219ChainTransport<4>(chain)};
+  display.begin();
+  checkChainMatches(display, chain);
+  srand(3);
+  for(int step = 0; step < 5000; step++) {
+    int x = rand() % 32;
+    display.column(x) = rand();
+    switch(step % 4) {
+      case 0: display.refreshAll(); break;
+      case 1: display.refresh(x / 8); break;
+      case 2: display.markDirty(x, x + 1); display.refreshDirty(); break;
+      case 3: display.scrollLeft(); display.refreshAll(); break;
+    }
+    checkChainMatches(display, chain);
+  }
+}
+
+void test_unchanged_frame_sends_nothing()
+{
+  Max7219Chain<4> chain;
+  Max7219Display<4, 90, Max7219ChainTransport<4>> display{Max7219ChainTransport<4>(chain)};
+  display.begin();
+  for(int x = 0; x < 32; x++) display.column(x) = x * 37;
+  display.refreshAll();
+  uint32_t bytes = chain.bytes;
+  display.refreshAll();
+  TEST_ASSERT_EQUAL_UINT32(bytes, chain.bytes);
+  //one changed column changes one bit in every row of its chip, which takes 8 frames
+  display.column(5) ^= 0xFF;
+  display.refreshAll();
+  TEST_ASSERT_EQUAL_UINT32(bytes + 8 * 8, chain.bytes);
+}
+
+//hands out the bytes of a banner one per call, longer than the framebuffer ring so the ring wraps several times.
+struct Banner {
+  uint8_t bytes[200];
+  int next = 0;
+};
+
+static uint8_t nextBannerColumn(void *context)
+{
+  Banner *banner = (Banner *)context;
+  return banner->bytes[banner->next++];
+}
+
+void test_column_source_scrolls_in()
+{
+  typedef Max7219Display<4, 90, NullTransport> Display;
+  Display display{NullTransport()};
+  uint8_t start[Display::num_columns];
+  for(int x = 0; x < Display::num_columns; x++) {
+    start[x] = display.column(x) = 0x80 | x;
+  }
+  Banner banner;
+  for(int i = 0; i < 200; i++) {
+    banner.bytes[i] = i + 1;
+  }
+  display.setColumnSource(nextBannerColumn, &banner);
+  for(int scrolled = 1; scrolled <= 200; scrolled++) {
+    display.scrollLeft();
+    TEST_ASSERT_EQUAL(scrolled, banner.next);
+    //the columns that were there move left, the banner comes in from the right
+    for(int x = 0; x < Display::num_columns; x++) {
+      int from_start = x + scrolled;
+      uint8_t expected = from_start < Display::num_columns ? start[from_start]
+                                                           : banner.bytes[from_start - Display::num_columns];
+      TEST_ASSERT_EQUAL(expected, display.column(x));
+    }
+    //the column that scrolled off wrapped around to the end of the ring blank, and the look-ahead stays blank
+    for(int x = Display::num_columns; x < Display::ring_size; x++) {
+      TEST_ASSERT_EQUAL(0, display.column(x));
+    }
+  }
+  //without a source the look-ahead scrolls in, which is blank by now
+  display.setColumnSource(nullptr);
+  display.scrollLeft();
+  TEST_ASSERT_EQUAL(200, banner.next);
+  TEST_ASSERT_EQUAL(banner.bytes[199], display.column(Display::num_columns - 2));
+  TEST_ASSERT_EQUAL(0, display.column(Display::num_columns - 1));
+}
+
+//prints how long building all the rows of a 4-chip frame takes with the bit loops and with the kernels.
+void test_benchmark_kernels()
+{
+  const int frames = 200000;
+  uint8_t columns[32];
+  uint8_t rows[8];
+  volatile uint8_t sink = 0;
+  Max7219Display<4, 90, NullTransport> display{NullTransport()};
+
+  auto start = std::chrono::steady_clock::now();
+  for(int frame = 0; frame < frames; frame++) {
+    columns[frame & 31] = frame;
+    for(int addr = 0; addr < 4; addr++) {
+      bitLoopRot90(columns + addr * 8, rows);
+      sink += rows[frame & 7];
+    }
+  }
+  double bit_loop_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+  start = std::chrono::steady_clock::now();
+  for(int frame = 0; frame < frames; frame++) {
+    display.column(frame & 31) = frame;
+    for(int addr = 0; addr < 4; addr++) {
+      display.chipRows(addr, rows);
+      sink += rows[frame & 7];
+    }
+  }
+  double kernel_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+  char message[120];
+  snprintf(message, sizeof(message), "rotate 4 chips at 90 degrees: bit loops %.1f ns, kernel %.1f ns", bit_loop_ns, kernel_ns);
+  TEST_MESSAGE(message);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_kernel_rotation_0);
+  RUN_TEST(test_kernel_rotation_90);
+  RUN_TEST(test_kernel_rotation_180);
+  RUN_TEST(test_kernel_rotation_270);
+  RUN_TEST(test_refresh_paths_keep_the_chips_in_sync);
+  RUN_TEST(test_unchanged_frame_sends_nothing);
+  RUN_TEST(test_column_source_scrolls_in);
+  RUN_TEST(test_benchmark_kernels);
+  return UNITY_END();
+}
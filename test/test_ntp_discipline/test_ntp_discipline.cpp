@@ -0,0 +1,144 @@
+// host tests for the clock discipline: the drift of a skewed local crystal is measured and corrected between syncs,
+//offsets above NTP_STEP_THRESHOLD step the clock and smaller ones are slewed out at up to NTP_MAX_SLEW_PPM.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <fake_udp.h>
+#include <stdio.h>
+#include <unity.h>
+
+static long long clockError(FakeUdp &udp, NTPClient &client)
+{
+  return (long long)client.getEpochMillis() - (long long)udp.trueMillis();
+}
+
+static void addServer(FakeUdp &udp)
+{
+  udp.servers.push_back({"only", IPAddress(10, 0, 0, 1), 0, 10, 10, true});
+}
+
+void setUp()
+{
+  host_millis = 10000;
+}
+
+void tearDown() {}
+
+//a crystal 40 ppm slow, synced every 1024 s: the estimate settles near the skew and the clock stays within a few ms
+//across a whole interval.
+void test_drift_converges_to_the_skew()
+{
+  FakeUdp udp;
+  udp.skew_ppb = 40000;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, 64000UL);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_EQUAL(0, client.getDriftPpb());
+  long long worst_error = 0;
+  for(int sync = 0; sync < 20; sync++) {
+    for(int step = 0; step < 16; step++) {
+      host_millis += 64000;
+      long long error = clockError(udp, client);
+      if(sync >= 10 && (error > worst_error || -error > worst_error)) {
+        worst_error = error > 0 ? error : -error;
+      }
+    }
+    TEST_ASSERT_TRUE(client.forceUpdate());
+  }
+  char message[120];
+  snprintf(message, sizeof(message), "40 ppm slow crystal: drift estimate %ld ppb, worst error after settling %lld ms",
+           client.getDriftPpb(), worst_error);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_INT_WITHIN(2000, 40000, client.getDriftPpb());
+  TEST_ASSERT_LESS_OR_EQUAL(4, worst_error);
+}
+
+//the first measurement is taken as it is, later ones move the estimate a quarter of the way.
+void test_later_measurements_weigh_a_quarter()
+{
+  FakeUdp udp;
+  udp.skew_ppb = 100000;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, 64000UL);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  //closer together than NTP_MIN_DRIFT_INTERVAL there is no measurement
+  host_millis += NTP_MIN_DRIFT_INTERVAL - 1000;
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_EQUAL(0, client.getDriftPpb());
+  host_millis += 1000000;
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_INT_WITHIN(2000, 100000, client.getDriftPpb());
+  long first = client.getDriftPpb();
+  //the crystal warms up and is now 20 ppm slow, the estimate moves a quarter of the 80 ppm difference
+  unsigned long long true_now = udp.trueMillis();
+  udp.skew_ppb = 20000;
+  udp.true_base_ms = true_now - millis() - (long long)millis() * udp.skew_ppb / 1000000000LL;
+  host_millis += 1000000;
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_INT_WITHIN(2000, first - (first - 20000) / 4, client.getDriftPpb());
+}
+
+//a crystal further off than NTP_MAX_DRIFT_PPB is only corrected up to that.
+void test_drift_is_clamped()
+{
+  FakeUdp udp;
+  udp.skew_ppb = 900000;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, 64000UL);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  host_millis += 300000;
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_EQUAL(NTP_MAX_DRIFT_PPB, client.getDriftPpb());
+}
+
+//an offset over the threshold is taken at once.
+void test_large_offset_steps()
+{
+  FakeUdp udp;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, 64000UL);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  host_millis += 64000;
+  udp.true_base_ms += NTP_STEP_THRESHOLD + 72;
+  TEST_ASSERT_INT_WITHIN(2, -(NTP_STEP_THRESHOLD + 72), clockError(udp, client));
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_INT_WITHIN(2, 0, clockError(udp, client));
+}
+
+//an offset under the threshold is slewed: the clock never jumps, runs at most NTP_MAX_SLEW_PPM fast while it catches
+//up, and is right once the offset has been worked off.
+void test_small_offset_slews()
+{
+  FakeUdp udp;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, 64000UL);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  host_millis += 64000;
+  const long offset = NTP_STEP_THRESHOLD - 28;
+  udp.true_base_ms += offset;
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_INT_WITHIN(2, -offset, clockError(udp, client));
+  unsigned long long last = client.getEpochMillis();
+  unsigned long slew_time = offset * 1000000UL / NTP_MAX_SLEW_PPM;
+  for(unsigned long elapsed = 0; elapsed < slew_time + 10000; elapsed += 1000) {
+    host_millis += 1000;
+    unsigned long long now = client.getEpochMillis();
+    TEST_ASSERT_GREATER_OR_EQUAL(1000, (long)(now - last));
+    TEST_ASSERT_LESS_OR_EQUAL(1000 + 1000 * NTP_MAX_SLEW_PPM / 1000000 + 1, (long)(now - last));
+    last = now;
+    long slewed = (elapsed + 1000) * NTP_MAX_SLEW_PPM / 1000000;
+    TEST_ASSERT_INT_WITHIN(2, slewed < offset ? slewed - offset : 0, clockError(udp, client));
+  }
+  TEST_ASSERT_INT_WITHIN(2, 0, clockError(udp, client));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_drift_converges_to_the_skew);
+  RUN_TEST(test_later_measurements_weigh_a_quarter);
+  RUN_TEST(test_drift_is_clamped);
+  RUN_TEST(test_large_offset_steps);
+  RUN_TEST(test_small_offset_slews);
+  return UNITY_END();
+}
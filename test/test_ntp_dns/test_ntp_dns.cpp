@@ -0,0 +1,231 @@
+// host tests for the cached NTP server lookups, with a resolver that takes as long as WiFi.hostByName() does when
+//DNS doesn't answer.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <fake_udp.h>
+#include <unity.h>
+
+#define LOOKUP_TIME 1000UL
+
+static bool dns_up;
+static int lookups;
+static int pool_turn;
+static unsigned long failed_at[4];
+static unsigned long shortest_retry;
+
+//"n.pool" resolves to 10.0.0.(n+1). "pool" hands out its two members in turn, like a pool name does.
+static NTPResolveResult slowResolver(const char *name, IPAddress &address)
+{
+  lookups++;
+  if(!dns_up && name[0] >= '0' && name[0] <= '3') {
+    unsigned long &last = failed_at[name[0] - '0'];
+    if(last != 0 && millis() - last < shortest_retry) {
+      shortest_retry = millis() - last;
+    }
+    last = millis() + LOOKUP_TIME;
+  }
+  host_millis += LOOKUP_TIME;
+  if(!dns_up) return NTP_RESOLVE_FAILED;
+  if(strcmp(name, "pool") == 0) {
+    address = IPAddress(10, 0, 0, 1 + pool_turn++ % 2);
+  } else {
+    address = IPAddress(10, 0, 0, name[0] - '0' + 1);
+  }
+  return NTP_RESOLVE_DONE;
+}
+
+//like the lwIP lookup in main.cpp: the first call for a name starts it, the answer is there LOOKUP_TIME later and
+//no call ever waits for it.
+static const char *async_name;
+static unsigned long async_started;
+
+static NTPResolveResult asyncResolver(const char *name, IPAddress &address)
+{
+  if(name != async_name) {
+    async_name = name;
+    async_started = millis();
+    lookups++;
+    return NTP_RESOLVE_PENDING;
+  }
+  if(millis() - async_started < LOOKUP_TIME) {
+    return NTP_RESOLVE_PENDING;
+  }
+  async_name = nullptr;
+  if(!dns_up) return NTP_RESOLVE_FAILED;
+  address = IPAddress(10, 0, 0, name[0] - '0' + 1);
+  return NTP_RESOLVE_DONE;
+}
+
+static const char *pool_names[] = {"0.pool", "1.pool", "2.pool", "3.pool"};
+
+static void addPool(FakeUdp &udp, NTPClient &client)
+{
+  for(uint8_t i = 0; i < 4; i++) {
+    udp.servers.push_back({pool_names[i], IPAddress(10, 0, 0, i + 1), 0, 10, 10, true});
+    client.addServer(pool_names[i]);
+  }
+}
+
+void setUp()
+{
+  host_millis = 10000;
+  dns_up = true;
+  lookups = 0;
+  pool_turn = 0;
+  memset(failed_at, 0, sizeof(failed_at));
+  async_name = nullptr;
+  shortest_retry = 0xFFFFFFFFUL;
+}
+
+void tearDown() {}
+
+//update() resolves at most one name per call, and only between requests.
+void test_one_lookup_per_update()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  addPool(udp, client);
+  client.setResolver(slowResolver);
+  client.setHedging(true);
+  unsigned long synced_at = 0;
+  for(int step = 0; step < 100000; step++) {
+    int lookups_before = lookups;
+    bool pending = client.getRequestState() == NTP_REQUEST_PENDING;
+    client.update();
+    TEST_ASSERT_LESS_OR_EQUAL(lookups_before + 1, lookups);
+    if(pending) {
+      TEST_ASSERT_EQUAL(lookups_before, lookups);
+    }
+    if(synced_at == 0 && client.getStats().synced) {
+      synced_at = millis();
+    }
+    host_millis++;
+  }
+  //the first request goes out once the first name is resolved, the other names follow on the next calls
+  TEST_ASSERT_EQUAL(10000 + LOOKUP_TIME + 20, synced_at);
+  TEST_ASSERT_EQUAL(4, lookups);
+  TEST_ASSERT_EQUAL(4, client.getStats().dnsLookups);
+  TEST_ASSERT_EQUAL(0, udp.name_lookups);
+  NTPSourceStats stats;
+  for(uint8_t i = 0; i < 4; i++) {
+    client.getSourceStats(i, stats);
+    TEST_ASSERT_TRUE(stats.address == IPAddress(10, 0, 0, i + 1));
+  }
+}
+
+//while DNS is down, each name is tried once per NTP_DNS_NEGATIVE_TTL and the cached addresses keep the clock synced.
+void test_failed_lookups_are_cached()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  addPool(udp, client);
+  client.setResolver(slowResolver);
+  client.setDnsTtl(10000UL);
+  const unsigned long outage_start = 300000UL;
+  const unsigned long outage_end = outage_start + 1000000UL;
+  int lookups_in_outage = 0;
+  unsigned long longest_call = 0;
+  while(millis() < outage_end + 300000UL) {
+    dns_up = millis() < outage_start || millis() >= outage_end;
+    int lookups_before = lookups;
+    unsigned long before = millis();
+    client.update();
+    if(millis() - before > longest_call) {
+      longest_call = millis() - before;
+    }
+    if(!dns_up) {
+      lookups_in_outage += lookups - lookups_before;
+    }
+    host_millis += 10;
+  }
+  TEST_ASSERT_EQUAL(LOOKUP_TIME, longest_call);
+  //4 names, each tried again NTP_DNS_NEGATIVE_TTL after its last try failed
+  TEST_ASSERT_GREATER_OR_EQUAL(NTP_DNS_NEGATIVE_TTL, shortest_retry);
+  TEST_ASSERT_INT_WITHIN(8, 4 * (outage_end - outage_start) / (NTP_DNS_NEGATIVE_TTL + LOOKUP_TIME), lookups_in_outage);
+  TEST_ASSERT_EQUAL(0, client.getStats().failureCount);
+}
+
+//a server that stops answering is looked up again early, which moves a pool name on to another member.
+void test_dead_pool_member_is_replaced()
+{
+  FakeUdp udp;
+  udp.servers.push_back({"a", IPAddress(10, 0, 0, 1), 0, 10, 10, false});
+  udp.servers.push_back({"b", IPAddress(10, 0, 0, 2), 0, 10, 10, true});
+  NTPClient client(udp, "pool", 0, 64000UL);
+  client.setResolver(slowResolver);
+  int failed = 0;
+  while(!client.forceUpdate()) {
+    failed++;
+    host_millis += 64000;
+  }
+  TEST_ASSERT_EQUAL(NTP_DNS_MAX_FAILURES, failed);
+  TEST_ASSERT_EQUAL(2, lookups);
+  NTPSourceStats stats;
+  client.getSourceStats(0, stats);
+  TEST_ASSERT_TRUE(stats.address == IPAddress(10, 0, 0, 2));
+}
+
+//a resolver that doesn't wait: no call to update() takes any time, the first request waits for the first address
+//instead of going out to no one, and the other names are looked up one after another between requests.
+void test_pending_lookups_never_block()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  addPool(udp, client);
+  client.setResolver(asyncResolver);
+  unsigned long synced_at = 0;
+  while(millis() < 10000 + 10 * LOOKUP_TIME) {
+    unsigned long before = millis();
+    client.update();
+    TEST_ASSERT_EQUAL(before, millis());
+    if(synced_at == 0 && client.getStats().synced) {
+      synced_at = millis();
+    }
+    host_millis++;
+  }
+  TEST_ASSERT_UINT32_WITHIN(2, 10000 + LOOKUP_TIME + 20, synced_at);
+  TEST_ASSERT_EQUAL(0, client.getStats().failureCount);
+  //each name was started once and the pending calls are not counted as lookups
+  TEST_ASSERT_EQUAL(4, lookups);
+  TEST_ASSERT_EQUAL(4, client.getStats().dnsLookups);
+  NTPSourceStats stats;
+  for(uint8_t i = 0; i < 4; i++) {
+    client.getSourceStats(i, stats);
+    TEST_ASSERT_TRUE(stats.address == IPAddress(10, 0, 0, i + 1));
+  }
+}
+
+//forceUpdate() waits for the lookup before it sends.
+void test_force_update_waits_for_pending_lookup()
+{
+  FakeUdp udp;
+  udp.servers.push_back({"0.pool", IPAddress(10, 0, 0, 1), 0, 10, 10, true});
+  NTPClient client(udp, "0.pool", 0, 64000UL);
+  client.setResolver(asyncResolver);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_EQUAL(1, udp.packets_sent);
+}
+
+//without a resolver the names go straight to the UDP client, which looks them up on every request.
+void test_no_resolver_passes_names()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  addPool(udp, client);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_EQUAL(4, udp.name_lookups);
+  TEST_ASSERT_EQUAL(4, client.getStats().dnsLookups);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_one_lookup_per_update);
+  RUN_TEST(test_failed_lookups_are_cached);
+  RUN_TEST(test_dead_pool_member_is_replaced);
+  RUN_TEST(test_pending_lookups_never_block);
+  RUN_TEST(test_force_update_waits_for_pending_lookup);
+  RUN_TEST(test_no_resolver_passes_names);
+  return UNITY_END();
+}
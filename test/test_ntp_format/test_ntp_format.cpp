@@ -0,0 +1,128 @@
+// host tests for the buffer based NTPClient formatters: they must not touch the heap, must agree with the C library's
+//strftime() and must cut their output short safely when the buffer is too small.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <fake_udp.h>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+
+//every operator new in the program goes through here, so a formatter that builds a String or a std::string shows up
+static unsigned long allocations;
+
+void *operator new(size_t size)
+{
+  allocations++;
+  void *block = malloc(size ? size : 1);
+  if(block == nullptr) throw std::bad_alloc();
+  return block;
+}
+
+void operator delete(void *block) noexcept { free(block); }
+void operator delete(void *block, size_t) noexcept { free(block); }
+
+//the fields formatDateTime() shares with strftime(), in the C locale
+#define SHARED_FIELDS "%Y %y %m %d %e %H %I %M %S %p %a %b %F %T %%"
+
+void setUp()
+{
+  host_millis = 10000;
+}
+
+void tearDown() {}
+
+void test_formatting_does_not_allocate()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 60000UL);
+  client.setEpochTime(1078067961UL);
+  char buffer[64];
+  DateTime date_time;
+  size_t written = 0;
+  unsigned long before = allocations;
+  for(unsigned long long secs = 1; secs <= 0xFFFFFFFFULL; secs += 99991) {
+    written += client.formatDate(buffer, sizeof(buffer), secs);
+    written += client.formatTime(buffer, sizeof(buffer), secs);
+    NTPClient::toDateTime(secs, date_time);
+    written += NTPClient::formatDateTime(buffer, sizeof(buffer), SHARED_FIELDS " %L %q", date_time);
+  }
+  //0 asks for the current time, which reads the clock instead
+  written += client.formatDate(buffer, sizeof(buffer));
+  written += client.formatTime(buffer, sizeof(buffer));
+  client.getDateTime(date_time);
+  TEST_ASSERT_EQUAL(0, allocations - before);
+  TEST_ASSERT_GREATER_THAN(0, written);
+  //the String version still allocates, which shows the count works
+  String date = client.getFormattedDate(1078067961UL);
+  TEST_ASSERT_GREATER_THAN(before, allocations);
+  TEST_ASSERT_TRUE(date == "2004-02-29T15:19:21Z");
+}
+
+void test_matches_strftime()
+{
+  char expected[64];
+  char buffer[64];
+  DateTime date_time;
+  for(unsigned long long secs = 0; secs <= 0xFFFFFFFFULL; secs += 86400 / 8 + 13) {
+    time_t t = (time_t)secs;
+    struct tm tm_value;
+    gmtime_r(&t, &tm_value);
+    size_t expected_length = strftime(expected, sizeof(expected), SHARED_FIELDS, &tm_value);
+    NTPClient::toDateTime(secs, date_time);
+    TEST_ASSERT_EQUAL(expected_length, NTPClient::formatDateTime(buffer, sizeof(buffer), SHARED_FIELDS, date_time));
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+  }
+}
+
+void test_fixed_formats()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 60000UL);
+  char buffer[32];
+  TEST_ASSERT_EQUAL(20, client.formatDate(buffer, sizeof(buffer), 1078067961UL));
+  TEST_ASSERT_EQUAL_STRING("2004-02-29T15:19:21Z", buffer);
+  TEST_ASSERT_EQUAL(8, client.formatTime(buffer, sizeof(buffer), 1078067961UL));
+  TEST_ASSERT_EQUAL_STRING("15:19:21", buffer);
+  DateTime date_time;
+  NTPClient::toDateTime(1078067961UL, date_time);
+  date_time.milliseconds = 7;
+  NTPClient::formatDateTime(buffer, sizeof(buffer), "%T.%L %q", date_time);
+  TEST_ASSERT_EQUAL_STRING("15:19:21.007 %q", buffer);
+  NTPClient::toDateTime(0, date_time);
+  NTPClient::formatDateTime(buffer, sizeof(buffer), "%I %p", date_time);
+  TEST_ASSERT_EQUAL_STRING("12 AM", buffer);
+}
+
+//a short buffer gets as much as fits and a terminating null, and nothing past its end is written.
+void test_truncation()
+{
+  FakeUdp udp;
+  NTPClient client(udp, "pool.ntp.org", 0, 60000UL);
+  char buffer[32];
+  for(size_t size = 0; size < 22; size++) {
+    memset(buffer, '#', sizeof(buffer));
+    size_t written = client.formatDate(buffer, size, 1078067961UL);
+    size_t expected = size == 0 ? 0 : (size - 1 < 20 ? size - 1 : 20);
+    TEST_ASSERT_EQUAL(expected, written);
+    if(size > 0) {
+      TEST_ASSERT_EQUAL(0, buffer[written]);
+      TEST_ASSERT_EQUAL(0, strncmp(buffer, "2004-02-29T15:19:21Z", written));
+    }
+    for(size_t i = size; i < sizeof(buffer); i++) {
+      TEST_ASSERT_EQUAL('#', buffer[i]);
+    }
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_formatting_does_not_allocate);
+  RUN_TEST(test_matches_strftime);
+  RUN_TEST(test_fixed_formats);
+  RUN_TEST(test_truncation);
+  return UNITY_END();
+}
@@ -0,0 +1,152 @@
+// host tests for the poll scheduler: the interval doubles after stable syncs up to the max exponent, halves after a
+//large offset, and failed requests are retried after 2 s, doubling, with +-25% jitter, never later than a normal poll.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <fake_udp.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#define UPDATE_INTERVAL 16000UL
+
+static void addServer(FakeUdp &udp, bool alive = true)
+{
+  udp.servers.push_back({"only", IPAddress(10, 0, 0, 1), 0, 10, 10, alive});
+}
+
+//runs update() in 10 ms steps until the next request has been answered or given up on.
+static void runToNextResult(NTPClient &client)
+{
+  unsigned long syncs = client.getStats().syncCount;
+  unsigned long failures = client.getStats().failureCount;
+  while(client.getStats().syncCount == syncs && client.getStats().failureCount == failures) {
+    client.update();
+    host_millis += 10;
+  }
+}
+
+void setUp()
+{
+  host_millis = 10000;
+  srand(1);
+}
+
+void tearDown() {}
+
+//every NTP_POLL_STABLE_COUNT syncs without drift the exponent goes up by one, and stops at the max.
+void test_stable_syncs_lengthen_the_interval()
+{
+  FakeUdp udp;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, UPDATE_INTERVAL);
+  client.setMaxPollExponent(3);
+  runToNextResult(client);
+  TEST_ASSERT_EQUAL(0, client.getStats().pollExponent);
+  for(int sync = 1; sync <= 20; sync++) {
+    unsigned long sent_at = millis();
+    unsigned long expected_interval = client.getStats().pollInterval;
+    int packets = udp.packets_sent;
+    runToNextResult(client);
+    TEST_ASSERT_EQUAL(packets + 1, udp.packets_sent);
+    //the request went out when the interval was up, the reply took 20 ms and the loop steps 10
+    TEST_ASSERT_UINT32_WITHIN(40, sent_at + expected_interval, millis());
+    uint8_t expected_exponent = sync / NTP_POLL_STABLE_COUNT < 3 ? sync / NTP_POLL_STABLE_COUNT : 3;
+    NTPClientStats stats = client.getStats();
+    TEST_ASSERT_EQUAL(expected_exponent, stats.pollExponent);
+    TEST_ASSERT_EQUAL(UPDATE_INTERVAL << expected_exponent, stats.pollInterval);
+    TEST_ASSERT_UINT32_WITHIN(10, stats.pollInterval, stats.nextPollIn);
+  }
+}
+
+//lowering the max takes the exponent down with it, and it is capped at NTP_POLL_EXPONENT_LIMIT.
+void test_max_exponent()
+{
+  FakeUdp udp;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, UPDATE_INTERVAL);
+  client.setMaxPollExponent(3);
+  for(int sync = 0; sync < 20; sync++) {
+    runToNextResult(client);
+  }
+  TEST_ASSERT_EQUAL(3, client.getStats().pollExponent);
+  client.setMaxPollExponent(1);
+  TEST_ASSERT_EQUAL(1, client.getStats().pollExponent);
+  client.setMaxPollExponent(NTP_POLL_EXPONENT_LIMIT + 5);
+  for(int sync = 0; sync < 4 * (NTP_POLL_EXPONENT_LIMIT + 2); sync++) {
+    runToNextResult(client);
+  }
+  TEST_ASSERT_EQUAL(NTP_POLL_EXPONENT_LIMIT, client.getStats().pollExponent);
+}
+
+//an offset over NTP_POLL_JUMP_OFFSET halves the interval and starts the count of stable syncs over.
+void test_large_offset_shortens_the_interval()
+{
+  FakeUdp udp;
+  addServer(udp);
+  NTPClient client(udp, "only", 0, UPDATE_INTERVAL);
+  client.setMaxPollExponent(3);
+  for(int sync = 0; sync < 13; sync++) {
+    runToNextResult(client);
+  }
+  TEST_ASSERT_EQUAL(3, client.getStats().pollExponent);
+  udp.true_base_ms += NTP_POLL_JUMP_OFFSET + 20;
+  runToNextResult(client);
+  TEST_ASSERT_EQUAL(2, client.getStats().pollExponent);
+  //and each further jump halves it again
+  udp.true_base_ms += NTP_POLL_JUMP_OFFSET + 20;
+  runToNextResult(client);
+  TEST_ASSERT_EQUAL(1, client.getStats().pollExponent);
+}
+
+//a dead server is retried after 2 s, 4 s, 8 s and so on, each +-25%, until that reaches the poll interval.
+void test_failures_back_off_with_jitter()
+{
+  FakeUdp udp;
+  addServer(udp, false);
+  NTPClient client(udp, "only", 0, UPDATE_INTERVAL);
+  client.setMaxPollExponent(0);
+  unsigned long shortest[8], longest[8];
+  for(int failure = 1; failure <= 8; failure++) {
+    shortest[failure - 1] = 0xFFFFFFFFUL;
+    longest[failure - 1] = 0;
+  }
+  //the same run of failures many times, so the jitter can be seen to cover its range
+  for(int run = 0; run < 200; run++) {
+    udp.servers[0].alive = false;
+    for(int failure = 1; failure <= 8; failure++) {
+      runToNextResult(client);
+      NTPClientStats stats = client.getStats();
+      TEST_ASSERT_EQUAL(failure, stats.consecutiveFailures);
+      unsigned long retry = NTP_RETRY_BASE_INTERVAL << (failure - 1);
+      if(retry > UPDATE_INTERVAL) {
+        retry = UPDATE_INTERVAL;
+      }
+      TEST_ASSERT_GREATER_OR_EQUAL(retry - retry / 4 - 10, stats.nextPollIn);
+      TEST_ASSERT_LESS_OR_EQUAL(retry + retry / 4, stats.nextPollIn);
+      if(stats.nextPollIn < shortest[failure - 1]) shortest[failure - 1] = stats.nextPollIn;
+      if(stats.nextPollIn > longest[failure - 1]) longest[failure - 1] = stats.nextPollIn;
+    }
+    udp.servers[0].alive = true;
+    runToNextResult(client);
+    TEST_ASSERT_EQUAL(0, client.getStats().consecutiveFailures);
+    TEST_ASSERT_UINT32_WITHIN(10, UPDATE_INTERVAL, client.getStats().nextPollIn);
+  }
+  for(int failure = 1; failure <= 8; failure++) {
+    unsigned long retry = NTP_RETRY_BASE_INTERVAL << (failure - 1);
+    if(retry > UPDATE_INTERVAL) {
+      retry = UPDATE_INTERVAL;
+    }
+    TEST_ASSERT_LESS_THAN(retry - retry / 8, shortest[failure - 1]);
+    TEST_ASSERT_GREATER_THAN(retry + retry / 8, longest[failure - 1]);
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_stable_syncs_lengthen_the_interval);
+  RUN_TEST(test_max_exponent);
+  RUN_TEST(test_large_offset_shortens_the_interval);
+  RUN_TEST(test_failures_back_off_with_jitter);
+  return UNITY_END();
+}
@@ -0,0 +1,128 @@
+// host tests for the non-blocking NTP request state machine, against simulated servers that answer late or never.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <fake_udp.h>
+#include <unity.h>
+
+static int results;
+static bool last_result;
+
+static void countResult(bool success)
+{
+  results++;
+  last_result = success;
+}
+
+static FakeNtpServer server(const char *name, uint8_t last_octet, unsigned long one_way_delay, bool alive = true)
+{
+  return {name, IPAddress(10, 0, 0, last_octet), 0, one_way_delay, one_way_delay, alive};
+}
+
+void setUp()
+{
+  host_millis = 10000;
+  results = 0;
+}
+
+void tearDown() {}
+
+void test_start_request_returns_at_once()
+{
+  FakeUdp udp;
+  udp.servers.push_back(server("slow", 1, 300));
+  NTPClient client(udp, "slow", 0, 60000UL);
+  client.startRequest();
+  TEST_ASSERT_EQUAL(10000, millis());
+  TEST_ASSERT_EQUAL(NTP_REQUEST_PENDING, client.getRequestState());
+  TEST_ASSERT_EQUAL(1, udp.packets_sent);
+}
+
+//the reply takes 400 ms, the loop keeps running 1 ms steps all along and the time is set when it arrives.
+void test_loop_keeps_running_during_a_slow_reply()
+{
+  FakeUdp udp;
+  udp.servers.push_back(server("slow", 1, 200));
+  NTPClient client(udp, "slow", 0, 60000UL);
+  client.onResult(countResult);
+  client.startRequest();
+  unsigned long loops = 0;
+  while(client.getRequestState() == NTP_REQUEST_PENDING) {
+    unsigned long before = millis();
+    client.update();
+    TEST_ASSERT_EQUAL(before, millis());
+    host_millis++;
+    loops++;
+  }
+  TEST_ASSERT_EQUAL(NTP_REQUEST_SUCCESS, client.getRequestState());
+  //one pass per ms, the reply is picked up on the pass at 400 ms
+  TEST_ASSERT_EQUAL(401, loops);
+  TEST_ASSERT_EQUAL(1, results);
+  TEST_ASSERT_TRUE(last_result);
+  TEST_ASSERT_INT_WITHIN(2, (long long)udp.trueMillis(), (long long)client.getEpochMillis());
+}
+
+void test_dead_server_times_out()
+{
+  FakeUdp udp;
+  udp.servers.push_back(server("dead", 1, 10, false));
+  NTPClient client(udp, "dead", 0, 60000UL);
+  client.onResult(countResult);
+  client.setRequestTimeout(1000);
+  client.startRequest();
+  host_millis += 999;
+  TEST_ASSERT_EQUAL(NTP_REQUEST_PENDING, client.poll());
+  host_millis += 1;
+  TEST_ASSERT_EQUAL(NTP_REQUEST_TIMEOUT, client.poll());
+  TEST_ASSERT_EQUAL(1, results);
+  TEST_ASSERT_FALSE(last_result);
+}
+
+//a reply that shows up after its request timed out must not be taken for the answer to the next request.
+void test_late_reply_is_ignored()
+{
+  FakeUdp udp;
+  udp.servers.push_back(server("late", 1, 800));
+  NTPClient client(udp, "late", 0, 60000UL);
+  client.setRequestTimeout(1000);
+  client.setMaxDelay(2000);
+  client.startRequest();
+  host_millis += 1000;
+  TEST_ASSERT_EQUAL(NTP_REQUEST_TIMEOUT, client.poll());
+  //the reply to the first request arrives 600 ms into the second one, which is answered 200 ms later
+  udp.servers[0].up_delay = udp.servers[0].down_delay = 400;
+  client.startRequest();
+  host_millis += 600;
+  TEST_ASSERT_EQUAL(NTP_REQUEST_PENDING, client.poll());
+  host_millis += 200;
+  TEST_ASSERT_EQUAL(NTP_REQUEST_SUCCESS, client.poll());
+  TEST_ASSERT_EQUAL(800, client.getLastDelay());
+  TEST_ASSERT_INT_WITHIN(2, (long long)udp.trueMillis(), (long long)client.getEpochMillis());
+}
+
+//update() only sends a new request once the update interval is up.
+void test_update_polls_on_schedule()
+{
+  FakeUdp udp;
+  udp.servers.push_back(server("fast", 1, 5));
+  NTPClient client(udp, "fast", 0, 60000UL);
+  for(int second = 0; second < 600; second++) {
+    for(int ms = 0; ms < 1000; ms += 10) {
+      client.update();
+      host_millis += 10;
+    }
+  }
+  TEST_ASSERT_EQUAL(10, udp.packets_sent);
+  TEST_ASSERT_EQUAL(0, client.getStats().failureCount);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_start_request_returns_at_once);
+  RUN_TEST(test_loop_keeps_running_during_a_slow_reply);
+  RUN_TEST(test_dead_server_times_out);
+  RUN_TEST(test_late_reply_is_ignored);
+  RUN_TEST(test_update_polls_on_schedule);
+  return UNITY_END();
+}
@@ -0,0 +1,113 @@
+// host tests for sampling several NTP servers: the majority selection and the minimum delay filter, against
+//simulated servers with offsets and latencies injected.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <fake_udp.h>
+#include <unity.h>
+
+static void addServers(FakeUdp &udp, NTPClient &client)
+{
+  for(const FakeNtpServer &server : udp.servers) {
+    client.addServer(server.name.c_str());
+  }
+}
+
+static long long clockError(FakeUdp &udp, NTPClient &client)
+{
+  return (long long)client.getEpochMillis() - (long long)udp.trueMillis();
+}
+
+void setUp()
+{
+  host_millis = 10000;
+}
+
+void tearDown() {}
+
+//the fastest server is 5 s off, the other three agree to within a few ms and outvote it.
+void test_falseticker_is_outvoted()
+{
+  FakeUdp udp;
+  udp.servers.push_back({"0.pool", IPAddress(10, 0, 0, 1), 3, 20, 20, true});
+  udp.servers.push_back({"1.pool", IPAddress(10, 0, 0, 2), 5000, 5, 5, true});
+  udp.servers.push_back({"2.pool", IPAddress(10, 0, 0, 3), -2, 40, 40, true});
+  udp.servers.push_back({"3.pool", IPAddress(10, 0, 0, 4), 0, 10, 10, true});
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  addServers(udp, client);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_INT_WITHIN(4, 0, clockError(udp, client));
+  TEST_ASSERT_EQUAL(3, client.getStats().truechimers);
+  NTPSourceStats stats;
+  for(uint8_t i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(client.getSourceStats(i, stats));
+    TEST_ASSERT_EQUAL(i != 1, stats.truechimer);
+  }
+}
+
+//two servers that disagree leave no majority, so the clock isn't set from either.
+void test_no_majority_is_rejected()
+{
+  FakeUdp udp;
+  udp.servers.push_back({"a", IPAddress(10, 0, 0, 1), 0, 5, 5, true});
+  udp.servers.push_back({"b", IPAddress(10, 0, 0, 2), 9000, 5, 5, true});
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  addServers(udp, client);
+  TEST_ASSERT_FALSE(client.forceUpdate());
+  TEST_ASSERT_EQUAL(NTP_REQUEST_REJECTED, client.getRequestState());
+}
+
+//once the path to a server gets slow and lopsided, its replies are off by half the difference. the filter keeps
+//using the earlier low-delay sample, so the clock stays right.
+void test_minimum_delay_filter_skips_congested_samples()
+{
+  FakeUdp udp;
+  udp.servers.push_back({"only", IPAddress(10, 0, 0, 1), 0, 10, 10, true});
+  NTPClient client(udp, "only", 0, 64000UL);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  udp.servers[0].down_delay = 150;
+  for(int sync = 0; sync < 4; sync++) {
+    host_millis += 64000;
+    TEST_ASSERT_TRUE(client.forceUpdate());
+    TEST_ASSERT_INT_WITHIN(2, 0, clockError(udp, client));
+  }
+  NTPSourceStats stats;
+  client.getSourceStats(0, stats);
+  TEST_ASSERT_EQUAL(5, stats.samples);
+  TEST_ASSERT_EQUAL(20, stats.delay);
+  TEST_ASSERT_INT_WITHIN(1, 0, stats.offset);
+}
+
+//bursts take several samples per server each update, and servers that stop answering lose their reach.
+void test_burst_and_reach()
+{
+  FakeUdp udp;
+  udp.servers.push_back({"0.pool", IPAddress(10, 0, 0, 1), 1, 10, 10, true});
+  udp.servers.push_back({"1.pool", IPAddress(10, 0, 0, 2), -1, 15, 15, true});
+  udp.servers.push_back({"2.pool", IPAddress(10, 0, 0, 3), 0, 20, 20, true});
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  addServers(udp, client);
+  client.setBurstSize(3);
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_EQUAL(9, udp.packets_sent);
+  udp.servers[2].alive = false;
+  host_millis += 64000;
+  TEST_ASSERT_TRUE(client.forceUpdate());
+  TEST_ASSERT_INT_WITHIN(3, 0, clockError(udp, client));
+  NTPSourceStats stats;
+  client.getSourceStats(0, stats);
+  TEST_ASSERT_EQUAL(0x3F, stats.reach);
+  TEST_ASSERT_EQUAL(6, stats.samples);
+  client.getSourceStats(2, stats);
+  TEST_ASSERT_EQUAL(0x38, stats.reach);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_falseticker_is_outvoted);
+  RUN_TEST(test_no_majority_is_rejected);
+  RUN_TEST(test_minimum_delay_filter_skips_congested_samples);
+  RUN_TEST(test_burst_and_reach);
+  return UNITY_END();
+}
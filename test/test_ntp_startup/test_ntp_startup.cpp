@@ -0,0 +1,87 @@
+// host benchmark of the time from the first request after boot until the clock has a time to show, with and without
+//hedging, against simulated servers of mixed latency where one may be dead.
+
+#include <Arduino.h>
+#include <NTPClient.h>
+#include <fake_udp.h>
+#include <stdio.h>
+#include <unity.h>
+
+static bool have_time;
+static unsigned long first_time_at;
+
+static void firstResult(bool success)
+{
+  if(success && !have_time) {
+    have_time = true;
+    first_time_at = millis();
+  }
+}
+
+struct StartupResult {
+  unsigned long first_time;   //ms from startRequest() until a time could be shown
+  long long first_error;      //ms the clock was off at that point
+  unsigned long settled;      //ms until the request was finished
+  long long settled_error;
+};
+
+static StartupResult boot(bool hedging, bool one_dead)
+{
+  FakeUdp udp;
+  udp.servers.push_back({"0.pool", IPAddress(10, 0, 0, 1), 3, 15, 15, true});
+  udp.servers.push_back({"1.pool", IPAddress(10, 0, 0, 2), -4, 90, 110, true});
+  udp.servers.push_back({"2.pool", IPAddress(10, 0, 0, 3), 0, 160, 180, true});
+  udp.servers.push_back({"3.pool", IPAddress(10, 0, 0, 4), 1, 40, 40, !one_dead});
+  NTPClient client(udp, "pool.ntp.org", 0, 64000UL);
+  for(const FakeNtpServer &server : udp.servers) {
+    client.addServer(server.name.c_str());
+  }
+  client.setRequestTimeout(2000);
+  client.setHedging(hedging);
+  client.onResult(firstResult);
+  have_time = false;
+  host_millis = 10000;
+
+  StartupResult result = {0, 0, 0, 0};
+  client.startRequest();
+  while(client.getRequestState() == NTP_REQUEST_PENDING) {
+    host_millis++;
+    client.poll();
+    if(have_time && result.first_time == 0) {
+      result.first_time = first_time_at - 10000;
+      result.first_error = (long long)client.getEpochMillis() - (long long)udp.trueMillis();
+    }
+  }
+  result.settled = millis() - 10000;
+  result.settled_error = (long long)client.getEpochMillis() - (long long)udp.trueMillis();
+  return result;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_hedging_shows_the_first_reply()
+{
+  for(int one_dead = 0; one_dead < 2; one_dead++) {
+    StartupResult plain = boot(false, one_dead);
+    StartupResult hedged = boot(true, one_dead);
+    char message[160];
+    snprintf(message, sizeof(message), "%s: first time after %lu ms plain, %lu ms hedged (off %lld ms, %lld ms once settled)",
+             one_dead ? "one server dead" : "all servers up", plain.first_time, hedged.first_time,
+             hedged.first_error, hedged.settled_error);
+    TEST_MESSAGE(message);
+    //the fastest server answers after 30 ms, without hedging the time waits for the slowest one or the timeout
+    TEST_ASSERT_EQUAL(30, hedged.first_time);
+    TEST_ASSERT_EQUAL(one_dead ? 2000 : 340, plain.first_time);
+    TEST_ASSERT_INT_WITHIN(5, 0, hedged.first_error);
+    TEST_ASSERT_INT_WITHIN(5, 0, hedged.settled_error);
+    TEST_ASSERT_EQUAL(plain.settled, hedged.settled);
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_hedging_shows_the_first_reply);
+  return UNITY_END();
+}
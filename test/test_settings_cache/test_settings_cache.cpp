@@ -0,0 +1,214 @@
+// host tests for the write-behind settings cache on an emulated NOR flash: a burst of changes costs one log append
+//once the settings have been left alone for SETTINGS_CACHE_IDLE_TIME, settings that keep changing are still written
+//every SETTINGS_CACHE_MAX_DIRTY_TIME, and reading the settings never touches the flash after begin().
+
+#include <Arduino.h>
+#include <nor_flash.h>
+#include <settings_cache.h>
+#include <stddef.h>
+#include <unity.h>
+
+struct __attribute__((packed)) TestSettings {
+  uint8_t version;
+  uint8_t brightness;
+  int32_t offset;
+};
+
+typedef SettingsLog<NorFlash> TestLog;
+typedef SettingsCache<TestLog, TestSettings> TestCache;
+
+static const SettingsField test_fields[] = {
+  {offsetof(TestSettings, brightness), 1, false, 1, 0, 15, 4},
+  {offsetof(TestSettings, offset), 4, true, 1, -50400, 50400, 0},
+};
+
+static const SettingsSchema<TestLog, TestSettings> test_schema = {0x20, 1, test_fields, 2, nullptr, 0};
+
+//a cache that has written its defaults to a fresh log, so the tests start clean.
+struct TestClock {
+  NorFlashChip chip{2};
+  TestLog log{NorFlash(chip)};
+  TestCache cache{log, test_schema};
+
+  TestClock()
+  {
+    cache.begin();
+    cache.flush();
+  }
+};
+
+//a reboot: the settings the log holds on the same chip.
+static TestSettings storedSettings(NorFlashChip &chip)
+{
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, test_schema);
+  TEST_ASSERT_EQUAL(1, cache.begin());
+  return cache.get();
+}
+
+static void changeBrightness(TestCache &cache)
+{
+  TestSettings values = cache.get();
+  values.brightness = (values.brightness + 1) % 16;
+  cache.set(values);
+}
+
+//runs update() every 10 ms for ms milliseconds.
+static void runFor(TestCache &cache, unsigned long ms)
+{
+  for(unsigned long elapsed = 0; elapsed < ms; elapsed += 10) {
+    host_millis += 10;
+    cache.update();
+  }
+}
+
+void setUp()
+{
+  host_millis = 10000;
+}
+
+void tearDown() {}
+
+//an empty log gives the defaults, which are written on the first flush.
+void test_begin_on_empty_log()
+{
+  NorFlashChip chip(2);
+  TestLog log{NorFlash(chip)};
+  TestCache cache(log, test_schema);
+  TEST_ASSERT_EQUAL(0, cache.begin());
+  TEST_ASSERT_EQUAL(4, cache.get().brightness);
+  TEST_ASSERT_TRUE(cache.dirty());
+  TEST_ASSERT_TRUE(cache.flush());
+  TEST_ASSERT_FALSE(cache.dirty());
+  TEST_ASSERT_EQUAL(4, storedSettings(chip).brightness);
+}
+
+//ten presses of a config button a second apart are written once, SETTINGS_CACHE_IDLE_TIME after the last one.
+void test_burst_is_one_append()
+{
+  TestClock clock;
+  uint32_t sequence = clock.log.sequence();
+  for(int press = 0; press < 10; press++) {
+    changeBrightness(clock.cache);
+    runFor(clock.cache, 1000);
+  }
+  TEST_ASSERT_TRUE(clock.cache.dirty());
+  runFor(clock.cache, SETTINGS_CACHE_IDLE_TIME - 1000 - 10);
+  TEST_ASSERT_EQUAL(sequence, clock.log.sequence());
+  runFor(clock.cache, 10);
+  TEST_ASSERT_EQUAL(sequence + 1, clock.log.sequence());
+  TEST_ASSERT_FALSE(clock.cache.dirty());
+  TEST_ASSERT_EQUAL(14 % 16, storedSettings(clock.chip).brightness);
+  runFor(clock.cache, 60000);
+  TEST_ASSERT_EQUAL(sequence + 1, clock.log.sequence());
+}
+
+//settings that change every second never go idle, they are written every SETTINGS_CACHE_MAX_DIRTY_TIME anyway.
+void test_max_dirty_time_forces_a_write()
+{
+  TestClock clock;
+  uint32_t sequence = clock.log.sequence();
+  unsigned long first_change = millis();
+  unsigned long written_at[3];
+  int writes = 0;
+  for(int second = 0; second < 150; second++) {
+    changeBrightness(clock.cache);
+    for(int step = 0; step < 100; step++) {
+      host_millis += 10;
+      clock.cache.update();
+      if(clock.log.sequence() != sequence + writes) {
+        TEST_ASSERT_LESS_THAN(3, writes);
+        written_at[writes++] = millis();
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL(2, writes);
+  TEST_ASSERT_EQUAL(first_change + SETTINGS_CACHE_MAX_DIRTY_TIME, written_at[0]);
+  //the write falls on a whole second, so the next change makes the settings dirty again right away
+  TEST_ASSERT_EQUAL(written_at[0] + SETTINGS_CACHE_MAX_DIRTY_TIME, written_at[1]);
+  TEST_ASSERT_TRUE(clock.cache.dirty());
+}
+
+//flush() writes right away, and only if something changed.
+void test_flush()
+{
+  TestClock clock;
+  uint32_t sequence = clock.log.sequence();
+  TEST_ASSERT_TRUE(clock.cache.flush());
+  TEST_ASSERT_EQUAL(sequence, clock.log.sequence());
+  TestSettings values = clock.cache.get();
+  values.offset = -25200;
+  clock.cache.set(values);
+  TEST_ASSERT_TRUE(clock.cache.flush());
+  TEST_ASSERT_EQUAL(sequence + 1, clock.log.sequence());
+  TEST_ASSERT_EQUAL(-25200, storedSettings(clock.chip).offset);
+  //setting what is already there changes nothing
+  clock.cache.set(values);
+  TEST_ASSERT_FALSE(clock.cache.dirty());
+  TEST_ASSERT_TRUE(clock.cache.flush());
+  TEST_ASSERT_EQUAL(sequence + 1, clock.log.sequence());
+}
+
+//out of range values are clamped on the way in.
+void test_set_clamps()
+{
+  TestClock clock;
+  TestSettings values = clock.cache.get();
+  values.brightness = 200;
+  values.offset = 100000;
+  clock.cache.set(values);
+  TEST_ASSERT_EQUAL(15, clock.cache.get().brightness);
+  TEST_ASSERT_EQUAL(50400, clock.cache.get().offset);
+}
+
+//a write that fails keeps the settings dirty, update() tries again once they have been idle again.
+void test_failed_write_is_retried()
+{
+  TestClock clock;
+  uint32_t sequence = clock.log.sequence();
+  changeBrightness(clock.cache);
+  clock.chip.power_cut_after = 0;
+  runFor(clock.cache, SETTINGS_CACHE_IDLE_TIME);
+  TEST_ASSERT_TRUE(clock.cache.dirty());
+  clock.chip.power_cut_after = -1;
+  runFor(clock.cache, SETTINGS_CACHE_IDLE_TIME - 10);
+  TEST_ASSERT_TRUE(clock.cache.dirty());
+  runFor(clock.cache, 10);
+  TEST_ASSERT_FALSE(clock.cache.dirty());
+  TEST_ASSERT_EQUAL(5, storedSettings(clock.chip).brightness);
+  TEST_ASSERT_GREATER_THAN(sequence, clock.log.sequence());
+}
+
+//after begin() the settings come from RAM: reading them, changing them and the update() calls that don't write never
+//read the flash.
+void test_get_never_reads_the_flash()
+{
+  TestClock clock;
+  uint32_t reads = clock.chip.reads;
+  uint32_t writes = clock.chip.writes;
+  uint32_t brightness = 0;
+  for(int call = 0; call < 1000; call++) {
+    brightness += clock.cache.get().brightness;
+    if(call % 100 == 0) {
+      changeBrightness(clock.cache);
+    }
+    host_millis += 1;
+    clock.cache.update();
+  }
+  TEST_ASSERT_GREATER_THAN(0, brightness);
+  TEST_ASSERT_EQUAL(reads, clock.chip.reads);
+  TEST_ASSERT_EQUAL(writes, clock.chip.writes);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_on_empty_log);
+  RUN_TEST(test_burst_is_one_append);
+  RUN_TEST(test_max_dirty_time_forces_a_write);
+  RUN_TEST(test_flush);
+  RUN_TEST(test_set_clamps);
+  RUN_TEST(test_failed_write_is_retried);
+  RUN_TEST(test_get_never_reads_the_flash);
+  return UNITY_END();
+}
@@ -0,0 +1,169 @@
+// host tests for the settings log on an emulated NOR flash: how many sector erases the settings cost compared to the
+//old EEPROM code, that the log never needs to set a bit without an erase, and that a power cut in the middle of a
+//commit leaves either the old or the new settings. a log in a single sector could lose them, so it refuses to write.
+
+#include <nor_flash.h>
+#include <settings_log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+
+//the old code saved one setting per button press as 3 EEPROM.commit() calls, and every commit of changed data erases
+//and rewrites the EEPROM sector.
+#define OLD_EEPROM_ERASES_PER_CHANGE 3
+
+#define NUM_CHANGES 10000
+
+//stands in for the settings struct the clock stores as a single value.
+struct TestSettings {
+  uint32_t values[4];
+};
+
+#define TEST_SETTINGS_KEY 1
+
+static bool commitSettings(SettingsLog<NorFlash> &log, const TestSettings &settings)
+{
+  SettingsLogEntry entry = {TEST_SETTINGS_KEY, sizeof(settings), &settings};
+  return log.commit(&entry, 1);
+}
+
+//a reboot: a new log on the same chip.
+static bool readAfterReboot(NorFlashChip &chip, TestSettings &settings)
+{
+  SettingsLog<NorFlash> log{NorFlash(chip)};
+  log.begin();
+  return log.read(TEST_SETTINGS_KEY, &settings, sizeof(settings));
+}
+
+void setUp()
+{
+  srand(1);
+}
+
+void tearDown() {}
+
+void test_erases_per_change()
+{
+  for(uint8_t sectors = SETTINGS_LOG_MIN_SECTORS; sectors <= 4; sectors++) {
+    NorFlashChip chip(sectors);
+    SettingsLog<NorFlash> log{NorFlash(chip)};
+    TEST_ASSERT_FALSE(log.begin());
+    TestSettings settings = {{4, 0, 1, (uint32_t)-25200}};
+    for(int change = 0; change < NUM_CHANGES; change++) {
+      settings.values[change % 4] = rand();
+      TEST_ASSERT_TRUE(commitSettings(log, settings));
+      if(change % 97 == 0) {
+        TestSettings stored;
+        TEST_ASSERT_TRUE(readAfterReboot(chip, stored));
+        TEST_ASSERT_EQUAL_MEMORY(&settings, &stored, sizeof(settings));
+      }
+    }
+    //a 16 byte value makes a 32 byte record, a sector holds 127 of them after its header
+    TEST_ASSERT_EQUAL(NUM_CHANGES / 127 + 1, chip.totalErases());
+    //the erases rotate through the sectors
+    for(uint8_t sector = 0; sector < sectors; sector++) {
+      TEST_ASSERT_UINT32_WITHIN(1, chip.totalErases() / sectors, chip.erases[sector]);
+    }
+    TEST_ASSERT_EQUAL(0, chip.set_bit_writes);
+    char message[120];
+    snprintf(message, sizeof(message), "%u sector(s): %d changes cost %u erases, the old EEPROM code %d", sectors,
+             NUM_CHANGES, chip.totalErases(), NUM_CHANGES * OLD_EEPROM_ERASES_PER_CHANGE);
+    TEST_MESSAGE(message);
+  }
+}
+
+//the power fails after a random number of bytes of a commit, which may be in the middle of a compaction. the log
+//comes back with either the old or the new settings, never without any.
+void test_power_cut_during_commit()
+{
+  NorFlashChip chip(2);
+  SettingsLog<NorFlash> log{NorFlash(chip)};
+  log.begin();
+  TestSettings settings = {{4, 0, 1, (uint32_t)-25200}};
+  TEST_ASSERT_TRUE(commitSettings(log, settings));
+  int kept_old = 0, kept_new = 0;
+  for(int cut = 0; cut < 3000; cut++) {
+    TestSettings next = settings;
+    next.values[rand() % 4] = rand();
+    next.values[rand() % 4] = rand();
+    chip.power_cut_after = rand() % 300;
+    commitSettings(log, next);
+    chip.power_cut_after = -1;
+
+    log = SettingsLog<NorFlash>(NorFlash(chip));
+    log.begin();
+    TestSettings stored;
+    TEST_ASSERT_TRUE(log.read(TEST_SETTINGS_KEY, &stored, sizeof(stored)));
+    if(memcmp(&stored, &next, sizeof(stored)) == 0) {
+      kept_new++;
+      settings = next;
+    } else {
+      TEST_ASSERT_EQUAL_MEMORY(&settings, &stored, sizeof(stored));
+      kept_old++;
+    }
+  }
+  TEST_ASSERT_EQUAL(0, chip.set_bit_writes);
+  TEST_ASSERT_GREATER_THAN(0, kept_old);
+  TEST_ASSERT_GREATER_THAN(0, kept_new);
+  char message[120];
+  snprintf(message, sizeof(message), "3000 power cuts kept the old settings %d times, the new %d", kept_old, kept_new);
+  TEST_MESSAGE(message);
+}
+
+//a compaction in a single sector would erase the only copy before writing the new one, so a region that small is
+//never written to, and the flash is left as it was.
+void test_single_sector_is_refused()
+{
+  NorFlashChip chip(1);
+  std::vector<uint8_t> before = chip.bytes;
+  SettingsLog<NorFlash> log{NorFlash(chip)};
+  TEST_ASSERT_FALSE(log.begin());
+  TEST_ASSERT_FALSE(log.writable());
+  TestSettings settings = {{4, 0, 1, (uint32_t)-25200}};
+  TEST_ASSERT_FALSE(commitSettings(log, settings));
+  TEST_ASSERT_EQUAL(0, chip.totalErases());
+  TEST_ASSERT_TRUE(before == chip.bytes);
+  NorFlashChip two(2);
+  TEST_ASSERT_TRUE(SettingsLog<NorFlash>(NorFlash(two)).writable());
+}
+
+//several settings in one commit are stored all together or not at all.
+void test_commit_is_atomic()
+{
+  NorFlashChip chip(2);
+  SettingsLog<NorFlash> log{NorFlash(chip)};
+  log.begin();
+  uint32_t first = 1, second = 2;
+  SettingsLogEntry entries[] = {{1, 4, &first}, {2, 4, &second}};
+  TEST_ASSERT_TRUE(log.commit(entries, 2));
+  first = 10;
+  second = 20;
+  //the record is 12 bytes of header and 16 of payload, cut it in the second value
+  chip.power_cut_after = 24;
+  TEST_ASSERT_FALSE(log.commit(entries, 2));
+  chip.power_cut_after = -1;
+  SettingsLog<NorFlash> rebooted{NorFlash(chip)};
+  TEST_ASSERT_TRUE(rebooted.begin());
+  uint32_t value;
+  TEST_ASSERT_TRUE(rebooted.read(1, &value, 4));
+  TEST_ASSERT_EQUAL(1, value);
+  TEST_ASSERT_TRUE(rebooted.read(2, &value, 4));
+  TEST_ASSERT_EQUAL(2, value);
+  //the next commit goes past the torn record
+  TEST_ASSERT_TRUE(rebooted.commit(entries, 2));
+  SettingsLog<NorFlash> again{NorFlash(chip)};
+  again.begin();
+  TEST_ASSERT_TRUE(again.read(2, &value, 4));
+  TEST_ASSERT_EQUAL(20, value);
+  TEST_ASSERT_EQUAL(0, chip.set_bit_writes);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_erases_per_change);
+  RUN_TEST(test_power_cut_during_commit);
+  RUN_TEST(test_single_sector_is_refused);
+  RUN_TEST(test_commit_is_atomic);
+  return UNITY_END();
+}
@@ -0,0 +1,195 @@
+// host tests for TextLayout: glyph positions with spacing and kerning, which glyph a character of the string starts
+//at, relayout() against a fresh layout, alignment in a viewport, and drawing clipped to every viewport of the display
+//in both directions against a column by column reference.
+
+#include <Arduino.h>
+#include <text_layout.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+//a framebuffer with two guard columns after the display, which nothing may write.
+struct TestDisplay {
+  static constexpr int16_t num_columns = 32;
+  uint8_t columns[num_columns + 2];
+  uint8_t &column(int x) { return columns[x]; }
+  uint8_t *columnRun(int x, int &length)
+  {
+    length = num_columns - x;
+    return columns + x;
+  }
+};
+
+const FontKerning kerning[] PROGMEM = {
+  {'1', '2', -2},
+  {'2', '1', 3},
+};
+
+static void checkGlyph(const TextLayout &text_layout, uint8_t i, char code, int16_t x, uint8_t width)
+{
+  TEST_ASSERT_EQUAL(code, text_layout.glyphCode(i));
+  TEST_ASSERT_EQUAL(x, text_layout.glyphX(i));
+  TEST_ASSERT_EQUAL(width, text_layout.glyphWidth(i));
+}
+
+void setUp()
+{
+  srand(1);
+}
+
+void tearDown() {}
+
+//the digits of dig6x8 are 6 columns wide, and it has no glyph for ':', which is left out.
+void test_spacing_and_missing_glyphs()
+{
+  TextLayout text_layout;
+  text_layout.layout(dig6x8_upright, "123");
+  TEST_ASSERT_EQUAL(3, text_layout.count());
+  checkGlyph(text_layout, 0, '1', 0, 6);
+  checkGlyph(text_layout, 1, '2', 7, 6);
+  checkGlyph(text_layout, 2, '3', 14, 6);
+  TEST_ASSERT_EQUAL(20, text_layout.width());
+  text_layout.layout(dig6x8_upright, "123", 3);
+  checkGlyph(text_layout, 2, '3', 18, 6);
+  TEST_ASSERT_EQUAL(24, text_layout.width());
+  text_layout.layout(dig6x8_upright, ":1::2:");
+  TEST_ASSERT_EQUAL(2, text_layout.count());
+  checkGlyph(text_layout, 0, '1', 0, 6);
+  checkGlyph(text_layout, 1, '2', 7, 6);
+  TEST_ASSERT_EQUAL(13, text_layout.width());
+  text_layout.layout(dig6x8_upright, "");
+  TEST_ASSERT_EQUAL(0, text_layout.count());
+  TEST_ASSERT_EQUAL(0, text_layout.width());
+}
+
+//a pair is looked up in the order it is drawn, and kerns across the characters left out between its glyphs.
+void test_kerning_pairs()
+{
+  TextLayout text_layout;
+  text_layout.layout(dig6x8_upright, "1212", 1, kerning, 2);
+  checkGlyph(text_layout, 0, '1', 0, 6);
+  checkGlyph(text_layout, 1, '2', 5, 6);
+  checkGlyph(text_layout, 2, '1', 15, 6);
+  checkGlyph(text_layout, 3, '2', 20, 6);
+  TEST_ASSERT_EQUAL(26, text_layout.width());
+  //pairs not in the table keep the spacing
+  text_layout.layout(dig6x8_upright, "113", 1, kerning, 2);
+  checkGlyph(text_layout, 1, '1', 7, 6);
+  checkGlyph(text_layout, 2, '3', 14, 6);
+  text_layout.layout(dig6x8_upright, "1:2", 1, kerning, 2);
+  checkGlyph(text_layout, 1, '2', 5, 6);
+  //only the first num_kerning pairs are used
+  text_layout.layout(dig6x8_upright, "21", 1, kerning, 1);
+  checkGlyph(text_layout, 1, '1', 7, 6);
+  text_layout.layout(dig6x8_upright, "21", 1, kerning, 2);
+  checkGlyph(text_layout, 1, '1', 10, 6);
+}
+
+void test_first_glyph_from()
+{
+  TextLayout text_layout;
+  text_layout.layout(dig6x8_upright, "1:23:4");
+  TEST_ASSERT_EQUAL(4, text_layout.count());
+  const uint8_t expected[] = {0, 1, 1, 2, 3, 3, 4, 4};
+  for(uint8_t position = 0; position < sizeof(expected); position++) {
+    TEST_ASSERT_EQUAL(expected[position], text_layout.firstGlyphFrom(position));
+  }
+  TEST_ASSERT_EQUAL(4, text_layout.firstGlyphFrom(0xFF));
+  text_layout.layout(dig6x8_upright, "::");
+  TEST_ASSERT_EQUAL(0, text_layout.firstGlyphFrom(0));
+}
+
+//random strings of digits and colons, changed from a random character on, relaid out and laid out afresh.
+void test_relayout_matches_layout()
+{
+  const char characters[] = "0123456789:";
+  char string[12];
+  TextLayout relaid;
+  relaid.layout(dig6x8_upright, "", 1, kerning, 2);
+  string[0] = '\0';
+  for(int test = 0; test < 5000; test++) {
+    uint8_t length = strlen(string);
+    uint8_t changed = rand() % (length + 1);
+    uint8_t new_length = changed + rand() % (sizeof(string) - changed);
+    for(uint8_t i = changed; i < new_length; i++) {
+      string[i] = characters[rand() % (sizeof(characters) - 1)];
+    }
+    string[new_length] = '\0';
+    relaid.relayout(dig6x8_upright, string, changed, 1, kerning, 2);
+    TextLayout fresh;
+    fresh.layout(dig6x8_upright, string, 1, kerning, 2);
+    TEST_ASSERT_EQUAL_MESSAGE(fresh.count(), relaid.count(), string);
+    TEST_ASSERT_EQUAL_MESSAGE(fresh.width(), relaid.width(), string);
+    for(uint8_t i = 0; i < fresh.count(); i++) {
+      checkGlyph(relaid, i, fresh.glyphCode(i), fresh.glyphX(i), fresh.glyphWidth(i));
+    }
+  }
+}
+
+//a layout 13 columns wide, in the whole display and in a viewport from column 4 on 20 wide, then one wider than the
+//display, which hangs over both ends when centered.
+void test_alignment()
+{
+  TextLayout text_layout;
+  text_layout.layout(dig6x8_upright, "12");
+  TEST_ASSERT_EQUAL(0, text_layout.alignedX(TEXT_ALIGN_LEFT, 0, 32));
+  TEST_ASSERT_EQUAL(9, text_layout.alignedX(TEXT_ALIGN_CENTER, 0, 32));
+  TEST_ASSERT_EQUAL(19, text_layout.alignedX(TEXT_ALIGN_RIGHT, 0, 32));
+  TEST_ASSERT_EQUAL(4, text_layout.alignedX(TEXT_ALIGN_LEFT, 4, 20));
+  TEST_ASSERT_EQUAL(7, text_layout.alignedX(TEXT_ALIGN_CENTER, 4, 20));
+  TEST_ASSERT_EQUAL(11, text_layout.alignedX(TEXT_ALIGN_RIGHT, 4, 20));
+  text_layout.layout(dig6x8_upright, "12345");
+  TEST_ASSERT_EQUAL(34, text_layout.width());
+  TEST_ASSERT_EQUAL(0, text_layout.alignedX(TEXT_ALIGN_LEFT, 0, 32));
+  TEST_ASSERT_EQUAL(-1, text_layout.alignedX(TEXT_ALIGN_CENTER, 0, 32));
+  TEST_ASSERT_EQUAL(-2, text_layout.alignedX(TEXT_ALIGN_RIGHT, 0, 32));
+}
+
+//every layout offset and clip, including clips past the ends of the display and empty ones, both ways round. the
+//reference writes the glyph columns one at a time, only inside the clip, and leaves the gaps between glyphs alone.
+void test_clip()
+{
+  TextLayout text_layout;
+  text_layout.layout(font_upright, "Wi:1g");
+  for(int reversed = 0; reversed < 2; reversed++) {
+    const FontDescriptor &face = reversed ? font_flipped : font_upright;
+    for(int16_t x = -text_layout.width() - 1; x <= TestDisplay::num_columns + 1; x++) {
+      for(int16_t clip_left = -2; clip_left <= TestDisplay::num_columns + 2; clip_left++) {
+        for(int16_t clip_right = clip_left - 1; clip_right <= TestDisplay::num_columns + 2; clip_right++) {
+          TestDisplay expected, actual;
+          memset(expected.columns, 0xA5, sizeof(expected.columns));
+          memset(actual.columns, 0xA5, sizeof(actual.columns));
+          for(uint8_t i = 0; i < text_layout.count(); i++) {
+            const uint8_t *columns;
+            uint8_t width;
+            TEST_ASSERT_TRUE(fontGlyph(face, text_layout.glyphCode(i), columns, width));
+            for(uint8_t column = 0; column < width; column++) {
+              int16_t text_column = x + text_layout.glyphX(i) + column;
+              if(text_column >= clip_left && text_column < clip_right && text_column >= 0 &&
+                 text_column < TestDisplay::num_columns) {
+                expected.columns[reversed ? TestDisplay::num_columns - 1 - text_column : text_column] = columns[column];
+              }
+            }
+          }
+          text_layout.render(face, actual, x, reversed, clip_left, clip_right);
+          char message[48];
+          snprintf(message, sizeof(message), "reversed %d, x %d, clip %d to %d", reversed, x, clip_left, clip_right);
+          TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected.columns, actual.columns, sizeof(expected.columns), message);
+        }
+      }
+    }
+  }
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_spacing_and_missing_glyphs);
+  RUN_TEST(test_kerning_pairs);
+  RUN_TEST(test_first_glyph_from);
+  RUN_TEST(test_relayout_matches_layout);
+  RUN_TEST(test_alignment);
+  RUN_TEST(test_clip);
+  return UNITY_END();
+}
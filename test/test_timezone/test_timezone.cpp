@@ -0,0 +1,195 @@
+// host tests for the POSIX TZ rules: the transitions of a set of TZ strings over 2023-2025, pinned from the C
+//library's own TZ parsing, must come out to the second, with the right offset just before and at each one.
+
+#include <Arduino.h>
+#include <timezone.h>
+#include <stdlib.h>
+#include <unity.h>
+
+struct PinnedTransition {
+  uint32_t utc;
+  int32_t offset_before;
+  int32_t offset_after;
+};
+
+struct PinnedRule {
+  const char *tz;
+  PinnedTransition transitions[6];
+};
+
+static const PinnedRule pinned_rules[] = {
+  //Denver: second Sunday in March to first Sunday in November, at 02:00
+  {"MST7MDT,M3.2.0,M11.1.0", {
+    {1678611600, -25200, -21600},
+    {1699171200, -21600, -25200},
+    {1710061200, -25200, -21600},
+    {1730620800, -21600, -25200},
+    {1741510800, -25200, -21600},
+    {1762070400, -21600, -25200}}},
+  //no rules given, the default US ones
+  {"EST5EDT", {
+    {1678604400, -18000, -14400},
+    {1699164000, -14400, -18000},
+    {1710054000, -18000, -14400},
+    {1730613600, -14400, -18000},
+    {1741503600, -18000, -14400},
+    {1762063200, -14400, -18000}}},
+  //London: last Sundays, at 01:00 GMT both ways
+  {"GMT0BST,M3.5.0/1,M10.5.0", {
+    {1679792400, 0, 3600},
+    {1698541200, 3600, 0},
+    {1711846800, 0, 3600},
+    {1729990800, 3600, 0},
+    {1743296400, 0, 3600},
+    {1761440400, 3600, 0}}},
+  //Sydney: southern hemisphere, DST runs across new year
+  {"AEST-10AEDT,M10.1.0,M4.1.0/3", {
+    {1680364800, 39600, 36000},
+    {1696089600, 36000, 39600},
+    {1712419200, 39600, 36000},
+    {1728144000, 36000, 39600},
+    {1743868800, 39600, 36000},
+    {1759593600, 36000, 39600}}},
+  //Auckland: southern hemisphere, starting on the last Sunday of September
+  {"NZST-12NZDT,M9.5.0,M4.1.0/3", {
+    {1680357600, 46800, 43200},
+    {1695477600, 43200, 46800},
+    {1712412000, 46800, 43200},
+    {1727532000, 43200, 46800},
+    {1743861600, 46800, 43200},
+    {1758981600, 43200, 46800}}},
+  //Jn never counts Feb. 29, so J60 is Mar. 1 in every year
+  {"<-03>3<-02>,J60,J300", {
+    {1677646800, -10800, -7200},
+    {1698379200, -7200, -10800},
+    {1709269200, -10800, -7200},
+    {1730001600, -7200, -10800},
+    {1740805200, -10800, -7200},
+    {1761537600, -7200, -10800}}},
+  //n does count it, so day 59 is Feb. 29 in leap years
+  {"<-03>3<-02>,59,299", {
+    {1677646800, -10800, -7200},
+    {1698379200, -7200, -10800},
+    {1709182800, -10800, -7200},
+    {1729915200, -7200, -10800},
+    {1740805200, -10800, -7200},
+    {1761537600, -7200, -10800}}},
+  //a negative switch time is on the day before, at 23:00
+  {"<-02>2<-01>,M3.5.0/-1,M10.5.0/0", {
+    {1679792400, -7200, -3600},
+    {1698541200, -3600, -7200},
+    {1711846800, -7200, -3600},
+    {1729990800, -3600, -7200},
+    {1743296400, -7200, -3600},
+    {1761440400, -3600, -7200}}},
+  //switch times past midnight, and the fifth Wednesday of a February that has four
+  {"<+0530>-5:30<+0630>,M2.5.3/26,M11.1.6/25:30", {
+    {1677097800, 19800, 23400},
+    {1699124400, 23400, 19800},
+    {1709152200, 19800, 23400},
+    {1730574000, 23400, 19800},
+    {1740601800, 19800, 23400},
+    {1762023600, 23400, 19800}}},
+};
+
+#define NUM_PINNED_RULES (sizeof(pinned_rules) / sizeof(pinned_rules[0]))
+
+//the offset at utc according to the pinned transitions.
+static int32_t pinnedOffset(const PinnedRule &rule, uint32_t utc)
+{
+  int32_t offset = rule.transitions[0].offset_before;
+  for(const PinnedTransition &transition : rule.transitions) {
+    if(transition.utc <= utc) {
+      offset = transition.offset_after;
+    }
+  }
+  return offset;
+}
+
+void setUp()
+{
+  srand(1);
+}
+
+void tearDown() {}
+
+//the second before each switch still has the old offset, the switch itself has the new one, and the cached period
+//ends and starts right on it.
+void test_transitions_match_pinned_instants()
+{
+  for(const PinnedRule &rule : pinned_rules) {
+    PosixTimezone timezone;
+    TEST_ASSERT_TRUE_MESSAGE(timezone.begin(rule.tz), rule.tz);
+    TEST_ASSERT_TRUE_MESSAGE(timezone.hasDst(), rule.tz);
+    for(const PinnedTransition &transition : rule.transitions) {
+      TEST_ASSERT_EQUAL_MESSAGE(transition.offset_before, timezone.offsetAt(transition.utc - 1), rule.tz);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.utc, timezone.nextTransition(), rule.tz);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.offset_before != timezone.standardOffset(),
+                                timezone.isDst(transition.utc - 1), rule.tz);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.offset_after, timezone.offsetAt(transition.utc), rule.tz);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.utc, timezone.previousTransition(), rule.tz);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.offset_after != timezone.standardOffset(),
+                                timezone.isDst(transition.utc), rule.tz);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.utc + transition.offset_after, timezone.toLocal(transition.utc), rule.tz);
+    }
+  }
+}
+
+//times looked up out of order, so the cached period has to be found again going backwards as well as forwards.
+void test_random_lookups_match_pinned_offsets()
+{
+  for(const PinnedRule &rule : pinned_rules) {
+    PosixTimezone timezone;
+    timezone.begin(rule.tz);
+    uint32_t first = rule.transitions[0].utc - 86400UL * 30;
+    uint32_t last = rule.transitions[5].utc + 86400UL * 30;
+    for(int lookup = 0; lookup < 20000; lookup++) {
+      uint32_t utc = first + (uint32_t)(((uint64_t)rand() * RAND_MAX + rand()) % (last - first));
+      TEST_ASSERT_EQUAL_MESSAGE(pinnedOffset(rule, utc), timezone.offsetAt(utc), rule.tz);
+    }
+  }
+}
+
+//a zone without DST has one offset from 1970 to 2106.
+void test_fixed_offsets()
+{
+  PosixTimezone timezone;
+  TEST_ASSERT_TRUE(timezone.begin("IST-5:30"));
+  TEST_ASSERT_FALSE(timezone.hasDst());
+  TEST_ASSERT_EQUAL(19800, timezone.offsetAt(0));
+  TEST_ASSERT_EQUAL(19800, timezone.offsetAt(0xFFFFFFFFUL));
+  TEST_ASSERT_EQUAL(0xFFFFFFFFUL, timezone.nextTransition());
+  TEST_ASSERT_TRUE(timezone.begin("<+0545>-5:45"));
+  TEST_ASSERT_EQUAL(20700, timezone.offsetAt(1700000000UL));
+  TEST_ASSERT_TRUE(timezone.begin("<-01>1"));
+  TEST_ASSERT_EQUAL(-3600, timezone.offsetAt(1700000000UL));
+  TEST_ASSERT_EQUAL(-3600, timezone.dstOffset());
+}
+
+//anything that isn't a TZ string leaves the timezone at UTC.
+void test_invalid_strings_give_utc()
+{
+  static const char *const invalid[] = {"", "EST", "E5", "5", "<+05", "EST5EDT,M13.2.0,M11.1.0",
+                                        "EST5EDT,M3.6.0,M11.1.0", "EST5EDT,M3.2.7,M11.1.0", "EST5EDT,M3.2.0",
+                                        "EST5EDT,J0,J300", "EST5EDT,366,300", "EST5EDT,M3.2.0,M11.1.0x"};
+  for(const char *tz : invalid) {
+    PosixTimezone timezone;
+    timezone.begin("MST7MDT");
+    TEST_ASSERT_FALSE_MESSAGE(timezone.begin(tz), tz);
+    TEST_ASSERT_FALSE_MESSAGE(timezone.hasDst(), tz);
+    TEST_ASSERT_EQUAL_MESSAGE(0, timezone.offsetAt(1700000000UL), tz);
+  }
+  PosixTimezone timezone;
+  TEST_ASSERT_FALSE(timezone.begin(nullptr));
+  TEST_ASSERT_EQUAL(0, timezone.offsetAt(1700000000UL));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_transitions_match_pinned_instants);
+  RUN_TEST(test_random_lookups_match_pinned_offsets);
+  RUN_TEST(test_fixed_offsets);
+  RUN_TEST(test_invalid_strings_give_utc);
+  return UNITY_END();
+}
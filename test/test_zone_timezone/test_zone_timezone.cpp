@@ -0,0 +1,254 @@
+// host tests for the compiled zones: findTimezoneZone() finds each of them by name, and ZoneTimezone decodes their
+//transition tables from every checkpoint, across historical rule changes and on into the POSIX rule after the table.
+//the instants are pinned from the IANA tzdata the tables were compiled from.
+
+#include <Arduino.h>
+#include <timezone_zones.h>
+#include <stdio.h>
+#include <unity.h>
+
+//2040-01-01 00:00 UTC, how far the zones are walked.
+#define WALK_END 2208988800UL
+
+struct PinnedTransition {
+  const char *zone;
+  uint32_t utc;
+  int32_t offset_before;
+  int32_t offset_after;
+};
+
+//every checkpoint, the last table entry, the years the rules changed and a year well into the POSIX rule.
+static const PinnedTransition pinned_transitions[] = {
+  {"America/Denver", 9968400, -25200, -21600},  //1970-04-26 09:00, checkpoint
+  {"America/Denver", 126694800, -25200, -21600},  //1974-01-06 09:00, checkpoint
+  {"America/Denver", 262774800, -25200, -21600},  //1978-04-30 09:00, checkpoint
+  {"America/Denver", 388573200, -25200, -21600},  //1982-04-25 09:00, checkpoint
+  {"America/Denver", 514976400, -25200, -21600},  //1986-04-27 09:00, checkpoint
+  {"America/Denver", 638960400, -25200, -21600},  //1990-04-01 09:00, checkpoint
+  {"America/Denver", 765363600, -25200, -21600},  //1994-04-03 09:00, checkpoint
+  {"America/Denver", 891766800, -25200, -21600},  //1998-04-05 09:00, checkpoint
+  {"America/Denver", 1018170000, -25200, -21600},  //2002-04-07 09:00, checkpoint
+  {"America/Denver", 1143968400, -25200, -21600},  //2006-04-02 09:00, checkpoint
+  {"America/Denver", 1162108800, -21600, -25200},  //2006-10-29 08:00, table
+  {"America/Denver", 1173603600, -25200, -21600},  //2007-03-11 09:00, last table entry
+  {"America/Denver", 1194163200, -21600, -25200},  //2007-11-04 08:00, from the rule
+  {"America/Denver", 1899363600, -25200, -21600},  //2030-03-10 09:00, from the rule
+  {"America/Denver", 1919923200, -21600, -25200},  //2030-11-03 08:00, from the rule
+  {"America/Los_Angeles", 9972000, -28800, -25200},  //1970-04-26 10:00, checkpoint
+  {"America/Los_Angeles", 126698400, -28800, -25200},  //1974-01-06 10:00, checkpoint
+  {"America/Los_Angeles", 262778400, -28800, -25200},  //1978-04-30 10:00, checkpoint
+  {"America/Los_Angeles", 388576800, -28800, -25200},  //1982-04-25 10:00, checkpoint
+  {"America/Los_Angeles", 514980000, -28800, -25200},  //1986-04-27 10:00, checkpoint
+  {"America/Los_Angeles", 638964000, -28800, -25200},  //1990-04-01 10:00, checkpoint
+  {"America/Los_Angeles", 765367200, -28800, -25200},  //1994-04-03 10:00, checkpoint
+  {"America/Los_Angeles", 891770400, -28800, -25200},  //1998-04-05 10:00, checkpoint
+  {"America/Los_Angeles", 1018173600, -28800, -25200},  //2002-04-07 10:00, checkpoint
+  {"America/Los_Angeles", 1143972000, -28800, -25200},  //2006-04-02 10:00, checkpoint
+  {"America/Los_Angeles", 1173607200, -28800, -25200},  //2007-03-11 10:00, last table entry
+  {"America/Los_Angeles", 1899367200, -28800, -25200},  //2030-03-10 10:00, from the rule
+  {"America/Los_Angeles", 1919926800, -25200, -28800},  //2030-11-03 09:00, from the rule
+  {"America/Chicago", 9964800, -21600, -18000},  //1970-04-26 08:00, checkpoint
+  {"America/Chicago", 126691200, -21600, -18000},  //1974-01-06 08:00, checkpoint
+  {"America/Chicago", 262771200, -21600, -18000},  //1978-04-30 08:00, checkpoint
+  {"America/Chicago", 388569600, -21600, -18000},  //1982-04-25 08:00, checkpoint
+  {"America/Chicago", 514972800, -21600, -18000},  //1986-04-27 08:00, checkpoint
+  {"America/Chicago", 638956800, -21600, -18000},  //1990-04-01 08:00, checkpoint
+  {"America/Chicago", 765360000, -21600, -18000},  //1994-04-03 08:00, checkpoint
+  {"America/Chicago", 891763200, -21600, -18000},  //1998-04-05 08:00, checkpoint
+  {"America/Chicago", 1018166400, -21600, -18000},  //2002-04-07 08:00, checkpoint
+  {"America/Chicago", 1143964800, -21600, -18000},  //2006-04-02 08:00, checkpoint
+  {"America/Chicago", 1173600000, -21600, -18000},  //2007-03-11 08:00, last table entry
+  {"America/Chicago", 1899360000, -21600, -18000},  //2030-03-10 08:00, from the rule
+  {"America/Chicago", 1919919600, -18000, -21600},  //2030-11-03 07:00, from the rule
+  {"America/New_York", 9961200, -18000, -14400},  //1970-04-26 07:00, checkpoint
+  {"America/New_York", 126687600, -18000, -14400},  //1974-01-06 07:00, checkpoint
+  {"America/New_York", 262767600, -18000, -14400},  //1978-04-30 07:00, checkpoint
+  {"America/New_York", 388566000, -18000, -14400},  //1982-04-25 07:00, checkpoint
+  {"America/New_York", 514969200, -18000, -14400},  //1986-04-27 07:00, checkpoint
+  {"America/New_York", 638953200, -18000, -14400},  //1990-04-01 07:00, checkpoint
+  {"America/New_York", 765356400, -18000, -14400},  //1994-04-03 07:00, checkpoint
+  {"America/New_York", 891759600, -18000, -14400},  //1998-04-05 07:00, checkpoint
+  {"America/New_York", 1018162800, -18000, -14400},  //2002-04-07 07:00, checkpoint
+  {"America/New_York", 1143961200, -18000, -14400},  //2006-04-02 07:00, checkpoint
+  {"America/New_York", 1173596400, -18000, -14400},  //2007-03-11 07:00, last table entry
+  {"America/New_York", 1899356400, -18000, -14400},  //2030-03-10 07:00, from the rule
+  {"America/New_York", 1919916000, -14400, -18000},  //2030-11-03 06:00, from the rule
+  {"America/Sao_Paulo", 499748400, -10800, -7200},  //1985-11-02 03:00, checkpoint
+  {"America/Sao_Paulo", 624423600, -10800, -7200},  //1989-10-15 03:00, checkpoint
+  {"America/Sao_Paulo", 750826800, -10800, -7200},  //1993-10-17 03:00, checkpoint
+  {"America/Sao_Paulo", 876106800, -10800, -7200},  //1997-10-06 03:00, checkpoint
+  {"America/Sao_Paulo", 1003028400, -10800, -7200},  //2001-10-14 03:00, checkpoint
+  {"America/Sao_Paulo", 1129431600, -10800, -7200},  //2005-10-16 03:00, checkpoint
+  {"America/Sao_Paulo", 1255834800, -10800, -7200},  //2009-10-18 03:00, checkpoint
+  {"America/Sao_Paulo", 1382238000, -10800, -7200},  //2013-10-20 03:00, checkpoint
+  {"America/Sao_Paulo", 1508036400, -10800, -7200},  //2017-10-15 03:00, checkpoint
+  {"America/Sao_Paulo", 1518919200, -7200, -10800},  //2018-02-18 02:00, table
+  {"America/Sao_Paulo", 1541300400, -10800, -7200},  //2018-11-04 03:00, table
+  {"America/Sao_Paulo", 1550368800, -7200, -10800},  //2019-02-17 02:00, last table entry
+  {"Europe/London", 57722400, 3600, 0},  //1971-10-31 02:00, checkpoint
+  {"Europe/London", 69818400, 0, 3600},  //1972-03-19 02:00, table
+  {"Europe/London", 89172000, 3600, 0},  //1972-10-29 02:00, table
+  {"Europe/London", 183520800, 3600, 0},  //1975-10-26 02:00, checkpoint
+  {"Europe/London", 309924000, 3600, 0},  //1979-10-28 02:00, checkpoint
+  {"Europe/London", 435718800, 3600, 0},  //1983-10-23 01:00, checkpoint
+  {"Europe/London", 562122000, 3600, 0},  //1987-10-25 01:00, checkpoint
+  {"Europe/London", 688525200, 3600, 0},  //1991-10-27 01:00, checkpoint
+  {"Europe/London", 814323600, 3600, 0},  //1995-10-22 01:00, checkpoint
+  {"Europe/London", 828234000, 0, 3600},  //1996-03-31 01:00, last table entry
+  {"Europe/London", 1901149200, 0, 3600},  //2030-03-31 01:00, from the rule
+  {"Europe/London", 1919293200, 3600, 0},  //2030-10-27 01:00, from the rule
+  {"Europe/Berlin", 323830800, 3600, 7200},  //1980-04-06 01:00, checkpoint
+  {"Europe/Berlin", 338950800, 7200, 3600},  //1980-09-28 01:00, table
+  {"Europe/Berlin", 449024400, 3600, 7200},  //1984-03-25 01:00, checkpoint
+  {"Europe/Berlin", 575427600, 3600, 7200},  //1988-03-27 01:00, checkpoint
+  {"Europe/Berlin", 701830800, 3600, 7200},  //1992-03-29 01:00, checkpoint
+  {"Europe/Berlin", 828234000, 3600, 7200},  //1996-03-31 01:00, checkpoint
+  {"Europe/Berlin", 1901149200, 3600, 7200},  //2030-03-31 01:00, from the rule
+  {"Europe/Berlin", 1919293200, 7200, 3600},  //2030-10-27 01:00, from the rule
+  {"Australia/Sydney", 57686400, 36000, 39600},  //1971-10-30 16:00, checkpoint
+  {"Australia/Sydney", 183484800, 36000, 39600},  //1975-10-25 16:00, checkpoint
+  {"Australia/Sydney", 309888000, 36000, 39600},  //1979-10-27 16:00, checkpoint
+  {"Australia/Sydney", 436291200, 36000, 39600},  //1983-10-29 16:00, checkpoint
+  {"Australia/Sydney", 562089600, 36000, 39600},  //1987-10-24 16:00, checkpoint
+  {"Australia/Sydney", 688492800, 36000, 39600},  //1991-10-26 16:00, checkpoint
+  {"Australia/Sydney", 814896000, 36000, 39600},  //1995-10-28 16:00, checkpoint
+  {"Australia/Sydney", 941299200, 36000, 39600},  //1999-10-30 16:00, checkpoint
+  {"Australia/Sydney", 1067097600, 36000, 39600},  //2003-10-25 16:00, checkpoint
+  {"Australia/Sydney", 1174752000, 39600, 36000},  //2007-03-24 16:00, table
+  {"Australia/Sydney", 1193500800, 36000, 39600},  //2007-10-27 16:00, checkpoint
+  {"Australia/Sydney", 1207411200, 39600, 36000},  //2008-04-05 16:00, last table entry
+  {"Australia/Sydney", 1223136000, 36000, 39600},  //2008-10-04 16:00, from the rule
+  {"Australia/Sydney", 1901721600, 39600, 36000},  //2030-04-06 16:00, from the rule
+  {"Australia/Sydney", 1917446400, 36000, 39600},  //2030-10-05 16:00, from the rule
+  {"Pacific/Auckland", 152632800, 43200, 46800},  //1974-11-02 14:00, checkpoint
+  {"Pacific/Auckland", 278431200, 43200, 46800},  //1978-10-28 14:00, checkpoint
+  {"Pacific/Auckland", 404834400, 43200, 46800},  //1982-10-30 14:00, checkpoint
+  {"Pacific/Auckland", 530632800, 43200, 46800},  //1986-10-25 14:00, checkpoint
+  {"Pacific/Auckland", 655221600, 43200, 46800},  //1990-10-06 14:00, checkpoint
+  {"Pacific/Auckland", 781020000, 43200, 46800},  //1994-10-01 14:00, checkpoint
+  {"Pacific/Auckland", 907423200, 43200, 46800},  //1998-10-03 14:00, checkpoint
+  {"Pacific/Auckland", 1033826400, 43200, 46800},  //2002-10-05 14:00, checkpoint
+  {"Pacific/Auckland", 1159624800, 43200, 46800},  //2006-09-30 14:00, checkpoint
+  {"Pacific/Auckland", 1174140000, 46800, 43200},  //2007-03-17 14:00, table
+  {"Pacific/Auckland", 1191074400, 43200, 46800},  //2007-09-29 14:00, last table entry
+  {"Pacific/Auckland", 1901714400, 46800, 43200},  //2030-04-06 14:00, from the rule
+  {"Pacific/Auckland", 1916834400, 43200, 46800},  //2030-09-28 14:00, from the rule
+};
+
+struct PinnedCount {
+  const char *zone;
+  uint16_t transitions;   //from 1970 to WALK_END
+};
+
+static const PinnedCount pinned_counts[] = {
+  {"America/Denver", 140}, {"America/Los_Angeles", 140}, {"America/Chicago", 140}, {"America/New_York", 140},
+  {"America/Sao_Paulo", 68}, {"Europe/London", 137}, {"Europe/Berlin", 120}, {"Australia/Sydney", 137},
+  {"Pacific/Auckland", 131}, {"America/Phoenix", 0}, {"Asia/Kolkata", 0}, {"Asia/Tokyo", 0}, {"Etc/UTC", 0},
+};
+
+static ZoneTimezone zoneNamed(const char *name)
+{
+  ZoneTimezone zone;
+  TEST_ASSERT_TRUE_MESSAGE(zone.begin(findTimezoneZone(name)), name);
+  return zone;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_find_every_zone()
+{
+  TEST_ASSERT_EQUAL(TIMEZONE_NUM_ZONES, sizeof(pinned_counts) / sizeof(pinned_counts[0]));
+  for(const PinnedCount &count : pinned_counts) {
+    const TimezoneZone *zone = findTimezoneZone(count.zone);
+    TEST_ASSERT_NOT_NULL(zone);
+    TEST_ASSERT_EQUAL_STRING(count.zone, zone->name);
+  }
+}
+
+//names that aren't compiled in give nullptr, and a timezone begun with that is UTC.
+void test_unknown_names_give_null()
+{
+  static const char *const unknown[] = {"America/Boise", "", "america/denver", "America/Denver/", "America",
+                                        "Etc/UTC0"};
+  for(const char *name : unknown) {
+    TEST_ASSERT_NULL(findTimezoneZone(name));
+  }
+  ZoneTimezone zone;
+  TEST_ASSERT_FALSE(zone.begin(findTimezoneZone("America/Boise")));
+  TEST_ASSERT_EQUAL(0, zone.offsetAt(1700000000UL));
+}
+
+//each pinned switch, looked up after the one before it in the same zone and again from a fresh timezone, so both the
+//cached period and the checkpoint search have to find it.
+void test_pinned_transitions()
+{
+  ZoneTimezone zone;
+  const char *zone_name = nullptr;
+  for(const PinnedTransition &transition : pinned_transitions) {
+    char message[64];
+    snprintf(message, sizeof(message), "%s at %lu", transition.zone, (unsigned long)transition.utc);
+    for(int fresh = 0; fresh < 2; fresh++) {
+      if(fresh || zone_name != transition.zone) {
+        zone = zoneNamed(transition.zone);
+        zone_name = transition.zone;
+      }
+      TEST_ASSERT_EQUAL_MESSAGE(transition.offset_before, zone.offsetAt(transition.utc - 1), message);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.utc, zone.nextTransition(), message);
+      TEST_ASSERT_EQUAL_MESSAGE(transition.offset_after, zone.offsetAt(transition.utc), message);
+      //and back over it again
+      TEST_ASSERT_EQUAL_MESSAGE(transition.offset_before, zone.offsetAt(transition.utc - 1), message);
+    }
+  }
+}
+
+//following nextTransition() from 1970 hits every switch once: the offset changes at each of them and nowhere in
+//between, and there are as many as tzdata has.
+void test_walk_every_zone()
+{
+  for(const PinnedCount &count : pinned_counts) {
+    ZoneTimezone zone = zoneNamed(count.zone);
+    uint32_t utc = 0;
+    int32_t offset = zone.offsetAt(utc);
+    uint16_t transitions = 0;
+    while(zone.nextTransition() < WALK_END) {
+      uint32_t next = zone.nextTransition();
+      TEST_ASSERT_TRUE_MESSAGE(next > utc, count.zone);
+      TEST_ASSERT_EQUAL_MESSAGE(offset, zone.offsetAt(utc + (next - utc) / 2), count.zone);
+      TEST_ASSERT_EQUAL_MESSAGE(offset, zone.offsetAt(next - 1), count.zone);
+      int32_t next_offset = zone.offsetAt(next);
+      TEST_ASSERT_TRUE_MESSAGE(next_offset != offset, count.zone);
+      utc = next;
+      offset = next_offset;
+      transitions++;
+    }
+    TEST_ASSERT_EQUAL_MESSAGE(count.transitions, transitions, count.zone);
+  }
+}
+
+//the zones without DST have one offset from 1970 to 2106.
+void test_fixed_zones()
+{
+  ZoneTimezone phoenix = zoneNamed("America/Phoenix");
+  ZoneTimezone kolkata = zoneNamed("Asia/Kolkata");
+  ZoneTimezone tokyo = zoneNamed("Asia/Tokyo");
+  ZoneTimezone utc = zoneNamed("Etc/UTC");
+  for(uint32_t time : {0UL, 1173603600UL, 0xFFFFFFFFUL}) {
+    TEST_ASSERT_EQUAL(-25200, phoenix.offsetAt(time));
+    TEST_ASSERT_EQUAL(19800, kolkata.offsetAt(time));
+    TEST_ASSERT_EQUAL(32400, tokyo.offsetAt(time));
+    TEST_ASSERT_EQUAL(0, utc.offsetAt(time));
+  }
+  TEST_ASSERT_EQUAL(0xFFFFFFFFUL, phoenix.nextTransition());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_find_every_zone);
+  RUN_TEST(test_unknown_names_give_null);
+  RUN_TEST(test_pinned_transitions);
+  RUN_TEST(test_walk_every_zone);
+  RUN_TEST(test_fixed_zones);
+  return UNITY_END();
+}
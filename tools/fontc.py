@@ -0,0 +1,368 @@
+#!/usr/bin/env python3
+"""Compiles BDF fonts and PNG sprite sheets into packed PROGMEM fonts for lib/fonts.
+
+Writes a header with a FontDescriptor for every orientation asked for, in the format of the
+packed fonts at the end of lib/fonts/src/fonts.h: the glyph columns back to back with the top
+row in bit 0 (bit 7 for the flipped orientation), and an index of where each glyph starts.
+Proportional glyphs are trimmed to their ink, so blank glyphs like the space need --space-width.
+
+With --encoding rle every glyph is run-length encoded. That saves flash on fonts with wide,
+repetitive glyphs but has to be unpacked with fontGlyphColumns() on every draw, so the size
+statistics printed for both encodings are there to pick per font. auto picks the smaller one.
+
+Usage:
+  python3 tools/fontc.py -o lib/fonts/src/font_clock.h --name clock fonts/clock.bdf
+  python3 tools/fontc.py -o lib/fonts/src/font_big.h --name big --cell 6x8 --first 0x30 fonts/big.png
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+# keep in sync with lib/fonts/src/fonts.h
+MAX_HEIGHT = 8
+MAX_GLYPH_WIDTH = 16
+RLE_MAX_LITERAL = 0x80
+RLE_MAX_REPEAT = 0x7F + 2
+
+
+class Glyph:
+    """A glyph as a list of columns, each a list of MAX_HEIGHT booleans from the top row down."""
+
+    def __init__(self, columns):
+        self.columns = columns
+
+    def trimmed(self):
+        ink = [i for i, column in enumerate(self.columns) if any(column)]
+        if not ink:
+            return Glyph([])
+        return Glyph(self.columns[ink[0]:ink[-1] + 1])
+
+
+def blank_column():
+    return [False] * MAX_HEIGHT
+
+
+# BDF
+
+def read_bdf(path, height):
+    """Returns ({code: Glyph}, height) of the glyphs in a BDF file, placed on the font's baseline."""
+    glyphs = {}
+    ascent = None
+    descent = 0
+    box = None
+    with open(path, "r", encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "FONTBOUNDINGBOX":
+            box = [int(w) for w in words[1:5]]
+        elif words[0] == "FONT_ASCENT":
+            ascent = int(words[1])
+        elif words[0] == "FONT_DESCENT":
+            descent = int(words[1])
+        elif words[0] == "STARTCHAR":
+            code, advance, bbx, rows = None, None, None, []
+            for line in lines:
+                words = line.split()
+                if words[0] == "ENCODING":
+                    code = int(words[1])
+                elif words[0] == "DWIDTH":
+                    advance = int(words[1])
+                elif words[0] == "BBX":
+                    bbx = [int(w) for w in words[1:5]]
+                elif words[0] == "BITMAP":
+                    for line in lines:
+                        if line.strip() == "ENDCHAR":
+                            break
+                        rows.append(int(line.strip(), 16) if line.strip() else 0)
+                    break
+            if code is None or code < 0 or code > 0xFF or bbx is None:
+                continue
+            if ascent is None:
+                if box is None:
+                    raise ValueError("%s has neither FONT_ASCENT nor FONTBOUNDINGBOX" % path)
+                ascent = box[1] + box[3]
+                descent = -box[3]
+            width, rows_high, x_offset, y_offset = bbx
+            row_bits = (width + 7) // 8 * 8
+            columns = [blank_column() for _ in range(max(advance or 0, x_offset + width, 0))]
+            for r, bits in enumerate(rows[:rows_high]):
+                y = ascent - 1 - (y_offset + rows_high - 1 - r)
+                for x in range(width):
+                    if bits >> (row_bits - 1 - x) & 1:
+                        if y < 0 or y >= MAX_HEIGHT:
+                            raise ValueError("glyph %d of %s is taller than %d rows" % (code, path, MAX_HEIGHT))
+                        columns[max(x_offset, 0) + x][y] = True
+            glyphs[code] = Glyph(columns)
+    return glyphs, height or min(ascent + descent, MAX_HEIGHT)
+
+
+# PNG, just enough of it for sprite sheets: any color type and bit depth, not interlaced
+
+def read_png(path, invert):
+    """Returns (width, height, rows) of a PNG, where rows[y][x] is True for a lit pixel: opaque and bright, or dark if invert."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("%s is not a PNG file" % path)
+    p = 8
+    idat = b""
+    palette = []
+    alphas = b""
+    while p < len(data):
+        length, kind = struct.unpack(">L4s", data[p:p + 8])
+        chunk = data[p + 8:p + 8 + length]
+        p += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">LLBBBBB", chunk)
+        elif kind == b"PLTE":
+            palette = [chunk[i:i + 3] for i in range(0, length, 3)]
+        elif kind == b"tRNS":
+            alphas = chunk
+        elif kind == b"IDAT":
+            idat += chunk
+        elif kind == b"IEND":
+            break
+    if interlace:
+        raise ValueError("%s is interlaced, save it without interlacing" % path)
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    stride = (width * channels * depth + 7) // 8
+    pixel_bytes = max(channels * depth // 8, 1)
+    raw = zlib.decompress(idat)
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            left = line[i - pixel_bytes] if i >= pixel_bytes else 0
+            up = previous[i]
+            up_left = previous[i - pixel_bytes] if i >= pixel_bytes else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (left + up) // 2) & 0xFF
+            elif kind == 4:
+                estimate = left + up - up_left
+                pa, pb, pc = abs(estimate - left), abs(estimate - up), abs(estimate - up_left)
+                line[i] = (line[i] + (left if pa <= pb and pa <= pc else up if pb <= pc else up_left)) & 0xFF
+        previous = line
+        samples = []
+        if depth < 8:
+            for byte in line:
+                for shift in range(8 - depth, -1, -depth):
+                    samples.append(byte >> shift & (1 << depth) - 1)
+        elif depth == 16:
+            samples = list(line[0::2])
+        else:
+            samples = list(line)
+        pixels = []
+        for x in range(width):
+            sample = samples[x * channels:(x + 1) * channels]
+            if color == 3:
+                rgb = palette[sample[0]]
+                alpha = alphas[sample[0]] if sample[0] < len(alphas) else 255
+                level = (rgb[0] + rgb[1] + rgb[2]) // 3
+            else:
+                scale = 255 // ((1 << depth) - 1) if depth < 8 else 1
+                level = sum(sample[:3 if color in (2, 6) else 1]) // (3 if color in (2, 6) else 1) * scale
+                alpha = sample[-1] if color in (4, 6) else 255
+            pixels.append(alpha >= 128 and (level >= 128) != invert)
+        rows.append(pixels)
+    return width, height, rows
+
+
+def read_sprite_sheet(path, cell_width, cell_height, first, invert):
+    """Returns {code: Glyph} of a PNG cut into cells left to right, top to bottom, the first one being code first."""
+    width, height, rows = read_png(path, invert)
+    if cell_height > MAX_HEIGHT:
+        raise ValueError("cells are %d rows high, the displays have %d" % (cell_height, MAX_HEIGHT))
+    glyphs = {}
+    code = first
+    for top in range(0, height - cell_height + 1, cell_height):
+        for left in range(0, width - cell_width + 1, cell_width):
+            if code > 0xFF:
+                break
+            columns = []
+            for x in range(left, left + cell_width):
+                column = blank_column()
+                for y in range(cell_height):
+                    column[y] = rows[top + y][x]
+                columns.append(column)
+            glyphs[code] = Glyph(columns)
+            code += 1
+    return glyphs
+
+
+# packing
+
+def column_byte(column, flip):
+    value = 0
+    for y, lit in enumerate(column):
+        if lit:
+            value |= 1 << (MAX_HEIGHT - 1 - y if flip else y)
+    return value
+
+
+def rle_encode(columns):
+    """Encodes one glyph in the runs fontGlyphColumns() unpacks, repeating only runs that save a byte."""
+    encoded = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        for i in range(0, len(literal), RLE_MAX_LITERAL):
+            chunk = literal[i:i + RLE_MAX_LITERAL]
+            encoded.append(len(chunk) - 1)
+            encoded.extend(chunk)
+        literal.clear()
+
+    i = 0
+    while i < len(columns):
+        run = 1
+        while i + run < len(columns) and columns[i + run] == columns[i] and run < RLE_MAX_REPEAT:
+            run += 1
+        # a repeat costs 2 bytes, it only beats adding to a literal when it is 3 long, or 2 with no literal open
+        if run >= 3 or (run == 2 and not literal):
+            flush_literal()
+            encoded.append(0x80 + run - 2)
+            encoded.append(columns[i])
+        else:
+            literal.extend(columns[i:i + run])
+        i += run
+    flush_literal()
+    return bytes(encoded)
+
+
+def pack(glyphs, first, last, flip, encoding):
+    """Returns (glyph bytes, offsets) of glyphs first to last."""
+    data = bytearray()
+    offsets = [0]
+    for code in range(first, last + 1):
+        columns = bytes(column_byte(c, flip) for c in glyphs[code].columns)
+        data.extend(rle_encode(columns) if encoding == "rle" else columns)
+        offsets.append(len(data))
+    return bytes(data), offsets
+
+
+def c_array(kind, name, values, per_line=16, fmt="0x%02X"):
+    lines = ["const %s %s[] PROGMEM = {" % (kind, name)]
+    for i in range(0, len(values), per_line):
+        lines.append("  " + ", ".join(fmt % v for v in values[i:i + per_line]) + ",")
+    lines.append("};")
+    return lines
+
+
+def parse_code(text):
+    if len(text) == 1:
+        return ord(text)
+    return int(text, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("source", help="a .bdf font or a .png sprite sheet")
+    parser.add_argument("-o", "--output", required=True)
+    parser.add_argument("--name", required=True, help="the descriptors are named <name>_upright and <name>_flipped")
+    parser.add_argument("--first", type=parse_code, default=0x20, help="the first character, a single character is itself so 0 is 0x30")
+    parser.add_argument("--last", type=parse_code, help="the last character, the source's last by default")
+    parser.add_argument("--height", type=int, help="the rows the font takes up, from the source by default")
+    parser.add_argument("--cell", help="the WIDTHxHEIGHT of a sprite sheet cell")
+    parser.add_argument("--invert", action="store_true", help="sprite sheet glyphs are dark on a bright background")
+    parser.add_argument("--fixed", action="store_true", help="keep the blank columns around glyphs, for monospace fonts")
+    parser.add_argument("--space-width", type=int, default=2, help="the width of blank proportional glyphs")
+    parser.add_argument("--orientation", choices=["upright", "flipped", "both"], default="both")
+    parser.add_argument("--encoding", choices=["raw", "rle", "auto"], default="raw")
+    args = parser.parse_args()
+
+    if args.source.lower().endswith(".png"):
+        if not args.cell:
+            parser.error("sprite sheets need --cell")
+        cell_width, cell_height = (int(v) for v in args.cell.lower().split("x"))
+        glyphs = read_sprite_sheet(args.source, cell_width, cell_height, args.first, args.invert)
+        height = args.height or cell_height
+    else:
+        glyphs, height = read_bdf(args.source, args.height)
+    if not glyphs:
+        sys.exit("%s has no glyphs" % args.source)
+    last = args.last if args.last is not None else max(glyphs)
+    if last < args.first:
+        sys.exit("%s has no glyphs from %d on" % (args.source, args.first))
+
+    missing = [code for code in range(args.first, last + 1) if code not in glyphs]
+    if missing:
+        print("warning: %s has no glyph for %s, they are left blank" %
+              (args.source, ", ".join(str(code) for code in missing)), file=sys.stderr)
+    for code in range(args.first, last + 1):
+        glyph = glyphs.get(code, Glyph([]))
+        if not args.fixed:
+            glyph = glyph.trimmed()
+            if not glyph.columns:
+                glyph = Glyph([blank_column() for _ in range(args.space_width)])
+        if len(glyph.columns) > MAX_GLYPH_WIDTH:
+            sys.exit("glyph %d of %s is %d columns wide, fontGlyphColumns() takes up to %d" %
+                     (code, args.source, len(glyph.columns), MAX_GLYPH_WIDTH))
+        glyphs[code] = glyph
+
+    count = last - args.first + 1
+    widest = max(len(glyphs[code].columns) for code in range(args.first, last + 1))
+    raw, raw_offsets = pack(glyphs, args.first, last, False, "raw")
+    rle, rle_offsets = pack(glyphs, args.first, last, False, "rle")
+    encoding = args.encoding
+    if encoding == "auto":
+        encoding = "rle" if len(rle) < len(raw) else "raw"
+
+    def index_size(data):
+        return (count + 1) * (2 if len(data) > 255 else 1)
+
+    stats = [
+        "%d glyphs '%s' to '%s' (%d to %d), %d rows, up to %d columns wide" %
+        (count, chr(args.first), chr(last), args.first, last, height, widest),
+        "fixed stride: %d bytes" % (count * (widest + 1) + 1),
+        "raw: %d column bytes + %d index = %d bytes, drawn straight from flash" %
+        (len(raw), index_size(raw), len(raw) + index_size(raw)),
+        "rle: %d encoded bytes + %d index = %d bytes, unpacked on every draw" %
+        (len(rle), index_size(rle), len(rle) + index_size(rle)),
+    ]
+
+    lines = [
+        "// font %s generated by tools/fontc.py from %s, do not edit." % (args.name, os.path.basename(args.source)),
+        "//regenerate with: python3 tools/fontc.py " + " ".join(sys.argv[1:]),
+    ]
+    lines += ["//" + line for line in stats]
+    lines += [
+        "//%s encoded, %d bytes per orientation." % (encoding, len(raw if encoding == "raw" else rle) +
+                                                     index_size(raw if encoding == "raw" else rle)),
+        "",
+        "#pragma once",
+        "",
+        "#include <fonts.h>",
+        "",
+    ]
+    orientations = ["upright", "flipped"] if args.orientation == "both" else [args.orientation]
+    for orientation in orientations:
+        data, offsets = pack(glyphs, args.first, last, orientation == "flipped", encoding)
+        ident = "%s_%s" % (args.name, orientation)
+        wide = len(data) > 255
+        lines += c_array("uint8_t", ident + "_columns", data)
+        lines += c_array("uint16_t" if wide else "uint8_t", ident + "_offsets", offsets, fmt="%d")
+        lines.append("const FontDescriptor %s = {%s_columns, %s_offsets, %d, %d, %d, %s, %s};" %
+                     (ident, ident, ident, args.first, last, height, "true" if wide else "false",
+                      "true" if encoding == "rle" else "false"))
+        lines.append("")
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(lines))
+    for line in stats:
+        print("%s: %s" % (args.name, line))
+    print("wrote %s, %s encoded" % (args.output, encoding))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,26 @@
+"""PlatformIO extra script that runs tools/fontc.py on the fonts of custom_fonts before a build.
+
+Each line of custom_fonts is a source, the header to write and the rest of the fontc.py arguments:
+  extra_scripts = pre:tools/fontc_pio.py
+  custom_fonts =
+    fonts/clock.bdf lib/fonts/src/font_clock.h --name clock
+A header is only rewritten when it is older than its source or fontc.py.
+"""
+
+import os
+import shlex
+import subprocess
+
+Import("env")  # noqa: F821, provided by PlatformIO
+
+project_dir = env["PROJECT_DIR"]  # noqa: F821
+compiler = os.path.join(project_dir, "tools", "fontc.py")
+
+for line in env.GetProjectOption("custom_fonts", "").splitlines():  # noqa: F821
+    words = shlex.split(line, comments=True)
+    if not words:
+        continue
+    source, output = (os.path.join(project_dir, path) for path in words[:2])
+    if os.path.exists(output) and os.path.getmtime(output) >= max(os.path.getmtime(source), os.path.getmtime(compiler)):
+        continue
+    subprocess.check_call([env.subst("$PYTHONEXE"), compiler, source, "-o", output] + words[2:])  # noqa: F821
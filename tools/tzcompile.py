@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""Compiles IANA time zones into PROGMEM transition tables for lib/timezone.
+
+Reads the compiled zoneinfo files (TZif) of the system or of --zoneinfo, keeps the
+transitions from 1970 on, and writes a header with one table per zone. The transitions
+are delta-encoded, with an absolute checkpoint every CHECKPOINT_INTERVAL entries so the
+runtime can binary search them. Transitions that the zone's POSIX TZ footer rule already
+produces are dropped, the runtime switches to that rule after the last table entry.
+
+Usage:
+  python3 tools/tzcompile.py -o lib/timezone/src/timezone_zones.h America/Denver Europe/Berlin ...
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+# keep in sync with TIMEZONE_CHECKPOINT_INTERVAL in lib/timezone/src/zone_timezone.h
+CHECKPOINT_INTERVAL = 8
+MAX_EPOCH = 0xFFFFFFFF
+
+DEFAULT_ZONES = [
+    "America/Denver", "America/Phoenix", "America/Los_Angeles", "America/Chicago",
+    "America/New_York", "America/Sao_Paulo", "Europe/London", "Europe/Berlin",
+    "Asia/Kolkata", "Asia/Tokyo", "Australia/Sydney", "Pacific/Auckland", "Etc/UTC",
+]
+
+
+def read_tzif(path):
+    """Returns (transition times, type index per transition, [(utoff, isdst)], footer) from the v2+ data."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"TZif" or data[4] < ord("2"):
+        raise ValueError("%s is not a version 2+ TZif file" % path)
+
+    def counts(offset):
+        return struct.unpack(">6l", data[offset + 20:offset + 44])
+
+    isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt = counts(0)
+    # skip the 32-bit block, the 64-bit one follows with its own header
+    offset = 44 + timecnt * 5 + typecnt * 6 + charcnt + leapcnt * 8 + isstdcnt + isutcnt
+    isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt = counts(offset)
+    p = offset + 44
+    times = list(struct.unpack(">%dq" % timecnt, data[p:p + 8 * timecnt]))
+    p += 8 * timecnt
+    indices = list(data[p:p + timecnt])
+    p += timecnt
+    types = []
+    for i in range(typecnt):
+        utoff, isdst, _ = struct.unpack(">lBB", data[p + 6 * i:p + 6 * i + 6])
+        types.append((utoff, isdst))
+    p += 6 * typecnt + charcnt + leapcnt * 12 + isstdcnt + isutcnt
+    footer = data[p:].strip(b"\n").decode("ascii")
+    return times, indices, types, footer
+
+
+# POSIX TZ rules, the same grammar lib/timezone/src/timezone.h parses
+
+def days_from_civil(y, m, d):
+    y -= m <= 2
+    era = (y if y >= 0 else y - 399) // 400
+    yoe = y - era * 400
+    doy = (153 * (m - 3 if m > 2 else m + 9) + 2) // 5 + d - 1
+    doe = yoe * 365 + yoe // 4 - yoe // 100 + doy
+    return era * 146097 + doe - 719468
+
+
+def is_leap(y):
+    return (y % 4 == 0 and y % 100 != 0) or y % 400 == 0
+
+
+def parse_offset(text):
+    m = re.match(r"([+-]?)(\d+)(?::(\d+))?(?::(\d+))?", text)
+    seconds = int(m.group(2)) * 3600 + int(m.group(3) or 0) * 60 + int(m.group(4) or 0)
+    return (-seconds if m.group(1) == "-" else seconds), text[m.end():]
+
+
+def parse_name(text):
+    m = re.match(r"<[^>]*>|[A-Za-z]{3,}", text)
+    return text[m.end():]
+
+
+def parse_rule(text):
+    m = re.match(r"M(\d+)\.(\d+)\.(\d+)|J(\d+)|(\d+)", text)
+    if m.group(1):
+        rule = ("M", int(m.group(1)), int(m.group(2)), int(m.group(3)))
+    elif m.group(4):
+        rule = ("J", int(m.group(4)))
+    else:
+        rule = ("D", int(m.group(5)))
+    text = text[m.end():]
+    time = 7200
+    if text.startswith("/"):
+        time, text = parse_offset(text[1:])
+    return rule + (time,), text
+
+
+def parse_posix(tz):
+    """Returns (std offset, dst offset, start rule, end rule), the offsets in seconds east of UTC."""
+    text = parse_name(tz)
+    std, text = parse_offset(text)
+    std = -std
+    if not text:
+        return std, None, None, None
+    text = parse_name(text)
+    dst = std + 3600
+    if text and text[0] != ",":
+        dst, text = parse_offset(text)
+        dst = -dst
+    if not text:
+        text = ",M3.2.0,M11.1.0"
+    start, text = parse_rule(text[1:])
+    end, text = parse_rule(text[1:])
+    return std, dst, start, end
+
+
+def rule_day(rule, year):
+    jan_first = days_from_civil(year, 1, 1)
+    if rule[0] == "J":
+        return jan_first + rule[1] - 1 + (1 if is_leap(year) and rule[1] >= 60 else 0)
+    if rule[0] == "D":
+        return jan_first + rule[1]
+    _, month, week, weekday, _ = rule
+    first = days_from_civil(year, month, 1)
+    first_weekday = (first + 4) % 7
+    day = 1 + (weekday - first_weekday + 7) % 7 + (week - 1) * 7
+    length = [31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31][month - 1] + (1 if month == 2 and is_leap(year) else 0)
+    while day > length:
+        day -= 7
+    return first + day - 1
+
+
+def posix_transitions(tz, first_year, last_year):
+    """Returns [(utc, offset after)] of the rule in tz for the years given."""
+    std, dst, start, end = parse_posix(tz)
+    if dst is None:
+        return []
+    result = []
+    for year in range(first_year, last_year + 1):
+        result.append((rule_day(start, year) * 86400 + start[-1] - std, dst))
+        result.append((rule_day(end, year) * 86400 + end[-1] - dst, std))
+    return sorted(result)
+
+
+def posix_offset_at(tz, utc):
+    std, dst, _, _ = parse_posix(tz)
+    if dst is None:
+        return std
+    year = 1970 + utc // 31556952
+    offset = std
+    for time, after in posix_transitions(tz, year - 2, year + 2):
+        if time <= utc:
+            offset = after
+    return offset
+
+
+def compile_zone(name, zoneinfo):
+    times, indices, types, footer = read_tzif(os.path.join(zoneinfo, name))
+
+    # the offset in effect at 1970, then every change after it
+    initial = types[0][0]
+    for time, index in zip(times, indices):
+        if time <= 0:
+            initial = types[index][0]
+    transitions = []
+    offset = initial
+    for time, index in zip(times, indices):
+        if time <= 0 or time > MAX_EPOCH:
+            continue
+        if types[index][0] == offset:
+            continue  # only the name or the DST flag changed
+        if time % 60:
+            print("warning: %s: transition at %d rounded to the minute" % (name, time), file=sys.stderr)
+            time -= time % 60
+        offset = types[index][0]
+        transitions.append((time, offset))
+
+    # drop the tail the footer rule reproduces, keeping the entry the rule takes over from
+    if footer:
+        keep = len(transitions)
+        while keep > 1:
+            time, offset = transitions[keep - 2]
+            if posix_offset_at(footer, time) != offset:
+                break
+            year = 1970 + time // 31556952
+            rule = [t for t in posix_transitions(footer, year - 1, 2106) if time <= t[0] <= transitions[-1][0]]
+            if rule != transitions[keep - 2:]:
+                break
+            keep -= 1
+        transitions = transitions[:keep]
+
+    offsets = [initial]
+    for _, offset in transitions:
+        if offset not in offsets:
+            offsets.append(offset)
+    if len(offsets) > 16:
+        raise ValueError("%s has more than 16 distinct offsets" % name)
+
+    # each transition is a little endian base-128 varint of (minutes since the previous one << 4 | offset index)
+    data = bytearray()
+    checkpoints = []
+    previous = 0
+    for i, (time, offset) in enumerate(transitions):
+        if i % CHECKPOINT_INTERVAL == 0:
+            checkpoints.append((time, len(data)))
+        value = ((time - previous) // 60) << 4 | offsets.index(offset)
+        previous = time
+        while True:
+            byte = value & 0x7F
+            value >>= 7
+            data.append(byte | (0x80 if value else 0))
+            if not value:
+                break
+    return footer, offsets, transitions, data, checkpoints
+
+
+def identifier(name):
+    return "tz_" + re.sub(r"[^A-Za-z0-9]", "_", name).lower()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("zones", nargs="*", default=DEFAULT_ZONES, help="IANA zone names")
+    parser.add_argument("-o", "--output", default="lib/timezone/src/timezone_zones.h")
+    parser.add_argument("--zoneinfo", default="/usr/share/zoneinfo")
+    args = parser.parse_args()
+
+    version = "unknown"
+    try:
+        with open(os.path.join(args.zoneinfo, "tzdata.zi")) as f:
+            version = f.readline().split()[-1]
+    except OSError:
+        pass
+
+    lines = [
+        "// time zone tables generated by tools/tzcompile.py from tzdata %s, do not edit." % version,
+        "//regenerate with: python3 tools/tzcompile.py -o lib/timezone/src/timezone_zones.h " + " ".join(args.zones),
+        "",
+        "#pragma once",
+        "",
+        "#include <zone_timezone.h>",
+        "",
+    ]
+    total = 0
+    for name in args.zones:
+        footer, offsets, transitions, data, checkpoints = compile_zone(name, args.zoneinfo)
+        ident = identifier(name)
+        size = len(data) + len(checkpoints) * 6 + len(offsets) * 4 + len(name) + len(footer) + 2
+        total += size
+        lines.append("//%s: %d transitions, then %s (%d bytes)" % (name, len(transitions), footer or "no rule", size))
+        lines.append('const char %s_name[] PROGMEM = "%s";' % (ident, name))
+        lines.append('const char %s_rule[] PROGMEM = "%s";' % (ident, footer))
+        lines.append("const int32_t %s_offsets[] PROGMEM = { %s };" % (ident, ", ".join(str(o) for o in offsets)))
+        if transitions:
+            lines.append("const uint32_t %s_checkpoints[] PROGMEM = { %s };" % (ident, ", ".join(str(t) for t, _ in checkpoints)))
+            lines.append("const uint16_t %s_positions[] PROGMEM = { %s };" % (ident, ", ".join(str(p) for _, p in checkpoints)))
+            lines.append("const uint8_t %s_data[] PROGMEM = {" % ident)
+            for i in range(0, len(data), 16):
+                lines.append("  " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+            lines.append("};")
+        lines.append("")
+
+    lines.append("const TimezoneZone timezone_zones[] PROGMEM = {")
+    for name in args.zones:
+        ident = identifier(name)
+        _, _, transitions, _, checkpoints = compile_zone(name, args.zoneinfo)
+        if transitions:
+            lines.append("  { %s_name, %s_rule, %s_offsets, %s_checkpoints, %s_positions, %s_data, %d }," %
+                         (ident, ident, ident, ident, ident, ident, len(transitions)))
+        else:
+            lines.append("  { %s_name, %s_rule, %s_offsets, nullptr, nullptr, nullptr, 0 }," % (ident, ident, ident))
+    lines.append("};")
+    lines.append("")
+    lines.append("#define TIMEZONE_NUM_ZONES %d" % len(args.zones))
+    lines.append("")
+    lines.append("//finds a compiled zone by its IANA name, returning nullptr if it isn't one of the zones above.")
+    lines.append("inline const TimezoneZone *findTimezoneZone(const char *name)")
+    lines.append("{")
+    lines.append("  for(uint8_t i = 0; i < TIMEZONE_NUM_ZONES; i++) {")
+    lines.append("    if(strcmp_P(name, (const char *)pgm_read_ptr(&timezone_zones[i].name)) == 0) {")
+    lines.append("      return &timezone_zones[i];")
+    lines.append("    }")
+    lines.append("  }")
+    lines.append("  return nullptr;")
+    lines.append("}")
+    lines.append("")
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(lines))
+    print("wrote %d zones, %d bytes of tables to %s" % (len(args.zones), total, args.output))
+
+
+if __name__ == "__main__":
+    main()